@@ -4,7 +4,7 @@
  * @file
  * @brief   The user application module for the blus mini hardware.
  * @details Contains the user application functions that provide
- * - volume potentiometer ADC readout,
+ * - a volume potentiometer, which is watched by the ADC analog watchdog,
  * - amplifier/DAC controls, and
  * - a reporting thread.
  *
@@ -14,61 +14,251 @@
 #include "audio.h"
 #include "ch.h"
 #include "chprintf.h"
+#include "log.h"
+#include "memory_report.h"
 #include "print.h"
 #include "tas2780.h"
 
 /**
  * @brief Settings structure for the TAS2780 I2C driver.
+ * @details Uses fast mode (400 kHz), which the TAS2780 supports.
  */
 static const I2CConfig g_tas2780_i2c_config = {
-    .op_mode = OPMODE_I2C, .clock_speed = 100000u, .duty_cycle = STD_DUTY_CYCLE};
+    .op_mode = OPMODE_I2C, .clock_speed = 400000u, .duty_cycle = FAST_DUTY_CYCLE_2};
 
 /**
- * @brief The volume potentiometer ADC sample (12 bit long).
+ * @brief The number of conversions, which are averaged for a potentiometer reading (oversampling).
+ * @details Also the depth of the circular buffer, while watching the potentiometer.
  */
-static adcsample_t g_adc_sample;
+#define APP_VOLUME_POT_SAMPLE_COUNT 16u
 
 /**
- * @brief Starts continuous sampling of the volume potentiometer ADC.
- * @note The result is currently unused.
+ * @brief The conversion rate in Hz, while the analog watchdog watches the potentiometer.
  */
-static void app_start_volume_adc(void) {
-    // ADC conversion group:
-    // - continuous conversion
-    // - 480 samples conversion time
-    // - Channel 9
-    static const ADCConversionGroup adc_conversion_group = {.circular     = TRUE,
-                                                            .num_channels = 1,
-                                                            .end_cb       = NULL,
-                                                            .error_cb     = NULL,
-                                                            .cr1          = 0u,
-                                                            .cr2          = ADC_CR2_SWSTART,
-                                                            .smpr1        = 0u,
-                                                            .smpr2        = ADC_SMPR2_SMP_AN9(ADC_SAMPLE_480),
-                                                            .htr          = 0u,
-                                                            .ltr          = 0u,
-                                                            .sqr1         = 0u,
-                                                            .sqr2         = 0u,
-                                                            .sqr3         = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN9)};
+#define APP_VOLUME_POT_WATCH_RATE_HZ 20u
+
+/**
+ * @brief The conversion rate in Hz, while the potentiometer is read.
+ */
+#define APP_VOLUME_POT_READ_RATE_HZ 1000u
+
+/**
+ * @brief The tick rate of the conversion trigger timer TIM3.
+ */
+#define APP_VOLUME_POT_TIMER_RATE_HZ 10000u
+
+/**
+ * @brief The half width of the analog watchdog window around the latest reading (12 bit).
+ * @details Movements of the knob within the window, and conversion noise, do not wake the CPU.
+ */
+#define APP_VOLUME_POT_HYSTERESIS 48u
+
+/**
+ * @brief The full scale of the 12 bit potentiometer conversions.
+ */
+#define APP_VOLUME_POT_FULL_SCALE 0xFFFu
+
+/**
+ * @brief The selection of TIM3 TRGO as the external trigger of regular conversions.
+ */
+#define APP_VOLUME_POT_TRIGGER_SOURCE 8u
+
+/**
+ * @brief A structure that holds the state of the volume potentiometer.
+ */
+static struct app_volume_pot {
+    adcsample_t samples[APP_VOLUME_POT_SAMPLE_COUNT];  ///< The latest conversions.
+    uint16_t    position;                              ///< The averaged position of the latest reading (12 bit).
+    int16_t     volume_8q8_db;                         ///< The volume level in 8.8 fractional dB, at the position.
+} g_volume_pot;
+
+/**
+ * @brief Conversion group for reading the potentiometer: a linear buffer of conversions on channel 9, triggered by
+ * TIM3, with 480 cycles of sampling time.
+ */
+static const ADCConversionGroup g_volume_pot_read_group = {
+    .circular     = FALSE,
+    .num_channels = 1,
+    .end_cb       = NULL,
+    .error_cb     = NULL,
+    .cr1          = 0u,
+    .cr2          = ADC_CR2_EXTEN_RISING | ADC_CR2_EXTSEL_SRC(APP_VOLUME_POT_TRIGGER_SOURCE),
+    .smpr1        = 0u,
+    .smpr2        = ADC_SMPR2_SMP_AN9(ADC_SAMPLE_480),
+    .htr          = 0u,
+    .ltr          = 0u,
+    .sqr1         = 0u,
+    .sqr2         = 0u,
+    .sqr3         = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN9)};
+
+/**
+ * @brief Conversion group for watching the potentiometer: like \a g_volume_pot_read_group , but circular, and with
+ * the analog watchdog on channel 9. The window is centered on the latest reading.
+ */
+static ADCConversionGroup g_volume_pot_watch_group = {
+    .circular     = TRUE,
+    .num_channels = 1,
+    .end_cb       = NULL,
+    .error_cb     = NULL,
+    .cr1          = ADC_CR1_AWDEN | ADC_CR1_AWDSGL | ADC_CR1_AWDIE | (ADC_CHANNEL_IN9 << ADC_CR1_AWDCH_Pos),
+    .cr2          = ADC_CR2_EXTEN_RISING | ADC_CR2_EXTSEL_SRC(APP_VOLUME_POT_TRIGGER_SOURCE),
+    .smpr1        = 0u,
+    .smpr2        = ADC_SMPR2_SMP_AN9(ADC_SAMPLE_480),
+    .htr          = APP_VOLUME_POT_FULL_SCALE,
+    .ltr          = 0u,
+    .sqr1         = 0u,
+    .sqr2         = 0u,
+    .sqr3         = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN9)};
+
+/**
+ * @brief Start the conversion trigger timer TIM3, without interrupts.
+ */
+static void app_volume_pot_start_timer(void) {
+    rccEnableTIM3(false);
+    rccResetTIM3();
+
+    TIM3->PSC = (STM32_TIMCLK1 / APP_VOLUME_POT_TIMER_RATE_HZ) - 1u;
+    TIM3->ARR = (APP_VOLUME_POT_TIMER_RATE_HZ / APP_VOLUME_POT_WATCH_RATE_HZ) - 1u;
+    // The update event is the trigger output (TRGO).
+    TIM3->CR2 = TIM_CR2_MMS_1;
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+/**
+ * @brief Set the rate of conversions.
+ *
+ * @param rate_hz The conversion rate in Hz.
+ */
+static void app_volume_pot_set_rate(uint32_t rate_hz) {
+    TIM3->ARR = (APP_VOLUME_POT_TIMER_RATE_HZ / rate_hz) - 1u;
+    TIM3->EGR = TIM_EGR_UG;
+}
+
+/**
+ * @brief Read the potentiometer position, averaged over \a APP_VOLUME_POT_SAMPLE_COUNT conversions.
+ *
+ * @return uint16_t The position (12 bit).
+ */
+static uint16_t app_volume_pot_read(void) {
+    app_volume_pot_set_rate(APP_VOLUME_POT_READ_RATE_HZ);
+    adcConvert(&ADCD1, &g_volume_pot_read_group, g_volume_pot.samples, APP_VOLUME_POT_SAMPLE_COUNT);
+
+    uint32_t sample_sum = 0u;
+
+    for (size_t sample_index = 0; sample_index < APP_VOLUME_POT_SAMPLE_COUNT; sample_index++) {
+        sample_sum += g_volume_pot.samples[sample_index];
+    }
+
+    return (uint16_t)(sample_sum / APP_VOLUME_POT_SAMPLE_COUNT);
+}
+
+/**
+ * @brief Wait, until the potentiometer leaves the watchdog window around a position.
+ * @details Conversions run at \a APP_VOLUME_POT_WATCH_RATE_HZ into a circular buffer. The analog watchdog ends the
+ * conversion, when a conversion falls outside of the window, which wakes the thread.
+ *
+ * @param position The position (12 bit), around which to center the window.
+ */
+static void app_volume_pot_watch(uint16_t position) {
+    g_volume_pot_watch_group.ltr = (position > APP_VOLUME_POT_HYSTERESIS) ? (position - APP_VOLUME_POT_HYSTERESIS) : 0u;
+    g_volume_pot_watch_group.htr = ((position + APP_VOLUME_POT_HYSTERESIS) < APP_VOLUME_POT_FULL_SCALE)
+                                       ? (position + APP_VOLUME_POT_HYSTERESIS)
+                                       : APP_VOLUME_POT_FULL_SCALE;
+
+    app_volume_pot_set_rate(APP_VOLUME_POT_WATCH_RATE_HZ);
+    adcConvert(&ADCD1, &g_volume_pot_watch_group, g_volume_pot.samples, APP_VOLUME_POT_SAMPLE_COUNT);
+}
+
+/**
+ * @brief Convert a potentiometer position to a volume level.
+ * @details The level is linear in dB over the range of the knob. It is quantized to the volume resolution, which is
+ * reported to the host.
+ *
+ * @param position The position (12 bit).
+ * @return int16_t The volume level in 8.8 fractional dB.
+ */
+static int16_t app_volume_pot_get_volume(uint16_t position) {
+    const int32_t VOLUME_RANGE_DB = (int32_t)AUDIO_MAX_VOLUME_DB - (int32_t)AUDIO_MIN_VOLUME_DB;
+    int32_t       volume_db = (int32_t)AUDIO_MIN_VOLUME_DB + (VOLUME_RANGE_DB * position) / APP_VOLUME_POT_FULL_SCALE;
+
+    return (int16_t)(volume_db * AUDIO_VOLUME_INCREMENT_STEPS);
+}
+
+static THD_WORKING_AREA(wa_volume_pot_thread, 128);
+
+/**
+ * @brief A thread that reads the volume potentiometer, whenever it moves.
+ * @details Sleeps, while the analog watchdog watches the knob. The volume of the potentiometer adds to the volume that
+ * the host sets.
+ */
+static THD_FUNCTION(volume_pot_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("volume pot");
 
-    // Start continuous conversion.
     adcStart(&ADCD1, NULL);
-    adcStartConversion(&ADCD1, &adc_conversion_group, &g_adc_sample, 1u);
+    app_volume_pot_start_timer();
+
+    while (true) {
+        uint16_t position      = app_volume_pot_read();
+        int16_t  volume_8q8_db = app_volume_pot_get_volume(position);
+
+        g_volume_pot.position = position;
+
+        if (volume_8q8_db != g_volume_pot.volume_8q8_db) {
+            g_volume_pot.volume_8q8_db = volume_8q8_db;
+            audio_request_set_local_volume(volume_8q8_db);
+        }
+
+        app_volume_pot_watch(position);
+    }
 }
 
 static THD_WORKING_AREA(wa_housekeeping_thread, 128);
 
 /**
- * @brief A housekeeping thread that checks amplifier states, and outputs status information via UART (if enabled).
+ * @brief The number of housekeeping periods (500 ms each) between amplifier state checks.
+ * @details Amplifier faults are handled via the shared interrupt line, so that polling is only a slow fallback.
+ */
+#define APP_AMPLIFIER_CHECK_PERIOD_COUNT 20u
+
+#if MEMORY_REPORT_ENABLE
+/**
+ * @brief The number of housekeeping periods (500 ms each) between stack watermark reports.
+ */
+#define APP_MEMORY_REPORT_PERIOD_COUNT 20u
+#endif
+
+/**
+ * @brief A housekeeping thread that checks amplifier states, and reports status information.
+ * @details Status information is written to the event log, which formats it in the background.
  */
 static THD_FUNCTION(housekeeping_thread, arg) {
     (void)arg;
     chRegSetThreadName("reporting");
 
+    // Kept off the small thread stack.
+    static struct audio_stats stats;
+
+    size_t period_count = 0u;
+#if MEMORY_REPORT_ENABLE
+    size_t memory_report_period_count = 0u;
+#endif
+
     while (true) {
-        tas2780_acquire_lock();
-        tas2780_ensure_active_all();
-        tas2780_release_lock();
+        if (++period_count >= APP_AMPLIFIER_CHECK_PERIOD_COUNT) {
+            period_count = 0u;
+
+            tas2780_acquire_lock();
+            tas2780_ensure_active_all();
+            tas2780_release_lock();
+        }
+
+#if MEMORY_REPORT_ENABLE
+        if (++memory_report_period_count >= APP_MEMORY_REPORT_PERIOD_COUNT) {
+            memory_report_period_count = 0u;
+            memory_report_stacks();
+        }
+#endif
 
         chSysLock();
         size_t buffer_fill_size = audio_playback_get_buffer_fill_size();
@@ -78,19 +268,65 @@ static THD_FUNCTION(housekeeping_thread, arg) {
 
 // Disable extended reporting statistics.
 #if 0
+        tas2780_acquire_lock();
         uint8_t noise_gate_mask = tas2780_get_noise_gate_mask_all();
+        tas2780_release_lock();
         PRINTF("Noise gate: %u\n", noise_gate_mask);
 
-        PRINTF("Potentiometer: %u\n",
-                 g_adc_sample >> 4);  // Convert to an 8 bit number.
+        PRINTF("Potentiometer: %u (%i dB)\n", g_volume_pot.position, g_volume_pot.volume_8q8_db >> 8);
 
         PRINTF("Volume: %li / %li dB\n",
                  (audio_request_get_channel_volume(AUDIO_COMMON_CHANNEL_LEFT) >> 8),
                  (audio_request_get_channel_volume(AUDIO_COMMON_CHANNEL_RIGHT) >> 8));
 #endif
 
-        PRINTF("Buffer: %u / %u (fb %u) @ state %u\n", buffer_fill_size, AUDIO_MAX_BUFFER_SIZE, feedback_value,
-               playback_state);
+        LOG_WRITE(LOG_EVENT_REPORT_BUFFER, buffer_fill_size, AUDIO_MAX_BUFFER_SIZE, feedback_value, playback_state);
+
+        // The statistics snapshot is taken without locking.
+        audio_stats_get(&stats);
+
+        LOG_WRITE(LOG_EVENT_REPORT_USB_STATS, stats.usb.received_packet_count, stats.usb.failed_transaction_count,
+                  stats.usb.forced_correction_count, stats.usb.forced_correction_max_bytes);
+        LOG_WRITE(LOG_EVENT_REPORT_PLAYBACK_STATS, stats.usb.playback_start_count, stats.usb.playback_stop_count,
+                  stats.feedback.update_count);
+
+#if AUDIO_DSP_ENABLE
+        struct audio_dsp_stats dsp_stats;
+        audio_dsp_get_stats(&dsp_stats);
+
+        LOG_WRITE(LOG_EVENT_REPORT_DSP_STATS, dsp_stats.block_count, dsp_stats.max_cycles, dsp_stats.overrun_count,
+                  dsp_stats.b_is_muted);
+#endif
+
+#if AUDIO_LATENCY_TEST_ENABLE
+        static struct audio_latency_stats latency_stats;
+        audio_latency_get_stats(&latency_stats);
+
+        chSysLock();
+        uint32_t sample_rate_hz = audio_playback_get_sample_rate();
+        size_t   buffer_profile = audio_playback_get_buffer_profile();
+        chSysUnlock();
+
+        LOG_WRITE(LOG_EVENT_REPORT_LATENCY, latency_stats.measurement_count, latency_stats.min_latency_us,
+                  latency_stats.max_latency_us, latency_stats.mean_latency_us);
+        LOG_WRITE(LOG_EVENT_REPORT_LATENCY_STATE, latency_stats.missed_count, latency_stats.latest_frame_count,
+                  sample_rate_hz, buffer_profile);
+#endif
+
+#if AUDIO_PROFILE
+        // Report execution times in CPU cycles per profiled site.
+        for (size_t site_index = 0; site_index < AUDIO_PROFILE_SITE_COUNT; site_index++) {
+            static struct audio_profile_site_stats site_stats;
+            audio_profile_get(&site_stats, (enum audio_profile_site)site_index);
+
+            if (site_stats.count == 0u) {
+                continue;
+            }
+
+            LOG_WRITE(LOG_EVENT_REPORT_PROFILE, site_index, site_stats.min_cycles, site_stats.max_cycles,
+                      (uint32_t)(site_stats.total_cycles / site_stats.count));
+        }
+#endif
 
         chThdSleepMilliseconds(500);
     }
@@ -109,8 +345,8 @@ void app_setup(void) {
     tas2780_setup_all();
     tas2780_release_lock();
 
-    // Begin reading volume potentiometer ADC.
-    app_start_volume_adc();
+    // Begin watching the volume potentiometer.
+    chThdCreateStatic(wa_volume_pot_thread, sizeof(wa_volume_pot_thread), NORMALPRIO - 1, volume_pot_thread, NULL);
 
     // Create housekeeping thread for regular tasks.
     chThdCreateStatic(wa_housekeeping_thread, sizeof(wa_housekeeping_thread), NORMALPRIO, housekeeping_thread, NULL);
@@ -118,8 +354,26 @@ void app_setup(void) {
 
 /**
  * @brief Joint handling of volume and mute controls.
+ * @details Volume writes are queued by the TAS2780 module, so that this function does not wait for the I2C bus.
  */
 static void app_set_volume_and_mute_state(void) {
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+    // Volume and mute are applied in the sample path, so that the amplifiers stay at their maximum volume.
+#elif AUDIO_TDM_ENABLE
+    // Every USB channel has its own amplifiers, which play the channel's TDM slot.
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        chSysLock();
+        bool    b_channel_is_muted = audio_request_is_channel_muted((enum audio_common_channel)channel_index);
+        int16_t channel_volume     = audio_request_get_channel_volume((enum audio_common_channel)channel_index);
+        chSysUnlock();
+
+        if (b_channel_is_muted) {
+            tas2780_set_volume_slot(TAS2780_VOLUME_MUTE, audio_tdm_get_slot_index(channel_index));
+        } else {
+            tas2780_set_volume_slot(channel_volume, audio_tdm_get_slot_index(channel_index));
+        }
+    }
+#else
     chSysLock();
     bool b_left_channel_is_muted  = audio_request_is_channel_muted(AUDIO_COMMON_CHANNEL_LEFT);
     bool b_right_channel_is_muted = audio_request_is_channel_muted(AUDIO_COMMON_CHANNEL_RIGHT);
@@ -128,7 +382,6 @@ static void app_set_volume_and_mute_state(void) {
     int16_t right_channel_volume = audio_request_get_channel_volume(AUDIO_COMMON_CHANNEL_RIGHT);
     chSysUnlock();
 
-    tas2780_acquire_lock();
     if (b_left_channel_is_muted) {
         tas2780_set_volume_all(TAS2780_VOLUME_MUTE, TAS2780_CHANNEL_LEFT);
     } else {
@@ -140,7 +393,7 @@ static void app_set_volume_and_mute_state(void) {
     } else {
         tas2780_set_volume_all(right_channel_volume, TAS2780_CHANNEL_RIGHT);
     }
-    tas2780_release_lock();
+#endif
 }
 
 /**
@@ -95,7 +95,7 @@
 #define GPIOB_PIN10    10U
 #define GPIOB_PIN11    11U
 #define GPIOB_PIN12    12U
-#define GPIOB_PIN13    13U
+#define GPIOB_SPK_IRQ  13U
 #define GPIOB_NSPK_SD  14U
 #define GPIOB_PIN15    15U
 
@@ -235,6 +235,7 @@
 #define LINE_SWO      PAL_LINE(GPIOB, 3U)
 #define LINE_I2C1_SCL PAL_LINE(GPIOB, 6U)
 #define LINE_I2C1_SDA PAL_LINE(GPIOB, 7U)
+#define LINE_SPK_IRQ  PAL_LINE(GPIOB, 13U)
 #define LINE_NSPK_SD  PAL_LINE(GPIOB, 14U)
 
 #define LINE_I2S3_MCK  PAL_LINE(GPIOC, 7U)
@@ -363,7 +364,7 @@
  * PB10 - PIN10                     (input pullup).
  * PB11 - PIN11                     (input pullup).
  * PB12 - PIN12                     (input pullup).
- * PB13 - PIN13                     (input pullup).
+ * PB13 - SPK_IRQ                   (input pullup).
  * PB14 - NSPK_SD                   (output push-pull).
  * PB15 - PIN15                     (input pullup).
  */
@@ -372,42 +373,42 @@
      PIN_MODE_ALTERNATE(GPIOB_SWO) | PIN_MODE_INPUT(GPIOB_PIN4) | PIN_MODE_INPUT(GPIOB_PIN5) |                         \
      PIN_MODE_ALTERNATE(GPIOB_I2C1_SCL) | PIN_MODE_ALTERNATE(GPIOB_I2C1_SDA) | PIN_MODE_INPUT(GPIOB_PIN8) |            \
      PIN_MODE_INPUT(GPIOB_PIN9) | PIN_MODE_INPUT(GPIOB_PIN10) | PIN_MODE_INPUT(GPIOB_PIN11) |                          \
-     PIN_MODE_INPUT(GPIOB_PIN12) | PIN_MODE_INPUT(GPIOB_PIN13) | PIN_MODE_OUTPUT(GPIOB_NSPK_SD) |                      \
+     PIN_MODE_INPUT(GPIOB_PIN12) | PIN_MODE_INPUT(GPIOB_SPK_IRQ) | PIN_MODE_OUTPUT(GPIOB_NSPK_SD) |                    \
      PIN_MODE_INPUT(GPIOB_PIN15))
 #define VAL_GPIOB_OTYPER                                                                                               \
     (PIN_OTYPE_PUSHPULL(GPIOB_PIN0) | PIN_OTYPE_PUSHPULL(GPIOB_VOL_POT) | PIN_OTYPE_PUSHPULL(GPIOB_PIN2) |             \
      PIN_OTYPE_PUSHPULL(GPIOB_SWO) | PIN_OTYPE_PUSHPULL(GPIOB_PIN4) | PIN_OTYPE_PUSHPULL(GPIOB_PIN5) |                 \
      PIN_OTYPE_OPENDRAIN(GPIOB_I2C1_SCL) | PIN_OTYPE_OPENDRAIN(GPIOB_I2C1_SDA) | PIN_OTYPE_PUSHPULL(GPIOB_PIN8) |      \
      PIN_OTYPE_PUSHPULL(GPIOB_PIN9) | PIN_OTYPE_PUSHPULL(GPIOB_PIN10) | PIN_OTYPE_PUSHPULL(GPIOB_PIN11) |              \
-     PIN_OTYPE_PUSHPULL(GPIOB_PIN12) | PIN_OTYPE_PUSHPULL(GPIOB_PIN13) | PIN_OTYPE_PUSHPULL(GPIOB_NSPK_SD) |           \
+     PIN_OTYPE_PUSHPULL(GPIOB_PIN12) | PIN_OTYPE_PUSHPULL(GPIOB_SPK_IRQ) | PIN_OTYPE_PUSHPULL(GPIOB_NSPK_SD) |         \
      PIN_OTYPE_PUSHPULL(GPIOB_PIN15))
 #define VAL_GPIOB_OSPEEDR                                                                                              \
     (PIN_OSPEED_HIGH(GPIOB_PIN0) | PIN_OSPEED_HIGH(GPIOB_VOL_POT) | PIN_OSPEED_HIGH(GPIOB_PIN2) |                      \
      PIN_OSPEED_HIGH(GPIOB_SWO) | PIN_OSPEED_HIGH(GPIOB_PIN4) | PIN_OSPEED_HIGH(GPIOB_PIN5) |                          \
      PIN_OSPEED_HIGH(GPIOB_I2C1_SCL) | PIN_OSPEED_HIGH(GPIOB_I2C1_SDA) | PIN_OSPEED_HIGH(GPIOB_PIN8) |                 \
      PIN_OSPEED_HIGH(GPIOB_PIN9) | PIN_OSPEED_HIGH(GPIOB_PIN10) | PIN_OSPEED_HIGH(GPIOB_PIN11) |                       \
-     PIN_OSPEED_HIGH(GPIOB_PIN12) | PIN_OSPEED_HIGH(GPIOB_PIN13) | PIN_OSPEED_HIGH(GPIOB_NSPK_SD) |                    \
+     PIN_OSPEED_HIGH(GPIOB_PIN12) | PIN_OSPEED_HIGH(GPIOB_SPK_IRQ) | PIN_OSPEED_HIGH(GPIOB_NSPK_SD) |                  \
      PIN_OSPEED_HIGH(GPIOB_PIN15))
 #define VAL_GPIOB_PUPDR                                                                                                \
     (PIN_PUPDR_PULLUP(GPIOB_PIN0) | PIN_PUPDR_FLOATING(GPIOB_VOL_POT) | PIN_PUPDR_PULLUP(GPIOB_PIN2) |                 \
      PIN_PUPDR_PULLUP(GPIOB_SWO) | PIN_PUPDR_PULLUP(GPIOB_PIN4) | PIN_PUPDR_PULLUP(GPIOB_PIN5) |                       \
      PIN_PUPDR_FLOATING(GPIOB_I2C1_SCL) | PIN_PUPDR_FLOATING(GPIOB_I2C1_SDA) | PIN_PUPDR_PULLUP(GPIOB_PIN8) |          \
      PIN_PUPDR_PULLUP(GPIOB_PIN9) | PIN_PUPDR_PULLUP(GPIOB_PIN10) | PIN_PUPDR_PULLUP(GPIOB_PIN11) |                    \
-     PIN_PUPDR_PULLUP(GPIOB_PIN12) | PIN_PUPDR_PULLUP(GPIOB_PIN13) | PIN_PUPDR_PULLUP(GPIOB_NSPK_SD) |                 \
+     PIN_PUPDR_PULLUP(GPIOB_PIN12) | PIN_PUPDR_PULLUP(GPIOB_SPK_IRQ) | PIN_PUPDR_PULLUP(GPIOB_NSPK_SD) |               \
      PIN_PUPDR_PULLUP(GPIOB_PIN15))
 #define VAL_GPIOB_ODR                                                                                                  \
     (PIN_ODR_HIGH(GPIOB_PIN0) | PIN_ODR_HIGH(GPIOB_VOL_POT) | PIN_ODR_HIGH(GPIOB_PIN2) | PIN_ODR_HIGH(GPIOB_SWO) |     \
      PIN_ODR_HIGH(GPIOB_PIN4) | PIN_ODR_HIGH(GPIOB_PIN5) | PIN_ODR_HIGH(GPIOB_I2C1_SCL) |                              \
      PIN_ODR_HIGH(GPIOB_I2C1_SDA) | PIN_ODR_HIGH(GPIOB_PIN8) | PIN_ODR_HIGH(GPIOB_PIN9) | PIN_ODR_HIGH(GPIOB_PIN10) |  \
-     PIN_ODR_HIGH(GPIOB_PIN11) | PIN_ODR_HIGH(GPIOB_PIN12) | PIN_ODR_HIGH(GPIOB_PIN13) | PIN_ODR_HIGH(GPIOB_NSPK_SD) | \
-     PIN_ODR_HIGH(GPIOB_PIN15))
+     PIN_ODR_HIGH(GPIOB_PIN11) | PIN_ODR_HIGH(GPIOB_PIN12) | PIN_ODR_HIGH(GPIOB_SPK_IRQ) |                            \
+     PIN_ODR_HIGH(GPIOB_NSPK_SD) | PIN_ODR_HIGH(GPIOB_PIN15))
 #define VAL_GPIOB_AFRL                                                                                                 \
     (PIN_AFIO_AF(GPIOB_PIN0, 0U) | PIN_AFIO_AF(GPIOB_VOL_POT, 0U) | PIN_AFIO_AF(GPIOB_PIN2, 0U) |                      \
      PIN_AFIO_AF(GPIOB_SWO, 0U) | PIN_AFIO_AF(GPIOB_PIN4, 0U) | PIN_AFIO_AF(GPIOB_PIN5, 0U) |                          \
      PIN_AFIO_AF(GPIOB_I2C1_SCL, 4U) | PIN_AFIO_AF(GPIOB_I2C1_SDA, 4U))
 #define VAL_GPIOB_AFRH                                                                                                 \
     (PIN_AFIO_AF(GPIOB_PIN8, 0U) | PIN_AFIO_AF(GPIOB_PIN9, 0U) | PIN_AFIO_AF(GPIOB_PIN10, 0U) |                        \
-     PIN_AFIO_AF(GPIOB_PIN11, 0U) | PIN_AFIO_AF(GPIOB_PIN12, 0U) | PIN_AFIO_AF(GPIOB_PIN13, 0U) |                      \
+     PIN_AFIO_AF(GPIOB_PIN11, 0U) | PIN_AFIO_AF(GPIOB_PIN12, 0U) | PIN_AFIO_AF(GPIOB_SPK_IRQ, 0U) |                    \
      PIN_AFIO_AF(GPIOB_NSPK_SD, 0U) | PIN_AFIO_AF(GPIOB_PIN15, 0U))
 
 /*
@@ -11,4 +11,5 @@ popd
 for app in $APPS;
 do
     make APP=$(basename $app)
+    python3 ./tools/ram_report/ram_report.py ./build/$(basename $app)_firmware.map
 done
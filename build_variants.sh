@@ -0,0 +1,24 @@
+#!/bin/bash
+set -e
+
+# Build all variants in the chosen directory for one app (default: blus_mini) with make.
+# Further arguments are passed to make, e.g. AUDIO_PROFILE=1.
+VARIANTSDIR=./variants
+APP=${1:-blus_mini}
+shift || true
+
+for variant_file in $VARIANTSDIR/*.mk;
+do
+    variant=$(basename $variant_file .mk)
+    echo "# Variant $variant"
+
+    make APP=$APP VARIANT=$variant "$@"
+    python3 ./tools/ram_report/ram_report.py ./build/$variant/${APP}_firmware.map
+
+    # Time the sample path on the host, with the audio settings of the variant.
+    make -s -C ./tools/simulator clean
+    make -s -C ./tools/simulator DEFS="$(make -s VARIANT=$variant variant-defs)"
+    ./tools/simulator/build/simulator --benchmark | tail -n 1
+done
+
+make -s -C ./tools/simulator clean
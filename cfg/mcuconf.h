@@ -236,7 +236,13 @@
  */
 #define STM32_USB_USE_OTG1             TRUE
 #define STM32_USB_OTG1_IRQ_PRIORITY    14
+// The capture endpoint needs TX FIFO space in the 1280 byte FIFO memory. Enabling capture shrinks the RX FIFO
+// from 1024 to 960 bytes.
+#if defined(AUDIO_CAPTURE_ENABLE) && AUDIO_CAPTURE_ENABLE
+#define STM32_USB_OTG1_RX_FIFO_SIZE    960
+#else
 #define STM32_USB_OTG1_RX_FIFO_SIZE    1024
+#endif
 #define STM32_USB_HOST_WAKEUP_DURATION 2
 
 /*
@@ -14,13 +14,19 @@
 
 #include <string.h>
 
+#include "audio_capture.h"
+#include "audio_dsp.h"
+#include "audio_latency.h"
+#include "audio_profile.h"
+#include "audio_tdm.h"
+#include "audio_volume.h"
 #include "common.h"
-#include "print.h"
+#include "log.h"
 
 /**
- * @brief The number of audio messages that can be held.
+ * @brief The time in ticks after which the audio thread retries to post messages to a full application mailbox.
  */
-#define AUDIO_MESSAGE_BUFFER_LENGTH 32u
+#define AUDIO_APP_MESSAGE_RETRY_INTERVAL TIME_MS2I(10u)
 
 /**
  * @brief The time in ticks after which an \a AUDIO_COMMON_MSG_RESET_VOLUME message is sent, following the end of
@@ -31,19 +37,102 @@
  */
 #define AUDIO_RESET_VOLUME_TIMEOUT (CH_CFG_ST_FREQUENCY / 10u)  // 100 ms delay
 
+/**
+ * @brief The time in ticks, within which the I2S PLL must stop, or lock.
+ * @details The PLL typically locks within 100 us. A PLL that does not lock in time leaves the output stopped.
+ */
+#define AUDIO_PLLI2S_TIMEOUT TIME_MS2I(2u)
+
+/**
+ * @brief The PLLI2S multiplication factor N for the 44.1 kHz sample rate family.
+ * @details Together with \a AUDIO_PLLI2SR_VALUE_44_1_KHZ, the I2S clock is 112.896 MHz (2560 * 44.1 kHz), based on a
+ * PLLI2S input clock of 1.536 MHz. The 48 kHz sample rate family uses the PLLI2S settings from the MCU configuration.
+ */
+#define AUDIO_PLLI2SN_VALUE_44_1_KHZ 147u
+
+/**
+ * @brief The PLLI2S division factor R for the 44.1 kHz sample rate family.
+ */
+#define AUDIO_PLLI2SR_VALUE_44_1_KHZ 2u
+
+/**
+ * @brief Calculate the I2S clock frequency that results from a PLLI2S setting.
+ *
+ * @param _plli2s_n The PLLI2S multiplication factor N.
+ * @param _plli2s_r The PLLI2S division factor R.
+ */
+#define AUDIO_GET_I2S_CLOCK_HZ(_plli2s_n, _plli2s_r) ((STM32_PLLI2SCLKIN * (_plli2s_n)) / (_plli2s_r))
+
+/**
+ * @brief Calculate the total I2S clock divider, which is \a (2 * I2SDIV + ODD).
+ * @details The master clock output runs at 256 times the sample rate.
+ *
+ * @param _plli2s_n The PLLI2S multiplication factor N.
+ * @param _plli2s_r The PLLI2S division factor R.
+ * @param _sample_rate_hz The sample rate in Hz.
+ */
+#define AUDIO_GET_I2S_DIVIDER(_plli2s_n, _plli2s_r, _sample_rate_hz)                                                   \
+    (AUDIO_GET_I2S_CLOCK_HZ(_plli2s_n, _plli2s_r) / (256u * (_sample_rate_hz)))
+
+/**
+ * @brief Check, whether a PLLI2S setting produces an error-free I2S clock for a sample rate.
+ * @details The PLLI2S VCO output must lie between 100 MHz and 432 MHz, and the I2S clock must not exceed 192 MHz.
+ * I2SDIV must be at least two.
+ *
+ * @param _plli2s_n The PLLI2S multiplication factor N.
+ * @param _plli2s_r The PLLI2S division factor R.
+ * @param _sample_rate_hz The sample rate in Hz.
+ */
+#define AUDIO_IS_I2S_CLOCK_VALID(_plli2s_n, _plli2s_r, _sample_rate_hz)                                                \
+    (((STM32_PLLI2SCLKIN * (_plli2s_n)) >= 100000000u) && ((STM32_PLLI2SCLKIN * (_plli2s_n)) <= 432000000u) &&     \
+     (AUDIO_GET_I2S_CLOCK_HZ(_plli2s_n, _plli2s_r) <= 192000000u) &&                                                  \
+     ((AUDIO_GET_I2S_CLOCK_HZ(_plli2s_n, _plli2s_r) % (256u * (_sample_rate_hz))) == 0u) &&                           \
+     (AUDIO_GET_I2S_DIVIDER(_plli2s_n, _plli2s_r, _sample_rate_hz) >= 4u))
+
 /**
  * @brief Calculate the I2S register content for I2SPR.
- * @details Calculate the clock divider from the I2S PLL clock output and the selected sample rate. Also enables the
- * master clock output.
+ * @details Calculate the linear prescaler and the odd factor from the I2S PLL clock output and the selected sample
+ * rate. Also enables the master clock output.
  * @note See the STM32F401 reference manual at p. 594.
  *
+ * @param _plli2s_n The PLLI2S multiplication factor N.
+ * @param _plli2s_r The PLLI2S division factor R.
  * @param _sample_rate_hz The sample rate in Hz.
  */
-#define AUDIO_SPI_GET_I2SPR(_sample_rate_hz)                                                                           \
-    (SPI_I2SPR_MCKOE | (SPI_I2SPR_I2SDIV & (STM32_PLLI2S_R_CLKOUT / (_sample_rate_hz) / 512u)))
+#define AUDIO_SPI_GET_I2SPR(_plli2s_n, _plli2s_r, _sample_rate_hz)                                                     \
+    (SPI_I2SPR_MCKOE |                                                                                                 \
+     (((AUDIO_GET_I2S_DIVIDER(_plli2s_n, _plli2s_r, _sample_rate_hz) & 1u) != 0u) ? SPI_I2SPR_ODD : 0u) |             \
+     (SPI_I2SPR_I2SDIV & (AUDIO_GET_I2S_DIVIDER(_plli2s_n, _plli2s_r, _sample_rate_hz) >> 1u)))
 
-// Set the I2S CFGR register depending on the chosen audio resolution.
-#if AUDIO_RESOLUTION_BIT == 16u
+/**
+ * @brief Create an entry of the clock configuration table.
+ *
+ * @param _plli2s_n The PLLI2S multiplication factor N.
+ * @param _plli2s_r The PLLI2S division factor R.
+ * @param _sample_rate_hz The sample rate in Hz.
+ */
+#define AUDIO_CLOCK_CONFIG(_plli2s_n, _plli2s_r, _sample_rate_hz)                                                      \
+    {.sample_rate_hz = (_sample_rate_hz),                                                                              \
+     .plli2s_n       = (_plli2s_n),                                                                                    \
+     .plli2s_r       = (_plli2s_r),                                                                                    \
+     .i2spr          = AUDIO_SPI_GET_I2SPR(_plli2s_n, _plli2s_r, _sample_rate_hz)}
+
+// The sample rate enumeration is not available to the preprocessor, so that the checks use numeric sample rates.
+#if !AUDIO_IS_I2S_CLOCK_VALID(STM32_PLLI2SN_VALUE, STM32_PLLI2SR_VALUE, 48000u) ||                                  \
+    !AUDIO_IS_I2S_CLOCK_VALID(STM32_PLLI2SN_VALUE, STM32_PLLI2SR_VALUE, 96000u)
+#error "The PLLI2S settings do not provide error-free clocks for the 48 kHz sample rate family."
+#endif
+
+#if !AUDIO_IS_I2S_CLOCK_VALID(AUDIO_PLLI2SN_VALUE_44_1_KHZ, AUDIO_PLLI2SR_VALUE_44_1_KHZ, 44100u) ||                \
+    !AUDIO_IS_I2S_CLOCK_VALID(AUDIO_PLLI2SN_VALUE_44_1_KHZ, AUDIO_PLLI2SR_VALUE_44_1_KHZ, 88200u)
+#error "The PLLI2S settings do not provide error-free clocks for the 44.1 kHz sample rate family."
+#endif
+
+// Set the I2S CFGR register depending on the chosen audio resolution. The TDM output transmits pairs of 16 bit slots
+// as 32 bit data words.
+#if AUDIO_TDM_ENABLE
+#define AUDIO_I2S_CFGR SPI_I2SCFGR_DATLEN_1
+#elif AUDIO_RESOLUTION_BIT == 16u
 #define AUDIO_I2S_CFGR 0u
 #elif AUDIO_RESOLUTION_BIT == 32u
 #define AUDIO_I2S_CFGR SPI_I2SCFGR_DATLEN_1
@@ -52,14 +141,19 @@
 #endif
 
 /**
- * @brief Audio mailbox for communication between ISRs and the audio thread.
+ * @brief The audio thread, which ISRs signal with audio message events.
  */
-static mailbox_t g_audio_mailbox;
+static thread_t *gp_audio_thread;
 
 /**
- * @brief The mailbox buffer.
+ * @brief The audio messages, which are relayed to the application mailbox.
+ * @details Messages that cannot be posted are kept pending, and are retried in this order.
  */
-static msg_t g_audio_mailbox_buffer[AUDIO_MESSAGE_BUFFER_LENGTH];
+static const msg_t g_audio_app_messages[] = {
+    AUDIO_COMMON_MSG_SET_VOLUME,
+    AUDIO_COMMON_MSG_SET_MUTE_STATE,
+    AUDIO_COMMON_MSG_RESET_VOLUME,
+};
 
 /**
  * @brief The main audio context.
@@ -69,15 +163,40 @@ static volatile struct audio_context {
     mailbox_t *p_mailbox;  ///< The pointer to a mailbox that receives messages from the audio thread. Can be NULL.
 } g_audio_context;
 
+/**
+ * @brief The clock settings for a supported sample rate.
+ */
+struct audio_clock_config {
+    uint32_t sample_rate_hz;  ///< The sample rate in Hz.
+    uint32_t plli2s_n;        ///< The PLLI2S multiplication factor N.
+    uint32_t plli2s_r;        ///< The PLLI2S division factor R.
+    uint32_t i2spr;           ///< The I2SPR register content (linear prescaler, odd factor, and master clock output).
+};
+
+/**
+ * @brief The precomputed clock settings for all supported sample rates.
+ * @details Sample rates of the same family share a PLLI2S setting, so that switching between them only changes the
+ * I2S prescaler.
+ */
+static const struct audio_clock_config g_audio_clock_configs[] = {
+    AUDIO_CLOCK_CONFIG(AUDIO_PLLI2SN_VALUE_44_1_KHZ, AUDIO_PLLI2SR_VALUE_44_1_KHZ, AUDIO_SAMPLE_RATE_44_1_KHZ),
+    AUDIO_CLOCK_CONFIG(STM32_PLLI2SN_VALUE, STM32_PLLI2SR_VALUE, AUDIO_SAMPLE_RATE_48_KHZ),
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+    AUDIO_CLOCK_CONFIG(AUDIO_PLLI2SN_VALUE_44_1_KHZ, AUDIO_PLLI2SR_VALUE_44_1_KHZ, AUDIO_SAMPLE_RATE_88_2_KHZ),
+    AUDIO_CLOCK_CONFIG(STM32_PLLI2SN_VALUE, STM32_PLLI2SR_VALUE, AUDIO_SAMPLE_RATE_96_KHZ),
+#endif
+};
+
 /**
  * @brief Settings structure for the I2S driver.
- * @details Enables the master clock output for timer capture.
+ * @details Enables the master clock output for timer capture. The DMA half and complete transfer interrupts timestamp
+ * the read offset.
  */
 static I2SConfig g_i2s_config = {
     .tx_buffer = NULL,  // To be set at runtime.
     .rx_buffer = NULL,
     .size      = 0u,  // To be set at runtime.
-    .end_cb    = NULL,
+    .end_cb    = audio_playback_dma_cb,
     .i2scfgr   = AUDIO_I2S_CFGR,
     .i2spr     = 0u  // To be set at runtime.
 };
@@ -103,20 +222,57 @@ static void audio_init_context(volatile struct audio_context *p_context, mailbox
 
 /**
  * @brief Reset the audio module.
- * @details Is called on USB reset, unconfigure, or suspend. First calls \a audio_stop_streaming() , then resets the
- * internal state of the module.
+ * @details Is called on USB reset, unconfigure, or suspend. First stops playback and capture streaming, and ends
+ * warm idle, then resets the internal state of the module.
  *
  * @param p_usb The pointer to the USB driver structure.
  */
 void audio_reset(USBDriver *p_usb) {
     audio_playback_stop_streaming(p_usb);
+#if AUDIO_CAPTURE_ENABLE
+    audio_capture_stop_streaming(p_usb);
+#endif
+
+    // Do not keep the output running, while the host is gone.
+    chSysLockFromISR();
+    audio_playback_end_warm_idle();
+    chSysUnlockFromISR();
+
     audio_init_context(&g_audio_context, g_audio_context.p_mailbox);
 }
 
+/**
+ * @brief Determine, whether the amplifiers receive audio via I2S.
+ * @details In warm idle, the output continues with silence, so that volume levels must be kept up to date.
+ * @note Must be called from a locked context.
+ *
+ * @return true if playing, or in warm idle.
+ * @return false if the output is stopped.
+ */
+static bool audio_is_output_active(void) {
+    enum audio_playback_state state = audio_playback_get_state();
+    return (state == AUDIO_PLAYBACK_STATE_PLAYING) || (state == AUDIO_PLAYBACK_STATE_WARM_IDLE);
+}
+
+/**
+ * @brief Determine, whether the host streams from the capture endpoint, which needs the I2S clocks.
+ * @note Must be called from a locked context.
+ *
+ * @return true if capture streams.
+ * @return false if capture does not stream, or is disabled.
+ */
+static bool audio_is_capture_streaming(void) {
+#if AUDIO_CAPTURE_ENABLE
+    return audio_capture_is_streaming();
+#else
+    return false;
+#endif
+}
+
 /**
  * @brief The volume reset timer callback function.
- * @details Sends a \a AUDIO_MSG_RESET_VOLUME message to a listening thread, if playback is still disabled after the
- * timeout period. If playback is no longer disabled, no message is sent.
+ * @details Signals \a AUDIO_COMMON_MSG_RESET_VOLUME to the audio thread, if playback is still disabled after the
+ * timeout period. If playback is no longer disabled, nothing is signaled.
  *
  * @param p_virtual_timer A pointer to the virtual timer object (unused).
  * @param p_arg A pointer to the callback argument (unused).
@@ -126,38 +282,217 @@ static void audio_volume_reset_cb(virtual_timer_t *p_virtual_timer, void *p_arg)
     (void)p_arg;
 
     chSysLockFromISR();
-    if ((audio_playback_get_state() != AUDIO_PLAYBACK_STATE_PLAYING) && audio_mailbox_is_set()) {
-        chMBPostI(g_audio_context.p_mailbox, AUDIO_COMMON_MSG_RESET_VOLUME);
+    if (!audio_is_output_active()) {
+        chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_RESET_VOLUME));
     }
     chSysUnlockFromISR();
 }
 
 /**
- * @brief Send a message to the application layer, if an application mailbox is configured.
+ * @brief The warm idle timer callback function.
+ * @details Ends warm idle, if playback did not resume within \a AUDIO_WARM_IDLE_TIMEOUT_MS . Otherwise, or while
+ * capture streams, nothing happens.
  *
- * @param message The message to send.
+ * @param p_virtual_timer A pointer to the virtual timer object (unused).
+ * @param p_arg A pointer to the callback argument (unused).
  */
-static void audio_send_app_message(msg_t message) {
-    if (audio_mailbox_is_set()) {
-        chMBPostTimeout(g_audio_context.p_mailbox, message, TIME_INFINITE);
+static void audio_warm_idle_timeout_cb(virtual_timer_t *p_virtual_timer, void *p_arg) {
+    (void)p_virtual_timer;
+    (void)p_arg;
+
+    chSysLockFromISR();
+    if (!audio_is_capture_streaming()) {
+        audio_playback_end_warm_idle();
     }
+    chSysUnlockFromISR();
 }
 
 /**
- * @brief Set up a new sample rate.
- * @details Configures the \a audio_playback module, as well as the I2S peripheral.
+ * @brief Post pending messages to the application layer, if an application mailbox is configured.
+ * @details Never blocks the audio thread. Messages that do not fit into the application mailbox remain pending.
+ *
+ * @param pending_events The events of the messages to post.
+ * @return eventmask_t The events of the messages that remain pending.
  */
-static void audio_update_sample_rate(void) {
-    chDbgAssert(audio_playback_get_state() != AUDIO_PLAYBACK_STATE_PLAYING,
-                "Playback must not be enabled while switching sample rates.");
+static eventmask_t audio_send_app_messages(eventmask_t pending_events) {
+    if (!audio_mailbox_is_set()) {
+        return 0u;
+    }
 
-    uint32_t sample_rate_hz = audio_request_get_sample_rate_hz();
+    for (size_t message_index = 0; message_index < ARRAY_LENGTH(g_audio_app_messages); message_index++) {
+        msg_t       message = g_audio_app_messages[message_index];
+        eventmask_t event   = AUDIO_COMMON_EVENT(message);
 
-    audio_playback_set_sample_rate(sample_rate_hz);
+        if (((pending_events & event) != 0u) &&
+            (chMBPostTimeout(g_audio_context.p_mailbox, message, TIME_IMMEDIATE) == MSG_OK)) {
+            pending_events &= ~event;
+        }
+    }
+
+    return pending_events;
+}
 
+/**
+ * @brief Match the I2S DMA size to the current audio buffer size.
+ * @details The buffer size depends on the sample rate, and on the buffer profile that was applied at the start of
+ * streaming.
+ */
+static void audio_update_i2s_size(void) {
     // The I2S size is counted in number of transactions.
-    g_i2s_config.size  = audio_playback_get_buffer_size() / AUDIO_SAMPLE_SIZE;
-    g_i2s_config.i2spr = AUDIO_SPI_GET_I2SPR(sample_rate_hz);
+    g_i2s_config.size = audio_playback_get_buffer_size() / AUDIO_I2S_WORD_SIZE;
+}
+
+/**
+ * @brief Find the clock settings for a sample rate.
+ *
+ * @param sample_rate_hz The sample rate in Hz.
+ * @return const struct audio_clock_config* The pointer to the clock settings, or NULL, if the rate is not supported.
+ */
+static const struct audio_clock_config *audio_get_clock_config(uint32_t sample_rate_hz) {
+    for (size_t config_index = 0u; config_index < ARRAY_LENGTH(g_audio_clock_configs); config_index++) {
+        if (g_audio_clock_configs[config_index].sample_rate_hz == sample_rate_hz) {
+            return &g_audio_clock_configs[config_index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Wait for the I2S PLL to reach a ready state, with a timeout of \a AUDIO_PLLI2S_TIMEOUT .
+ *
+ * @param b_ready True for waiting until the PLL is locked, false for waiting until it stopped.
+ * @return true if the PLL reached the state in time.
+ * @return false on timeout.
+ */
+static bool audio_wait_plli2s(bool b_ready) {
+    const systime_t START_TIME = chVTGetSystemTimeX();
+
+    while (((RCC->CR & RCC_CR_PLLI2SRDY) != 0u) != b_ready) {
+        if (chVTTimeElapsedSinceX(START_TIME) > AUDIO_PLLI2S_TIMEOUT) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reprogram the I2S PLL, if the sample rate family changes.
+ * @details The PLL is disabled while its factors are changed, and the function waits for it to lock again. This must
+ * only be done while the I2S peripheral is disabled, which is the case after its exchange stopped. Is called without
+ * the kernel lock, so that USB and timer interrupts are served while the PLL locks.
+ *
+ * @param p_clock_config The pointer to the clock settings to apply.
+ * @return true if the PLL runs with the requested settings.
+ * @return false if the PLL did not stop, or did not lock in time.
+ */
+static bool audio_update_plli2s(const struct audio_clock_config *p_clock_config) {
+    const uint32_t PLLI2SCFGR_MASK = RCC_PLLI2SCFGR_PLLI2SN | RCC_PLLI2SCFGR_PLLI2SR;
+    const uint32_t PLLI2SCFGR      = (p_clock_config->plli2s_n << RCC_PLLI2SCFGR_PLLI2SN_Pos) |
+                                (p_clock_config->plli2s_r << RCC_PLLI2SCFGR_PLLI2SR_Pos);
+
+    if (((RCC->PLLI2SCFGR & PLLI2SCFGR_MASK) == PLLI2SCFGR) && ((RCC->CR & RCC_CR_PLLI2SRDY) != 0u)) {
+        // The PLL already runs with the requested settings.
+        return true;
+    }
+
+    RCC->CR &= ~RCC_CR_PLLI2SON;
+    if (!audio_wait_plli2s(false)) {
+        return false;
+    }
+
+    RCC->PLLI2SCFGR = (RCC->PLLI2SCFGR & ~PLLI2SCFGR_MASK) | PLLI2SCFGR;
+
+    RCC->CR |= RCC_CR_PLLI2SON;
+    return audio_wait_plli2s(true);
+}
+
+/**
+ * @brief Find the clock settings for the sample rate that the host requested.
+ * @details Unsupported sample rates fall back to the default sample rate.
+ *
+ * @return const struct audio_clock_config* The pointer to the clock settings.
+ */
+static const struct audio_clock_config *audio_get_requested_clock_config(void) {
+    const struct audio_clock_config *p_clock_config = audio_get_clock_config(audio_request_get_sample_rate_hz());
+
+    if (p_clock_config == NULL) {
+        p_clock_config = audio_get_clock_config(AUDIO_DEFAULT_SAMPLE_RATE_HZ);
+    }
+
+    return p_clock_config;
+}
+
+/**
+ * @brief Set up a new sample rate.
+ * @details Configures the \a audio_playback module, as well as the I2S peripheral. With the output active, playback
+ * switches to the new rate in warm idle. The I2S exchange must be stopped in any case. The I2S PLL is reprogrammed
+ * afterwards by \a audio_update_plli2s , outside of the kernel lock.
+ * @note This internally uses I-class functions.
+ *
+ * @return const struct audio_clock_config* The pointer to the clock settings of the new sample rate.
+ */
+static const struct audio_clock_config *audio_update_sample_rate(void) {
+    chDbgAssert(I2S_DRIVER.state != I2S_ACTIVE, "The I2S exchange must be stopped while switching sample rates.");
+
+    const struct audio_clock_config *p_clock_config = audio_get_requested_clock_config();
+
+    if (audio_is_output_active()) {
+        audio_playback_switch_sample_rate(p_clock_config->sample_rate_hz);
+    } else {
+        audio_playback_set_sample_rate(p_clock_config->sample_rate_hz);
+    }
+
+    audio_update_i2s_size();
+    g_i2s_config.i2spr = p_clock_config->i2spr;
+
+    return p_clock_config;
+}
+
+/**
+ * @brief Start I2S output and SOF capture.
+ * @details The I2S DMA size is matched to the audio buffer size first. With capture enabled, the I2S input is
+ * started as well, after the I2S peripheral is clocked, but before the master starts the exchange.
+ */
+static void audio_start_output(void) {
+    chSysLock();
+    audio_update_i2s_size();
+    chSysUnlock();
+
+    i2sStart(&I2S_DRIVER, &g_i2s_config);
+#if AUDIO_CAPTURE_ENABLE
+    audio_capture_start_input(AUDIO_I2S_CFGR);
+#endif
+    i2sStartExchange(&I2S_DRIVER);
+    audio_feedback_start_sof_capture();
+}
+
+/**
+ * @brief Pause I2S output and SOF capture.
+ * @details Only stops the exchange, which disables the I2S peripheral and its DMA stream. The driver keeps its clock
+ * and DMA allocation, so that \a audio_start_output() resumes with a new configuration.
+ */
+static void audio_pause_output(void) {
+    audio_feedback_stop_sof_capture();
+    i2sStopExchange(&I2S_DRIVER);
+#if AUDIO_CAPTURE_ENABLE
+    audio_capture_stop_input();
+#endif
+}
+
+/**
+ * @brief Stop I2S output and SOF capture.
+ * @details Does nothing, if the output is already stopped. This happens, when the output stopped for a sample rate
+ * change, before the \a AUDIO_COMMON_MSG_STOP_PLAYBACK message is handled.
+ */
+static void audio_stop_output(void) {
+    if (I2S_DRIVER.state != I2S_ACTIVE) {
+        return;
+    }
+
+    audio_pause_output();
+    i2sStop(&I2S_DRIVER);
 }
 
 static THD_WORKING_AREA(wa_audio_thread, 256u);
@@ -176,63 +511,103 @@ static THD_FUNCTION(audio_thread, arg) {
     virtual_timer_t volume_reset_timer;
     chVTObjectInit(&volume_reset_timer);
 
-    // Wait for a message from an audio ISR.
+    // Initialize a timer, which ends warm idle.
+    virtual_timer_t warm_idle_timer;
+    chVTObjectInit(&warm_idle_timer);
+
+    // The events of messages, which are still to be posted to the application mailbox.
+    eventmask_t pending_app_events = 0u;
+
+    // Wait for audio message events from audio ISRs. Repeated messages are coalesced, so that the current playback
+    // state is evaluated, instead of replaying every message.
     while (true) {
-        msg_t message;
-        msg_t status = chMBFetchTimeout(&g_audio_mailbox, &message, TIME_INFINITE);
+        eventmask_t events = chEvtWaitAnyTimeout(
+            ALL_EVENTS, (pending_app_events != 0u) ? AUDIO_APP_MESSAGE_RETRY_INTERVAL : TIME_INFINITE);
+
+        if ((events & AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_SAMPLE_RATE)) != 0u) {
+            // Hosts repeat the sample rate at the start of every stream. Only a change of the sample rate reconfigures
+            // the output. A running output is only paused for reprogramming the I2S clocks, and continues in warm idle.
+            chSysLock();
+            uint32_t requested_sample_rate_hz = audio_get_requested_clock_config()->sample_rate_hz;
+            bool     b_sample_rate_changed    = requested_sample_rate_hz != audio_playback_get_sample_rate();
+            bool     b_output_running         = audio_is_output_active() && (I2S_DRIVER.state == I2S_ACTIVE);
+            chSysUnlock();
+
+            LOG_WRITE(LOG_EVENT_AUDIO_SET_SAMPLE_RATE, requested_sample_rate_hz, b_sample_rate_changed);
+
+            if (b_sample_rate_changed) {
+                if (b_output_running) {
+                    audio_pause_output();
+                } else {
+                    // Warm idle may have ended, before the STOP_PLAYBACK message is handled.
+                    audio_stop_output();
+                }
+
+                chSysLock();
+                AUDIO_PROFILE_BEGIN(AUDIO_PROFILE_SITE_THREAD_SAMPLE_RATE);
+                const struct audio_clock_config *p_clock_config = audio_update_sample_rate();
+                AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_THREAD_SAMPLE_RATE);
+                chSysUnlock();
 
-        if (status != MSG_OK) {
-            chSysHalt("Failed to receive message.");
+                // I2S is stopped, so that the PLL is reprogrammed without masking interrupts.
+                if (!audio_update_plli2s(p_clock_config)) {
+                    LOG_WRITE_EVENT(LOG_EVENT_AUDIO_PLLI2S_TIMEOUT);
+                } else if (b_output_running) {
+                    audio_start_output();
+                }
+            }
         }
 
-        switch (message) {
-            case AUDIO_COMMON_MSG_START_PLAYBACK:
-                PRINTF("### Start playback.\n");
+        if ((events & AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_STOP_PLAYBACK)) != 0u) {
+            LOG_WRITE_EVENT(LOG_EVENT_AUDIO_STOP_PLAYBACK);
 
-                // Set volumes to the values configured via USB audio.
-                audio_send_app_message(AUDIO_COMMON_MSG_SET_VOLUME);
+            audio_stop_output();
+
+            chVTSet(&volume_reset_timer, AUDIO_RESET_VOLUME_TIMEOUT, audio_volume_reset_cb, NULL);
+        }
 
-                i2sStart(&I2S_DRIVER, &g_i2s_config);
-                i2sStartExchange(&I2S_DRIVER);
-                audio_feedback_start_sof_capture();
-                break;
+        chSysLock();
+        AUDIO_PROFILE_BEGIN(AUDIO_PROFILE_SITE_THREAD_PLAYBACK_STATE);
+        // Capture needs the I2S clocks. Without playback, the output runs with silence in warm idle.
+        if (audio_is_capture_streaming()) {
+            audio_playback_start_warm_idle();
+        }
 
-            case AUDIO_COMMON_MSG_STOP_PLAYBACK:
-                PRINTF("### Stop playback.\n");
+        bool b_output_active = audio_is_output_active();
+        bool b_warm_idle     = audio_playback_get_state() == AUDIO_PLAYBACK_STATE_WARM_IDLE;
+        AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_THREAD_PLAYBACK_STATE);
+        chSysUnlock();
 
-                audio_feedback_stop_sof_capture();
-                i2sStopExchange(&I2S_DRIVER);
-                i2sStop(&I2S_DRIVER);
+        // Playback may have stopped and started again, before the audio thread ran. Start the output, if playback is
+        // active by now, regardless of the order of the messages.
+        if (b_output_active && (I2S_DRIVER.state != I2S_ACTIVE)) {
+            LOG_WRITE_EVENT(LOG_EVENT_AUDIO_START_PLAYBACK);
 
-                chVTSet(&volume_reset_timer, AUDIO_RESET_VOLUME_TIMEOUT, audio_volume_reset_cb, NULL);
-                break;
+            // Set volumes to the values configured via USB audio.
+            pending_app_events |= AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_VOLUME);
 
-            case AUDIO_COMMON_MSG_SET_SAMPLE_RATE:
-                PRINTF("### Set sample rate.\n");
+            audio_start_output();
+        }
 
-                chSysLock();
-                audio_update_sample_rate();
-                chSysUnlock();
-                break;
+        // Capture holds warm idle. When it stops streaming, the timer ends warm idle, unless playback resumes before.
+        const eventmask_t WARM_IDLE_EVENTS = AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_START_WARM_IDLE) |
+                                             AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_CAPTURE_STATE);
 
-            // Relay messages to the app layer.
-            case AUDIO_COMMON_MSG_SET_MUTE_STATE:
-            case AUDIO_COMMON_MSG_SET_VOLUME:
-            case AUDIO_COMMON_MSG_RESET_VOLUME:
-                // Do not update volume and mute levels, when not playing back.
-                chSysLock();
-                bool b_playing = audio_playback_get_state() == AUDIO_PLAYBACK_STATE_PLAYING;
-                chSysUnlock();
+        if (((events & WARM_IDLE_EVENTS) != 0u) && b_warm_idle) {
+            LOG_WRITE_EVENT(LOG_EVENT_AUDIO_START_WARM_IDLE);
 
-                if (b_playing) {
-                    audio_send_app_message(message);
-                }
-                break;
+            chVTSet(&warm_idle_timer, TIME_MS2I(AUDIO_WARM_IDLE_TIMEOUT_MS), audio_warm_idle_timeout_cb, NULL);
+        }
 
-            default:
-                chSysHalt("Unknown message type.");
-                break;
+        // Relay messages to the app layer. Do not update volume and mute levels, when the output is stopped.
+        if (b_output_active) {
+            pending_app_events |= events & (AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_VOLUME) |
+                                            AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_MUTE_STATE));
+        } else {
+            pending_app_events |= events & AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_RESET_VOLUME);
         }
+
+        pending_app_events = audio_send_app_messages(pending_app_events);
     }
 }
 
@@ -242,11 +617,38 @@ static THD_FUNCTION(audio_thread, arg) {
  * @param p_mailbox The pointer to the mailbox, where audio messages are posted. To be provided by the user application.
  */
 void audio_setup(mailbox_t *p_mailbox) {
+    // Create the audio thread first, so that ISRs can signal it. It only acts on events, which follow the setup.
+    gp_audio_thread = chThdCreateStatic(wa_audio_thread, sizeof(wa_audio_thread), NORMALPRIO, audio_thread, NULL);
+
+#if AUDIO_CAPTURE_ENABLE
+    audio_capture_setup();
+#endif
+
+#if AUDIO_DSP_ENABLE
+    audio_dsp_setup();
+#endif
+
     chSysLock();
-    audio_request_init(&g_audio_mailbox);
-    audio_playback_init(&g_audio_mailbox);
+#if AUDIO_PROFILE
+    audio_profile_init();
+#endif
+    audio_request_init(gp_audio_thread);
+    audio_playback_init(gp_audio_thread);
+#if AUDIO_DSP_ENABLE
+    audio_dsp_init(audio_playback_process_samples);
+#endif
+    audio_volume_init();
+#if AUDIO_TDM_ENABLE
+    audio_tdm_init();
+#endif
     audio_feedback_init();
-    audio_update_sample_rate();
+#if AUDIO_CAPTURE_ENABLE
+    audio_capture_init(gp_audio_thread);
+#endif
+#if AUDIO_LATENCY_TEST_ENABLE
+    audio_latency_init();
+#endif
+    const struct audio_clock_config *p_clock_config = audio_update_sample_rate();
 
     // Connect the playback buffer with the I2S peripheral.
     g_i2s_config.tx_buffer = (const void *)audio_playback_get_buffer();
@@ -255,10 +657,9 @@ void audio_setup(mailbox_t *p_mailbox) {
     audio_init_context(&g_audio_context, p_mailbox);
     chSysUnlock();
 
-    chMBObjectInit(&g_audio_mailbox, g_audio_mailbox_buffer, ARRAY_LENGTH(g_audio_mailbox_buffer));
-
-    // Start the audio thread at the end.
-    chThdCreateStatic(wa_audio_thread, sizeof(wa_audio_thread), NORMALPRIO, audio_thread, NULL);
+    if (!audio_update_plli2s(p_clock_config)) {
+        LOG_WRITE_EVENT(LOG_EVENT_AUDIO_PLLI2S_TIMEOUT);
+    }
 }
 
 /**
@@ -11,10 +11,16 @@
 #ifndef SOURCE_AUDIO_AUDIO_H_
 #define SOURCE_AUDIO_AUDIO_H_
 
+#include "audio_capture.h"
 #include "audio_common.h"
+#include "audio_dsp.h"
 #include "audio_feedback.h"
+#include "audio_latency.h"
 #include "audio_playback.h"
+#include "audio_profile.h"
 #include "audio_request.h"
+#include "audio_stats.h"
+#include "audio_tdm.h"
 
 void audio_setup(mailbox_t *p_mailbox);
 void audio_reset(USBDriver *p_usb);
@@ -0,0 +1,384 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio capture module.
+ * @details Records the I2S input, and streams it to the host via an isochronous IN endpoint. The I2S3 extension
+ * receives as a slave in full-duplex with the I2S3 output, so that capture, playback, and the feedback measurement
+ * share a single clock domain. A dedicated DMA stream writes the received frames into a circular capture buffer.
+ *
+ * Every packet holds the number of frames that the I2S input receives within an SOF period, as measured by the
+ * feedback module from the I2S master clock. The fractional part is carried over to the following packets. The
+ * capture delay (the distance between the DMA write position and the read position of the next packet) is held at one
+ * nominal packet by single-frame corrections, so that the round-trip latency is deterministic.
+ *
+ * Captured frames only arrive while the I2S clocks run. While the host streams from the capture endpoint, the audio
+ * thread keeps the output in warm idle, if playback is idle. Until the I2S input runs, silent packets of nominal size
+ * are transmitted.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_capture.h"
+
+#include <string.h>
+
+#include "audio_feedback.h"
+#include "audio_latency.h"
+#include "audio_playback.h"
+#include "usb_descriptors.h"
+
+#if AUDIO_CAPTURE_ENABLE
+
+/**
+ * @brief The DMA stream that serves I2S3ext_RX (DMA1 stream 2, channel 2).
+ */
+#define AUDIO_CAPTURE_DMA_STREAM STM32_DMA_STREAM_ID(1u, 2u)
+
+/**
+ * @brief The DMA channel of I2S3ext_RX on \a AUDIO_CAPTURE_DMA_STREAM .
+ */
+#define AUDIO_CAPTURE_DMA_CHANNEL 2u
+
+/**
+ * @brief The line of the I2S3ext_SD pin (PC11).
+ */
+#define AUDIO_CAPTURE_SD_LINE PAL_LINE(GPIOC, 11u)
+
+/**
+ * @brief The alternate function of the I2S3ext_SD pin.
+ */
+#define AUDIO_CAPTURE_SD_ALTERNATE_FUNCTION 5u
+
+/**
+ * @brief The number of half-words in an I2S slot.
+ * @details The DMA transfers half-words. For 32 bit data words, the most significant half-word comes first.
+ */
+#define AUDIO_CAPTURE_SLOT_HALF_WORD_COUNT (AUDIO_I2S_WORD_SIZE / 2u)
+
+/**
+ * @brief The number of half-words in an I2S frame of two slots.
+ */
+#define AUDIO_CAPTURE_FRAME_HALF_WORD_COUNT (2u * AUDIO_CAPTURE_SLOT_HALF_WORD_COUNT)
+
+/**
+ * @brief The number of half-words in the capture buffer.
+ */
+#define AUDIO_CAPTURE_BUFFER_HALF_WORD_COUNT (AUDIO_CAPTURE_BUFFER_FRAME_COUNT * AUDIO_CAPTURE_FRAME_HALF_WORD_COUNT)
+
+/**
+ * @brief The number of fractional bits in the 10.14 feedback format.
+ */
+#define AUDIO_CAPTURE_FRACTION_BITS 14u
+
+/**
+ * @brief The size of the TX FIFO of the control endpoint in bytes.
+ */
+#define AUDIO_CAPTURE_CONTROL_TX_FIFO_SIZE 64u
+
+#if (AUDIO_CAPTURE_CHANNEL_COUNT < 1u) || (AUDIO_CAPTURE_CHANNEL_COUNT > 2u)
+#error "Unsupported number of capture channels. Must be 1, or 2."
+#endif
+
+#if (AUDIO_CAPTURE_BUFFER_FRAME_COUNT & (AUDIO_CAPTURE_BUFFER_FRAME_COUNT - 1u)) != 0u
+#error "The capture buffer frame count must be a power of two."
+#endif
+
+// The sample rate enumeration is not available to the preprocessor, so that the checks use numeric sample rates.
+#if AUDIO_CAPTURE_BUFFER_FRAME_COUNT < (2u * AUDIO_COMMON_GET_MAX_PACKET_SIZE(1u, 96000u, 1u))
+#error "The capture buffer must hold at least two packets at the maximum sample rate."
+#endif
+
+// The TX FIFOs of the control, feedback, and capture endpoints share the FIFO memory with the RX FIFO.
+#if (STM32_USB_OTG1_RX_FIFO_SIZE + AUDIO_CAPTURE_CONTROL_TX_FIFO_SIZE + USB_DESC_MAX_IN_SIZE +                      \
+     AUDIO_COMMON_GET_MAX_PACKET_SIZE(AUDIO_CAPTURE_CHANNEL_COUNT, 96000u, AUDIO_CAPTURE_SAMPLE_SIZE) +               \
+     (2u * AUDIO_CAPTURE_FRAME_SIZE)) > (4u * STM32_OTG1_FIFO_MEM_SIZE)
+#error "The capture endpoint does not fit into the USB FIFO memory. Reduce the RX FIFO, or the capture channel count."
+#endif
+
+/**
+ * @brief A structure that holds the state of audio capture, as well as the capture buffer.
+ */
+static struct audio_capture {
+    int16_t buffer[AUDIO_CAPTURE_BUFFER_HALF_WORD_COUNT];  ///< The capture buffer, which the I2S input DMA fills.
+    int16_t packet[AUDIO_CAPTURE_MAX_PACKET_SIZE / AUDIO_CAPTURE_SAMPLE_SIZE];  ///< The packet in transmission.
+    const stm32_dma_stream_t *p_dma_stream;      ///< The DMA stream of the I2S input.
+    size_t                    read_frame_index;  ///< The index of the next frame to transmit.
+    uint32_t                  frame_fraction;    ///< The fractional frame count, carried over to the next packet.
+    bool                      b_is_streaming;    ///< True, if the host streams from the capture endpoint.
+    bool                      b_is_receiving;    ///< True, if the I2S input receives frames.
+    bool                      b_is_aligned;      ///< True, if the read position follows the DMA write position.
+} g_capture;
+
+/**
+ * @brief A pointer to the audio thread, which receives event flags.
+ */
+static thread_t *gp_audio_thread;
+
+/**
+ * @brief Determine, whether the host streams from the capture endpoint.
+ *
+ * @return true if the host streams.
+ * @return false if the capture endpoint is in its zero-bandwidth alternate mode.
+ */
+bool audio_capture_is_streaming(void) {
+    chDbgCheckClassI();
+    return g_capture.b_is_streaming;
+}
+
+/**
+ * @brief Get the index of the frame, which the I2S input DMA writes next.
+ *
+ * @return size_t The frame index.
+ */
+static size_t audio_capture_get_write_frame_index(void) {
+    chDbgCheckClassI();
+    size_t remaining_half_word_count = dmaStreamGetTransactionSize(g_capture.p_dma_stream);
+
+    return (AUDIO_CAPTURE_BUFFER_HALF_WORD_COUNT - remaining_half_word_count) / AUDIO_CAPTURE_FRAME_HALF_WORD_COUNT;
+}
+
+/**
+ * @brief Get the number of frames to transmit with the next packet.
+ * @details Accumulates the measured number of frames per SOF period. Until the measurement is valid, the nominal
+ * sample rate is used.
+ *
+ * @return size_t The number of frames.
+ */
+static size_t audio_capture_get_frame_count(void) {
+    chDbgCheckClassI();
+    uint32_t frames_per_packet;
+
+    if (!g_capture.b_is_receiving || !audio_feedback_get_measured_value(&frames_per_packet)) {
+        frames_per_packet = (audio_playback_get_sample_rate() << AUDIO_CAPTURE_FRACTION_BITS) / 1000u;
+    }
+
+    g_capture.frame_fraction += frames_per_packet;
+
+    size_t frame_count = (size_t)(g_capture.frame_fraction >> AUDIO_CAPTURE_FRACTION_BITS);
+    g_capture.frame_fraction &= (1u << AUDIO_CAPTURE_FRACTION_BITS) - 1u;
+
+    return frame_count;
+}
+
+/**
+ * @brief Correct the number of frames of the next packet, so that the capture delay stays at one nominal packet.
+ * @details On the first packet after the I2S input started, the read position is placed behind the DMA write position
+ * instead. Deviations of more than half a packet are corrected by a single frame per packet.
+ *
+ * @param frame_count The measured number of frames.
+ * @return size_t The corrected number of frames.
+ */
+static size_t audio_capture_correct_frame_count(size_t frame_count) {
+    chDbgCheckClassI();
+    const size_t FRAME_INDEX_MASK    = AUDIO_CAPTURE_BUFFER_FRAME_COUNT - 1u;
+    const size_t MAX_FRAME_COUNT     = AUDIO_CAPTURE_MAX_PACKET_SIZE / AUDIO_CAPTURE_FRAME_SIZE;
+    const size_t NOMINAL_FRAME_COUNT = audio_playback_get_sample_rate() / 1000u;
+    const size_t WRITE_FRAME_INDEX   = audio_capture_get_write_frame_index();
+
+    if (!g_capture.b_is_aligned) {
+        g_capture.read_frame_index = (WRITE_FRAME_INDEX - NOMINAL_FRAME_COUNT - frame_count) & FRAME_INDEX_MASK;
+        g_capture.b_is_aligned     = true;
+    }
+
+    // The number of received frames, which were not yet transmitted.
+    const size_t PENDING_FRAME_COUNT = (WRITE_FRAME_INDEX - g_capture.read_frame_index) & FRAME_INDEX_MASK;
+
+    if (PENDING_FRAME_COUNT > (frame_count + NOMINAL_FRAME_COUNT + (NOMINAL_FRAME_COUNT / 2u))) {
+        frame_count++;
+    } else if ((PENDING_FRAME_COUNT + (NOMINAL_FRAME_COUNT / 2u)) < (frame_count + NOMINAL_FRAME_COUNT)) {
+        frame_count--;
+    }
+
+    if (frame_count > PENDING_FRAME_COUNT) {
+        // Never transmit frames that were not yet received.
+        frame_count = PENDING_FRAME_COUNT;
+    }
+
+    if (frame_count > MAX_FRAME_COUNT) {
+        frame_count = MAX_FRAME_COUNT;
+    }
+
+    return frame_count;
+}
+
+/**
+ * @brief Copy frames from the capture buffer into the packet, and advance the read position.
+ * @details Only the most significant half-word of every captured slot is transmitted.
+ *
+ * @param frame_count The number of frames to copy.
+ */
+static void audio_capture_copy_frames(size_t frame_count) {
+    chDbgCheckClassI();
+    int16_t *p_sample = g_capture.packet;
+
+    for (size_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        const int16_t *p_frame = &g_capture.buffer[g_capture.read_frame_index * AUDIO_CAPTURE_FRAME_HALF_WORD_COUNT];
+
+        for (size_t channel_index = 0; channel_index < AUDIO_CAPTURE_CHANNEL_COUNT; channel_index++) {
+            *p_sample++ = p_frame[channel_index * AUDIO_CAPTURE_SLOT_HALF_WORD_COUNT];
+        }
+
+        g_capture.read_frame_index = (g_capture.read_frame_index + 1u) & (AUDIO_CAPTURE_BUFFER_FRAME_COUNT - 1u);
+    }
+}
+
+/**
+ * @brief Joint callback for when a capture packet was transmitted, or its transmission failed.
+ * @details Prepares the packet for the next frame.
+ *
+ * @param p_usb A pointer to the USB driver structure.
+ * @param endpoint_identifier The endpoint, for which the callback was called.
+ */
+void audio_capture_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
+    chSysLockFromISR();
+
+    if (!g_capture.b_is_streaming) {
+        chSysUnlockFromISR();
+        return;
+    }
+
+    size_t frame_count = audio_capture_get_frame_count();
+
+    if (g_capture.b_is_receiving) {
+        frame_count = audio_capture_correct_frame_count(frame_count);
+        audio_capture_copy_frames(frame_count);
+
+#if AUDIO_LATENCY_TEST_ENABLE
+        const size_t DELAY_FRAME_COUNT = (audio_capture_get_write_frame_index() - g_capture.read_frame_index) &
+                                         (AUDIO_CAPTURE_BUFFER_FRAME_COUNT - 1u);
+
+        audio_latency_detect(g_capture.packet, frame_count, DELAY_FRAME_COUNT, (uint16_t)usbGetFrameNumberX(p_usb));
+#endif
+    } else {
+        memset(g_capture.packet, 0, frame_count * AUDIO_CAPTURE_FRAME_SIZE);
+    }
+
+    usbStartTransmitI(p_usb, endpoint_identifier, (const uint8_t *)g_capture.packet,
+                      frame_count * AUDIO_CAPTURE_FRAME_SIZE);
+
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Start streaming captured audio via USB.
+ * @details Is called, when the capture endpoint goes into its operational alternate mode. Signals
+ * \a AUDIO_COMMON_MSG_SET_CAPTURE_STATE , so that the audio thread starts the I2S clocks, if they are stopped.
+ *
+ * @param p_usb The pointer to the USB driver structure.
+ */
+void audio_capture_start_streaming(USBDriver *p_usb) {
+    chSysLockFromISR();
+
+    g_capture.b_is_streaming = true;
+    g_capture.b_is_aligned   = false;
+    g_capture.frame_fraction = 0u;
+
+    // Start with an empty packet. Every following packet is prepared, when the previous one was transmitted.
+    if (!usbGetTransmitStatusI(p_usb, USB_DESC_ENDPOINT_CAPTURE)) {
+        usbStartTransmitI(p_usb, USB_DESC_ENDPOINT_CAPTURE, NULL, 0);
+    }
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_CAPTURE_STATE));
+
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Stop streaming captured audio.
+ * @details Is called, when the capture endpoint goes into its zero-bandwidth alternate mode, or by \a audio_reset() .
+ *
+ * @param p_usb The pointer to the USB driver structure (unused).
+ */
+void audio_capture_stop_streaming(USBDriver *p_usb) {
+    (void)p_usb;
+
+    chSysLockFromISR();
+
+    if (g_capture.b_is_streaming) {
+        g_capture.b_is_streaming = false;
+        chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_CAPTURE_STATE));
+    }
+
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Start the I2S input.
+ * @details Configures the I2S3 extension as a slave receiver with the frame format of the I2S output. Must be called
+ * after the I2S driver was started, but before its exchange starts, as the slave must be enabled before the master.
+ *
+ * @param i2s_configuration The I2SCFGR data and channel length settings of the I2S output.
+ */
+void audio_capture_start_input(uint16_t i2s_configuration) {
+    chSysLock();
+
+    I2S3ext->I2SCFGR = SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SCFG_0 | i2s_configuration;
+    I2S3ext->CR2     = SPI_CR2_RXDMAEN;
+
+    dmaStreamSetPeripheral(g_capture.p_dma_stream, &I2S3ext->DR);
+    dmaStreamSetMemory0(g_capture.p_dma_stream, g_capture.buffer);
+    dmaStreamSetTransactionSize(g_capture.p_dma_stream, AUDIO_CAPTURE_BUFFER_HALF_WORD_COUNT);
+    dmaStreamSetMode(g_capture.p_dma_stream, STM32_DMA_CR_CHSEL(AUDIO_CAPTURE_DMA_CHANNEL) |
+                                                 STM32_DMA_CR_PL(STM32_I2S_SPI3_DMA_PRIORITY) | STM32_DMA_CR_DIR_P2M |
+                                                 STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD |
+                                                 STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC);
+    dmaStreamEnable(g_capture.p_dma_stream);
+
+    I2S3ext->I2SCFGR |= SPI_I2SCFGR_I2SE;
+
+    g_capture.b_is_receiving = true;
+    g_capture.b_is_aligned   = false;
+
+    chSysUnlock();
+}
+
+/**
+ * @brief Stop the I2S input.
+ * @details Must be called after the exchange of the I2S driver stopped.
+ */
+void audio_capture_stop_input(void) {
+    chSysLock();
+
+    g_capture.b_is_receiving = false;
+
+    I2S3ext->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    I2S3ext->CR2 = 0u;
+    dmaStreamDisable(g_capture.p_dma_stream);
+
+    chSysUnlock();
+}
+
+/**
+ * @brief Initialize the audio capture module.
+ *
+ * @param p_audio_thread A pointer to the audio thread, which receives event flags.
+ */
+void audio_capture_init(thread_t *p_audio_thread) {
+    chDbgCheckClassI();
+    gp_audio_thread = p_audio_thread;
+
+    g_capture.read_frame_index = 0u;
+    g_capture.frame_fraction   = 0u;
+    g_capture.b_is_streaming   = false;
+    g_capture.b_is_receiving   = false;
+    g_capture.b_is_aligned     = false;
+}
+
+/**
+ * @brief Set up the I2S input pin, and allocate the I2S input DMA stream.
+ * @details Must be called once, before \a audio_capture_init() .
+ */
+void audio_capture_setup(void) {
+    palSetLineMode(AUDIO_CAPTURE_SD_LINE, PAL_MODE_ALTERNATE(AUDIO_CAPTURE_SD_ALTERNATE_FUNCTION));
+
+    g_capture.p_dma_stream = dmaStreamAlloc(AUDIO_CAPTURE_DMA_STREAM, STM32_I2S_SPI3_IRQ_PRIORITY, NULL, NULL);
+    chDbgAssert(g_capture.p_dma_stream != NULL, "The capture DMA stream is not available.");
+}
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,32 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio capture module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_CAPTURE_H_
+#define SOURCE_AUDIO_AUDIO_CAPTURE_H_
+
+#include "audio_common.h"
+
+bool audio_capture_is_streaming(void);
+
+void audio_capture_start_streaming(USBDriver *p_usb);
+void audio_capture_stop_streaming(USBDriver *p_usb);
+void audio_capture_cb(USBDriver *p_usb, usbep_t endpoint_identifier);
+
+void audio_capture_start_input(uint16_t i2s_configuration);
+void audio_capture_stop_input(void);
+
+void audio_capture_init(thread_t *p_audio_thread);
+void audio_capture_setup(void);
+
+#endif  // SOURCE_AUDIO_AUDIO_CAPTURE_H_
+
+/**
+ * @}
+ */
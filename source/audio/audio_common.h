@@ -34,51 +34,209 @@ enum audio_common_channel {
 
 /**
  * @brief Commonly used audio messages.
+ * @details Audio ISRs signal messages to the audio thread as event flags (see \a AUDIO_COMMON_EVENT ), so that repeated
+ * messages coalesce until the thread handles them. Volume and mute messages are relayed to the application mailbox.
  */
 enum audio_common_msg {
-    AUDIO_COMMON_MSG_START_PLAYBACK,   ///< Start playback (I2S data output).
-    AUDIO_COMMON_MSG_STOP_PLAYBACK,    ///< Stop playback (I2S data output).
-    AUDIO_COMMON_MSG_SET_MUTE_STATE,   ///< Set new mute states.
-    AUDIO_COMMON_MSG_SET_VOLUME,       ///< Set new volume levels.
-    AUDIO_COMMON_MSG_SET_SAMPLE_RATE,  ///< Set a new sample rate.
-    AUDIO_COMMON_MSG_RESET_VOLUME,     ///< Reset volume levels.
+    AUDIO_COMMON_MSG_START_PLAYBACK,     ///< Start playback (I2S data output).
+    AUDIO_COMMON_MSG_STOP_PLAYBACK,      ///< Stop playback (I2S data output).
+    AUDIO_COMMON_MSG_SET_MUTE_STATE,     ///< Set new mute states.
+    AUDIO_COMMON_MSG_SET_VOLUME,         ///< Set new volume levels.
+    AUDIO_COMMON_MSG_SET_SAMPLE_RATE,    ///< Set a new sample rate.
+    AUDIO_COMMON_MSG_RESET_VOLUME,       ///< Reset volume levels.
+    AUDIO_COMMON_MSG_START_WARM_IDLE,    ///< Keep I2S data output running with silence, until streaming resumes.
+    AUDIO_COMMON_MSG_SET_CAPTURE_STATE,  ///< Start or stop streaming from the capture endpoint.
+};
+
+/**
+ * @brief Get the event flag, with which an audio message is signaled to the audio thread.
+ *
+ * @param _message The audio message.
+ */
+#define AUDIO_COMMON_EVENT(_message) EVENT_MASK(_message)
+
+/**
+ * @brief The audio buffer profiles, which trade latency for tolerance against packet timing variations.
+ * @details A profile is selected at runtime, and takes effect at the start of the next audio stream.
+ */
+enum audio_buffer_profile {
+    AUDIO_BUFFER_PROFILE_DEFAULT,      ///< Holds \a AUDIO_BUFFER_PACKET_COUNT packets.
+    AUDIO_BUFFER_PROFILE_LOW_LATENCY,  ///< Holds \a AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY packets.
+    AUDIO_BUFFER_PROFILE_ROBUST,       ///< Holds \a AUDIO_BUFFER_PACKET_COUNT_ROBUST packets.
+    AUDIO_BUFFER_PROFILE_COUNT         ///< The number of buffer profiles.
+};
+
+/**
+ * @brief The formats of the audio stream, as received via USB.
+ */
+enum audio_stream_format {
+    AUDIO_STREAM_FORMAT_NATIVE,         ///< Samples of \a AUDIO_SAMPLE_SIZE bytes, matching the I2S layout.
+    AUDIO_STREAM_FORMAT_PACKED_24_BIT,  ///< Packed 24 bit samples of \a AUDIO_PACKED_SAMPLE_SIZE bytes.
+};
+
+/**
+ * @brief The time of reception of an audio packet, which is taken in the packet interrupt.
+ * @details Travels with the packet's samples through the sample path, so that deferred stages refer to the packet's
+ * SOF, not to a later one.
+ */
+struct audio_packet_timestamp {
+    uint32_t sof_timer_count;  ///< The count of the feedback timer at the SOF, before which the packet was received.
+    uint16_t frame_number;     ///< The USB frame number, in which the packet was received.
+    bool     b_is_valid;       ///< True, if the feedback timer captured the SOF.
 };
 
 /**
  * @brief Supported audio sample rates.
+ * @details The 44.1 kHz and the 48 kHz family each use their own I2S PLL setting.
  */
 enum audio_sample_rate {
+    AUDIO_SAMPLE_RATE_44_1_KHZ   = 44100u,
     AUDIO_SAMPLE_RATE_48_KHZ     = 48000u,
+    AUDIO_SAMPLE_RATE_88_2_KHZ   = 88200u,
     AUDIO_SAMPLE_RATE_96_KHZ     = 96000u,
     AUDIO_DEFAULT_SAMPLE_RATE_HZ = AUDIO_SAMPLE_RATE_48_KHZ,
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
     AUDIO_MAX_SAMPLE_RATE_HZ     = AUDIO_SAMPLE_RATE_96_KHZ,
+#else
+    AUDIO_MAX_SAMPLE_RATE_HZ     = AUDIO_SAMPLE_RATE_48_KHZ,
+#endif
 };
 
+/**
+ * @brief The number of TDM slots in an I2S frame, when the TDM output is enabled.
+ */
+#define AUDIO_TDM_SLOT_COUNT 4u
+
 /**
  * @brief The number of audio channels.
+ * @details With the TDM output, there is one channel per TDM slot.
  */
+#if AUDIO_TDM_ENABLE
+#define AUDIO_CHANNEL_COUNT AUDIO_TDM_SLOT_COUNT
+#else
 #define AUDIO_CHANNEL_COUNT 2u
+#endif
+
+#if AUDIO_TDM_ENABLE && (AUDIO_RESOLUTION_BIT != 16u)
+#error "The TDM output requires a resolution of 16 bit."
+#endif
 
 /**
  * @brief The size of an audio sample in bytes.
  */
 #define AUDIO_SAMPLE_SIZE AUDIO_COMMON_GET_SAMPLE_SIZE(AUDIO_RESOLUTION_BIT)
 
+/**
+ * @brief The size of an audio frame (one sample for every channel) in bytes.
+ */
+#define AUDIO_FRAME_SIZE (AUDIO_CHANNEL_COUNT * AUDIO_SAMPLE_SIZE)
+
+/**
+ * @brief The size of a data word in the I2S frame in bytes.
+ * @details With the TDM output, each 32 bit word holds two 16 bit slots.
+ */
+#if AUDIO_TDM_ENABLE
+#define AUDIO_I2S_WORD_SIZE 4u
+#else
+#define AUDIO_I2S_WORD_SIZE AUDIO_SAMPLE_SIZE
+#endif
+
 /**
  * @brief The maximum audio packet size to be received, in bytes.
  * @details Due to the feedback mechanism, a frame can be larger than a nominal packet. If the device
- * reports a too low sample rate, the host has to send a larger packet.
+ * reports a too low sample rate, the host has to send a larger packet. For sample rates that are not a multiple of
+ * 1 kHz, the nominal packet size alternates, so that the larger one is used.
  * @note Reserve an extra number of full samples, e.g. eight.
  * @warning Do not choose a value that might cause the total amount of available RX FIFO buffer to be exceeded.
  */
 #define AUDIO_MAX_PACKET_SIZE                                                                                          \
-    AUDIO_COMMON_GET_PACKET_SIZE(AUDIO_CHANNEL_COUNT, AUDIO_MAX_SAMPLE_RATE_HZ, AUDIO_SAMPLE_SIZE) +                   \
+    AUDIO_COMMON_GET_MAX_PACKET_SIZE(AUDIO_CHANNEL_COUNT, AUDIO_MAX_SAMPLE_RATE_HZ, AUDIO_SAMPLE_SIZE) +               \
         (8u * AUDIO_SAMPLE_SIZE)
 
+/**
+ * @brief The size of a packed 24 bit audio sample in bytes.
+ */
+#define AUDIO_PACKED_SAMPLE_SIZE 3u
+
+/**
+ * @brief The resolution of a packed audio sample in bits.
+ */
+#define AUDIO_PACKED_RESOLUTION_BIT 24u
+
+/**
+ * @brief The maximum packed 24 bit audio packet size to be received, in bytes.
+ * @details Reserves the same number of extra samples as \a AUDIO_MAX_PACKET_SIZE , so that an expanded packet never
+ * exceeds \a AUDIO_MAX_PACKET_SIZE .
+ */
+#define AUDIO_MAX_PACKED_PACKET_SIZE                                                                                   \
+    AUDIO_COMMON_GET_MAX_PACKET_SIZE(AUDIO_CHANNEL_COUNT, AUDIO_MAX_SAMPLE_RATE_HZ, AUDIO_PACKED_SAMPLE_SIZE) +        \
+        (8u * AUDIO_PACKED_SAMPLE_SIZE)
+
+#if AUDIO_PACKED_24_BIT_ENABLE && (AUDIO_RESOLUTION_BIT != 32u)
+#error "The packed 24 bit stream format requires a resolution of 32 bit."
+#endif
+
+/**
+ * @brief The resolution of a captured audio sample in bits.
+ * @details Captured samples are truncated to their most significant half-word, so that the capture endpoint fits into
+ * the TX FIFO space, which remains next to the RX FIFO.
+ */
+#define AUDIO_CAPTURE_RESOLUTION_BIT 16u
+
+/**
+ * @brief The size of a captured audio sample in bytes.
+ */
+#define AUDIO_CAPTURE_SAMPLE_SIZE AUDIO_COMMON_GET_SAMPLE_SIZE(AUDIO_CAPTURE_RESOLUTION_BIT)
+
+/**
+ * @brief The size of a captured audio frame (one sample for every captured channel) in bytes.
+ */
+#define AUDIO_CAPTURE_FRAME_SIZE (AUDIO_CAPTURE_CHANNEL_COUNT * AUDIO_CAPTURE_SAMPLE_SIZE)
+
+/**
+ * @brief The maximum audio packet size to be transmitted by the capture endpoint, in bytes.
+ * @details The number of frames per packet follows the measured I2S sample rate, and may be corrected by one frame, so
+ * that two extra frames are reserved.
+ */
+#define AUDIO_CAPTURE_MAX_PACKET_SIZE                                                                                  \
+    (AUDIO_COMMON_GET_MAX_PACKET_SIZE(AUDIO_CAPTURE_CHANNEL_COUNT, AUDIO_MAX_SAMPLE_RATE_HZ,                          \
+                                      AUDIO_CAPTURE_SAMPLE_SIZE) +                                                     \
+     (2u * AUDIO_CAPTURE_FRAME_SIZE))
+
+#if AUDIO_CAPTURE_ENABLE && AUDIO_TDM_ENABLE
+#error "The capture path requires two-channel I2S frames, and cannot be combined with the TDM output."
+#endif
+
+#if AUDIO_LATENCY_TEST_ENABLE && !AUDIO_CAPTURE_ENABLE
+#error "The latency test mode detects its markers on the capture path, which must be enabled."
+#endif
+
+// Playback starts at half the buffer plus half a packet. With fewer than three packets, the fill size wraps around,
+// before it reaches that target.
+#if (AUDIO_BUFFER_PACKET_COUNT < 3u) || (AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY < 3u) ||                              \
+    (AUDIO_BUFFER_PACKET_COUNT_ROBUST < 3u)
+#error "The audio buffer must hold at least three packets with every buffer profile."
+#endif
+
+/**
+ * @brief The largest number of packets that the audio buffer holds, among all buffer profiles.
+ */
+#define AUDIO_MAX_BUFFER_PACKET_COUNT                                                                                  \
+    AUDIO_COMMON_MAX(AUDIO_COMMON_MAX(AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY, AUDIO_BUFFER_PACKET_COUNT),               \
+                     AUDIO_BUFFER_PACKET_COUNT_ROBUST)
+
 /**
  * @brief The size of the audio buffer in bytes.
  */
-#define AUDIO_MAX_BUFFER_SIZE AUDIO_COMMON_GET_BUFFER_SIZE(AUDIO_MAX_PACKET_SIZE, AUDIO_BUFFER_PACKET_COUNT)
+#define AUDIO_MAX_BUFFER_SIZE AUDIO_COMMON_GET_BUFFER_SIZE(AUDIO_MAX_BUFFER_PACKET_COUNT, AUDIO_MAX_PACKET_SIZE)
+
+/**
+ * @brief Get the larger of two values.
+ *
+ * @param _a The first value.
+ * @param _b The second value.
+ */
+#define AUDIO_COMMON_MAX(_a, _b) (((_a) > (_b)) ? (_a) : (_b))
 
 /**
  * @brief Get the sample size, from the resolution in bit.
@@ -88,7 +246,9 @@ enum audio_sample_rate {
 #define AUDIO_COMMON_GET_SAMPLE_SIZE(_resolution_bit) ((_resolution_bit) / 8u)
 
 /**
- * @brief Calculate the audio packet size.
+ * @brief Calculate the nominal audio packet size.
+ * @details For sample rates that are not a multiple of 1 kHz (e.g. 44.1 kHz), the host alternates between packets of
+ * this size, and packets that hold one more frame.
  *
  * @param _channel_count The number of audio channels.
  * @param _sample_rate_hz The audio sample rate.
@@ -97,6 +257,16 @@ enum audio_sample_rate {
 #define AUDIO_COMMON_GET_PACKET_SIZE(_channel_count, _sample_rate_hz, _sample_size)                                    \
     ((((_channel_count) * (_sample_rate_hz)) / 1000u) * (_sample_size))
 
+/**
+ * @brief Calculate the largest nominal audio packet size, which holds a rounded-up number of frames.
+ *
+ * @param _channel_count The number of audio channels.
+ * @param _sample_rate_hz The audio sample rate.
+ * @param _sample_size The size of an audio sample.
+ */
+#define AUDIO_COMMON_GET_MAX_PACKET_SIZE(_channel_count, _sample_rate_hz, _sample_size)                                \
+    (((_channel_count) * (((_sample_rate_hz) + 999u) / 1000u)) * (_sample_size))
+
 /**
  * @brief Calculate the audio buffer size.
  *
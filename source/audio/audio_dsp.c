@@ -0,0 +1,441 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio DSP module.
+ * @details Contains a stage of cascaded biquad filters per channel, which processes received audio samples in the audio
+ * buffer. A received packet is the processing block. The filters use the transposed direct form II in single precision,
+ * which the Cortex-M4F FPU calculates in hardware. Filters that are set to unity are skipped, so that only configured
+ * filters cost processing time.
+ *
+ * The packet reception interrupt only queues new blocks. A dedicated thread filters them with interrupts enabled, and
+ * then passes them to the later stages of the sample path. The target fill size of the audio buffer leaves more than a
+ * packet period, before the I2S DMA reads a queued block.
+ *
+ * The processing time of every packet is measured with the DWT cycle counter. If it exceeds \a AUDIO_DSP_CYCLE_BUDGET ,
+ * or if the queue is full, the stage outputs silence until the next change of coefficients. Passing unfiltered samples
+ * instead could send full-range audio to the tweeters of a crossover.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_dsp.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "audio_profile.h"
+
+#if AUDIO_DSP_ENABLE
+/**
+ * @brief The number of blocks, which can wait for the DSP thread.
+ * @details A block is processed within the packet period after its reception, unless the thread falls behind.
+ */
+#define AUDIO_DSP_QUEUE_LENGTH 2u
+
+#if AUDIO_DSP_QUEUE_LENGTH < 2u
+#error "The DSP queue must hold a block next to the one that the DSP thread is processing."
+#endif
+
+/**
+ * @brief The event, which signals new blocks to the DSP thread.
+ */
+#define AUDIO_DSP_EVENT_BLOCK EVENT_MASK(0u)
+
+/**
+ * @brief The largest value of a 32 bit sample that a float can represent, without exceeding the sample range.
+ */
+#define AUDIO_DSP_SAMPLE_MAX_32_BIT 2147483520.0f
+
+/**
+ * @brief The state of a biquad filter in transposed direct form II.
+ */
+struct audio_dsp_biquad_state {
+    float z1;  ///< The first delay element.
+    float z2;  ///< The second delay element.
+};
+
+/**
+ * @brief The filter cascade of a channel.
+ */
+struct audio_dsp_channel {
+    struct audio_dsp_biquad_coefficients coefficients[AUDIO_DSP_BIQUAD_COUNT];  ///< The filter coefficients.
+    struct audio_dsp_biquad_state        states[AUDIO_DSP_BIQUAD_COUNT];        ///< The filter states.
+    size_t active_biquad_count;  ///< The number of biquads up to the last one, which is not at unity.
+};
+
+/**
+ * @brief A block of new frames in the circular audio buffer.
+ */
+struct audio_dsp_block {
+    uint8_t                      *p_buffer;     ///< The pointer to the audio buffer.
+    size_t                        offset;       ///< The offset of the block in the audio buffer, in bytes.
+    size_t                        size;         ///< The size of the block in bytes.
+    size_t                        buffer_size;  ///< The size of the audio buffer in bytes, at which the block wraps.
+    struct audio_packet_timestamp timestamp;    ///< The time of reception of the block.
+};
+
+/**
+ * @brief A structure that holds the state of the DSP stage.
+ */
+static struct audio_dsp {
+    struct audio_dsp_channel channels[AUDIO_CHANNEL_COUNT];  ///< The filter cascades of all channels.
+    uint32_t                 staged_channel_mask;            ///< The channels with staged coefficients.
+    struct audio_dsp_block   queue[AUDIO_DSP_QUEUE_LENGTH];  ///< The blocks that wait for the DSP thread.
+    size_t                   queue_read_index;               ///< The index of the oldest queued block.
+    size_t                   queue_count;                    ///< The number of queued blocks.
+    uint32_t                 generation;                     ///< Is incremented, when the queue is flushed.
+    audio_dsp_processed_cb_t processed_cb;                   ///< Passes filtered blocks to the later stages.
+    thread_t                *p_thread;                       ///< The DSP thread.
+    struct audio_dsp_stats   stats;                          ///< The load statistics.
+} g_dsp;
+
+/**
+ * @brief The latest coefficients of all biquads, which the DSP thread applies to the filter cascades.
+ */
+static struct audio_dsp_biquad_coefficients g_dsp_staged_coefficients[AUDIO_CHANNEL_COUNT][AUDIO_DSP_BIQUAD_COUNT];
+
+/**
+ * @brief The working area of the DSP thread.
+ */
+static THD_WORKING_AREA(wa_audio_dsp_thread, 256u);
+
+/**
+ * @brief Check, whether biquad coefficients leave the signal unchanged.
+ *
+ * @param p_coefficients The pointer to the coefficients.
+ * @return true if the biquad is at unity.
+ * @return false if the biquad changes the signal.
+ */
+static bool audio_dsp_is_unity(const struct audio_dsp_biquad_coefficients *p_coefficients) {
+    return (p_coefficients->b0 == 1.0f) && (p_coefficients->b1 == 0.0f) && (p_coefficients->b2 == 0.0f) &&
+           (p_coefficients->a1 == 0.0f) && (p_coefficients->a2 == 0.0f);
+}
+
+/**
+ * @brief Check, whether biquad coefficients describe a usable filter.
+ * @details All coefficients must be finite, and both poles must lie inside the unit circle. For the denominator
+ * 1 + a1 z^-1 + a2 z^-2, this holds if |a2| < 1 and |a1| < 1 + a2.
+ *
+ * @param p_coefficients The pointer to the coefficients.
+ * @return true if the biquad is finite and stable.
+ * @return false if the biquad must not be used.
+ */
+static bool audio_dsp_is_valid(const struct audio_dsp_biquad_coefficients *p_coefficients) {
+    if (!isfinite(p_coefficients->b0) || !isfinite(p_coefficients->b1) || !isfinite(p_coefficients->b2) ||
+        !isfinite(p_coefficients->a1) || !isfinite(p_coefficients->a2)) {
+        return false;
+    }
+
+    return (fabsf(p_coefficients->a2) < 1.0f) && (fabsf(p_coefficients->a1) < (1.0f + p_coefficients->a2));
+}
+
+/**
+ * @brief Set the coefficients of a biquad filter.
+ * @details The coefficients are staged, and applied by the DSP thread before its next block, which resets the states
+ * of the channel's filters. Ends the silence due to an earlier overrun.
+ *
+ * @param channel_index The index of the channel, which the filter processes.
+ * @param biquad_index The position of the filter in the cascade.
+ * @param p_coefficients The pointer to the new coefficients.
+ * @return true if the coefficients were accepted.
+ * @return false if the coefficients are not finite, or the filter is unstable.
+ */
+bool audio_dsp_set_biquad(size_t channel_index, size_t biquad_index,
+                          const struct audio_dsp_biquad_coefficients *p_coefficients) {
+    chDbgCheckClassI();
+    chDbgAssert(channel_index < AUDIO_CHANNEL_COUNT, "Invalid audio channel.");
+    chDbgAssert(biquad_index < AUDIO_DSP_BIQUAD_COUNT, "Invalid biquad index.");
+
+    if (!audio_dsp_is_valid(p_coefficients)) {
+        return false;
+    }
+
+    g_dsp_staged_coefficients[channel_index][biquad_index] = *p_coefficients;
+    g_dsp.staged_channel_mask |= 1u << channel_index;
+    g_dsp.stats.b_is_muted = false;
+
+    return true;
+}
+
+/**
+ * @brief Apply staged coefficients to the filter cascades, and reset the states of the changed channels only.
+ * @note Must be called from a locked context.
+ */
+static void audio_dsp_apply_staged_coefficients(void) {
+    chDbgCheckClassI();
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        if ((g_dsp.staged_channel_mask & (1u << channel_index)) == 0u) {
+            continue;
+        }
+
+        struct audio_dsp_channel *p_channel = &g_dsp.channels[channel_index];
+        memcpy(p_channel->coefficients, g_dsp_staged_coefficients[channel_index], sizeof(p_channel->coefficients));
+        memset(p_channel->states, 0, sizeof(p_channel->states));
+
+        size_t active_biquad_count = AUDIO_DSP_BIQUAD_COUNT;
+
+        while ((active_biquad_count > 0u) && audio_dsp_is_unity(&p_channel->coefficients[active_biquad_count - 1u])) {
+            active_biquad_count--;
+        }
+
+        p_channel->active_biquad_count = active_biquad_count;
+    }
+
+    g_dsp.staged_channel_mask = 0u;
+}
+
+/**
+ * @brief Pass a sample through the filter cascade of a channel.
+ *
+ * @param p_channel The pointer to the filter cascade.
+ * @param sample The input sample.
+ * @return float The output sample.
+ */
+static float audio_dsp_filter(struct audio_dsp_channel *p_channel, float sample) {
+    for (size_t biquad_index = 0; biquad_index < p_channel->active_biquad_count; biquad_index++) {
+        const struct audio_dsp_biquad_coefficients *p_coefficients = &p_channel->coefficients[biquad_index];
+        struct audio_dsp_biquad_state              *p_state        = &p_channel->states[biquad_index];
+
+        float output = p_coefficients->b0 * sample + p_state->z1;
+        p_state->z1  = p_coefficients->b1 * sample - p_coefficients->a1 * output + p_state->z2;
+        p_state->z2  = p_coefficients->b2 * sample - p_coefficients->a2 * output;
+        sample       = output;
+    }
+
+    return sample;
+}
+
+/**
+ * @brief Filter a contiguous block of audio frames.
+ *
+ * @param p_samples The pointer to the samples, in the format that the I2S DMA expects.
+ * @param frame_count The number of frames to process.
+ */
+static void audio_dsp_apply(uint8_t *p_samples, size_t frame_count) {
+    for (size_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            const size_t              SAMPLE_INDEX = frame_index * AUDIO_CHANNEL_COUNT + channel_index;
+            struct audio_dsp_channel *p_channel    = &g_dsp.channels[channel_index];
+
+            if (p_channel->active_biquad_count == 0u) {
+                continue;
+            }
+
+#if AUDIO_RESOLUTION_BIT == 16u
+            int16_t *p_sample = &((int16_t *)p_samples)[SAMPLE_INDEX];
+            float    output   = audio_dsp_filter(p_channel, (float)*p_sample);
+
+            if (isnan(output)) {
+                // Only reachable by overflow within the cascade. Converting NaN to an integer is undefined.
+                output = 0.0f;
+                memset(p_channel->states, 0, sizeof(p_channel->states));
+            } else if (output > (float)INT16_MAX) {
+                output = (float)INT16_MAX;
+            } else if (output < (float)INT16_MIN) {
+                output = (float)INT16_MIN;
+            }
+
+            *p_sample = (int16_t)output;
+#elif AUDIO_RESOLUTION_BIT == 32u
+            uint32_t *p_sample = &((uint32_t *)p_samples)[SAMPLE_INDEX];
+
+            // Samples in the audio buffer have swapped half-words.
+            float output = audio_dsp_filter(p_channel, (float)(int32_t)SWAP_HALF_WORDS(*p_sample));
+
+            if (isnan(output)) {
+                // Only reachable by overflow within the cascade. Converting NaN to an integer is undefined.
+                output = 0.0f;
+                memset(p_channel->states, 0, sizeof(p_channel->states));
+            } else if (output > AUDIO_DSP_SAMPLE_MAX_32_BIT) {
+                output = AUDIO_DSP_SAMPLE_MAX_32_BIT;
+            } else if (output < (float)INT32_MIN) {
+                output = (float)INT32_MIN;
+            }
+
+            *p_sample = SWAP_HALF_WORDS((uint32_t)(int32_t)output);
+#endif
+        }
+    }
+}
+
+/**
+ * @brief Filter a block, or replace it by silence, taking into account wrap-around of the circular buffer.
+ *
+ * @param p_block The pointer to the block.
+ * @param b_is_muted If true, the block is replaced by silence.
+ */
+static void audio_dsp_process_block(const struct audio_dsp_block *p_block, bool b_is_muted) {
+    // The part of the block, which is located before the end of the audio buffer.
+    size_t leading_size = p_block->buffer_size - p_block->offset;
+
+    if (leading_size > p_block->size) {
+        leading_size = p_block->size;
+    }
+
+    if (b_is_muted) {
+        memset(&p_block->p_buffer[p_block->offset], 0, leading_size);
+        memset(p_block->p_buffer, 0, p_block->size - leading_size);
+    } else {
+        audio_dsp_apply(&p_block->p_buffer[p_block->offset], leading_size / AUDIO_FRAME_SIZE);
+        audio_dsp_apply(p_block->p_buffer, (p_block->size - leading_size) / AUDIO_FRAME_SIZE);
+    }
+}
+
+/**
+ * @brief Queue a received packet in the circular audio buffer for the DSP thread.
+ * @details If the queue is full, the thread fell behind. Then, the stage is muted, and the packet is appended to the
+ * newest queued block, which the thread has not started yet. Thereby, the thread replaces all blocks after the one it
+ * is processing by silence, and passes them on in the order of their reception. The stage stays silent until the next
+ * change of coefficients.
+ *
+ * @param p_buffer The pointer to the audio buffer.
+ * @param offset The offset of the packet in the audio buffer, in bytes.
+ * @param size The size of the packet in bytes.
+ * @param buffer_size The size of the audio buffer in bytes, at which the packet wraps around.
+ * @param p_timestamp The pointer to the time of reception of the packet.
+ */
+void audio_dsp_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size,
+                       const struct audio_packet_timestamp *p_timestamp) {
+    chDbgCheckClassI();
+
+    if (g_dsp.queue_count >= AUDIO_DSP_QUEUE_LENGTH) {
+        g_dsp.stats.overrun_count++;
+        g_dsp.stats.b_is_muted = true;
+
+        // The newest block keeps its timestamp, and grows up to the end of the packet. A forced correction of the
+        // write offset in between leaves a gap, which is silenced as well.
+        struct audio_dsp_block *p_newest_block =
+            &g_dsp.queue[(g_dsp.queue_read_index + g_dsp.queue_count - 1u) % AUDIO_DSP_QUEUE_LENGTH];
+
+        size_t merged_size = subtract_circular_unsigned(add_circular_unsigned(offset, size, buffer_size),
+                                                        p_newest_block->offset, buffer_size);
+
+        if ((merged_size == 0u) || (merged_size < p_newest_block->size)) {
+            // The thread stalled for the whole audio buffer.
+            merged_size = buffer_size;
+        }
+
+        p_newest_block->size = merged_size;
+        return;
+    }
+
+    struct audio_dsp_block block = {
+        .p_buffer = p_buffer, .offset = offset, .size = size, .buffer_size = buffer_size, .timestamp = *p_timestamp};
+
+    g_dsp.queue[(g_dsp.queue_read_index + g_dsp.queue_count) % AUDIO_DSP_QUEUE_LENGTH] = block;
+    g_dsp.queue_count++;
+
+    chEvtSignalI(g_dsp.p_thread, AUDIO_DSP_EVENT_BLOCK);
+}
+
+/**
+ * @brief Discard all queued blocks, e.g. when the audio buffer is reset.
+ * @details A block, which the DSP thread is processing, is not passed on anymore.
+ */
+void audio_dsp_flush(void) {
+    chDbgCheckClassI();
+    g_dsp.queue_count = 0u;
+    g_dsp.generation++;
+}
+
+/**
+ * @brief The DSP thread, which filters queued blocks with interrupts enabled.
+ * @details Measures the processing time of every block, and outputs silence after it exceeds
+ * \a AUDIO_DSP_CYCLE_BUDGET .
+ *
+ * @param arg The thread argument (unused).
+ */
+static THD_FUNCTION(audio_dsp_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("audio_dsp");
+
+    while (true) {
+        chEvtWaitAny(AUDIO_DSP_EVENT_BLOCK);
+
+        chSysLock();
+        while (g_dsp.queue_count > 0u) {
+            audio_dsp_apply_staged_coefficients();
+
+            struct audio_dsp_block block      = g_dsp.queue[g_dsp.queue_read_index];
+            bool                   b_is_muted = g_dsp.stats.b_is_muted;
+            uint32_t               generation = g_dsp.generation;
+            chSysUnlock();
+
+            uint32_t start_cycles = DWT->CYCCNT;
+            audio_dsp_process_block(&block, b_is_muted);
+            uint32_t cycles = DWT->CYCCNT - start_cycles;
+
+            chSysLock();
+            if (cycles > g_dsp.stats.max_cycles) {
+                g_dsp.stats.max_cycles = cycles;
+            }
+
+            if (cycles > AUDIO_DSP_CYCLE_BUDGET) {
+                g_dsp.stats.overrun_count++;
+                g_dsp.stats.b_is_muted = true;
+            }
+
+            g_dsp.stats.block_count++;
+
+            if (generation == g_dsp.generation) {
+                g_dsp.queue_read_index = (g_dsp.queue_read_index + 1u) % AUDIO_DSP_QUEUE_LENGTH;
+                g_dsp.queue_count--;
+
+                g_dsp.processed_cb(block.offset, block.size, &block.timestamp);
+            }
+        }
+        chSysUnlock();
+    }
+}
+
+/**
+ * @brief Get the load statistics of the DSP stage.
+ * @note Must be called from thread context.
+ *
+ * @param p_stats The pointer to the structure that receives the statistics.
+ */
+void audio_dsp_get_stats(struct audio_dsp_stats *p_stats) {
+    chSysLock();
+    *p_stats = g_dsp.stats;
+    chSysUnlock();
+}
+
+/**
+ * @brief Initialize the DSP stage with all biquads at unity, and enable the DWT cycle counter.
+ *
+ * @param processed_cb The callback, which passes filtered blocks to the later stages of the sample path.
+ */
+void audio_dsp_init(audio_dsp_processed_cb_t processed_cb) {
+    chDbgCheckClassI();
+    audio_profile_enable_cycle_counter();
+
+    thread_t *p_thread = g_dsp.p_thread;
+    memset(&g_dsp, 0, sizeof(g_dsp));
+    memset(g_dsp_staged_coefficients, 0, sizeof(g_dsp_staged_coefficients));
+    g_dsp.p_thread     = p_thread;
+    g_dsp.processed_cb = processed_cb;
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        for (size_t biquad_index = 0; biquad_index < AUDIO_DSP_BIQUAD_COUNT; biquad_index++) {
+            g_dsp.channels[channel_index].coefficients[biquad_index].b0 = 1.0f;
+            g_dsp_staged_coefficients[channel_index][biquad_index].b0   = 1.0f;
+        }
+    }
+}
+
+/**
+ * @brief Create the DSP thread. Must be called before the DSP stage is initialized.
+ * @details The thread runs above the audio thread, so that blocks are filtered right after their reception.
+ */
+void audio_dsp_setup(void) {
+    g_dsp.p_thread =
+        chThdCreateStatic(wa_audio_dsp_thread, sizeof(wa_audio_dsp_thread), NORMALPRIO + 1, audio_dsp_thread, NULL);
+}
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,63 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio DSP module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_DSP_H_
+#define SOURCE_AUDIO_AUDIO_DSP_H_
+
+#include "audio_common.h"
+
+/**
+ * @brief The coefficients of a biquad filter, normalized to a0 = 1.
+ * @details The filter calculates y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2].
+ */
+struct audio_dsp_biquad_coefficients {
+    float b0;  ///< The feed-forward coefficient of the current input.
+    float b1;  ///< The feed-forward coefficient of the previous input.
+    float b2;  ///< The feed-forward coefficient of the second to last input.
+    float a1;  ///< The feedback coefficient of the previous output.
+    float a2;  ///< The feedback coefficient of the second to last output.
+};
+
+/**
+ * @brief The load statistics of the DSP stage.
+ */
+struct audio_dsp_stats {
+    uint32_t block_count;    ///< The number of processed packets.
+    uint32_t max_cycles;     ///< The longest processing time of a packet in CPU cycles.
+    uint32_t overrun_count;  ///< The number of packets that exceeded \a AUDIO_DSP_CYCLE_BUDGET .
+    bool     b_is_muted;     ///< True, if the DSP stage outputs silence due to an overrun.
+};
+
+/**
+ * @brief The callback, which passes filtered blocks in the audio buffer to the later stages of the sample path.
+ *
+ * @param offset The offset of the block in the audio buffer, in bytes.
+ * @param size The size of the block in bytes.
+ * @param p_timestamp The pointer to the time of reception of the block.
+ */
+typedef void (*audio_dsp_processed_cb_t)(size_t offset, size_t size, const struct audio_packet_timestamp *p_timestamp);
+
+#if AUDIO_DSP_ENABLE
+bool audio_dsp_set_biquad(size_t channel_index, size_t biquad_index,
+                          const struct audio_dsp_biquad_coefficients *p_coefficients);
+void audio_dsp_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size,
+                       const struct audio_packet_timestamp *p_timestamp);
+void audio_dsp_flush(void);
+void audio_dsp_get_stats(struct audio_dsp_stats *p_stats);
+
+void audio_dsp_init(audio_dsp_processed_cb_t processed_cb);
+void audio_dsp_setup(void);
+#endif
+
+#endif  // SOURCE_AUDIO_AUDIO_DSP_H_
+
+/**
+ * @}
+ */
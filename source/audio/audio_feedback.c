@@ -14,6 +14,8 @@
 #include <string.h>
 
 #include "audio_playback.h"
+#include "audio_profile.h"
+#include "audio_stats.h"
 
 /**
  * @brief The minimum supported exponent of the period between feedback packets.
@@ -35,6 +37,11 @@
  */
 #define AUDIO_FEEDBACK_PERIOD_MS (1 << AUDIO_FEEDBACK_PERIOD_EXPONENT)
 
+/**
+ * @brief The shortest measurement window in ms, after which a coarse feedback value is reported (fast-lock).
+ */
+#define AUDIO_FEEDBACK_FAST_LOCK_PERIOD_MS (1 << AUDIO_FEEDBACK_FAST_LOCK_EXPONENT)
+
 /**
  * @brief The size of the packets for the feedback endpoint.
  * @details These are three bytes long, in 10.14 binary format. The format represents a number in kHz, so that a 1 at a
@@ -51,6 +58,10 @@
 #error "Unsupported feedback period exponent - too large."
 #endif
 
+#if AUDIO_FEEDBACK_FAST_LOCK_EXPONENT > AUDIO_FEEDBACK_PERIOD_EXPONENT
+#error "The fast-lock exponent must not exceed the feedback period exponent."
+#endif
+
 /**
  * @brief The general state of audio feedback reporting.
  */
@@ -60,16 +71,58 @@ enum audio_feedback_state {
     AUDIO_FEEDBACK_STATE_ACTIVE        ///< The feedback value is valid, and feedback is provided to the host.
 };
 
+/**
+ * @brief The number of sample rates, for which a clock drift estimate is kept.
+ */
+#define AUDIO_FEEDBACK_DRIFT_RATE_COUNT 4u
+
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+/**
+ * @brief The maximum magnitude of the accumulated fill size error, which limits the integral correction.
+ */
+#define AUDIO_FEEDBACK_CONTROL_MAX_INTEGRAL                                                                           \
+    ((AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION << AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT) / AUDIO_FEEDBACK_CONTROL_KI)
+
+#if AUDIO_FEEDBACK_CONTROL_KI <= 0
+#error "The integral gain of the feedback controller must be positive."
+#endif
+#endif
+
 /**
  * @brief A structure that holds the state of the audio sample rate feedback.
  */
 struct audio_feedback {
-    size_t                    sof_package_count;   ///< Counts the SOF packages since the last feedback value update.
-    uint32_t                  value;               ///< The current feedback value.
-    uint32_t                  last_counter_value;  ///< The counter value at the time of the previous SOF interrupt.
-    enum audio_feedback_state state;               ///< The general state of audio feedback reporting.
+    uint32_t                  counter_values[AUDIO_FEEDBACK_PERIOD_MS];  ///< The counter values at recent SOFs.
+    size_t                    counter_value_index;   ///< The index of the oldest captured counter value in the ring.
+    size_t                    counter_value_count;   ///< The number of captured counter values in the ring.
+    uint32_t                  latest_counter_value;  ///< The counter value at the latest SOF.
+    size_t                    sof_package_count;     ///< Counts the SOF packages since the last controller update.
+    uint32_t                  value;                 ///< The current feedback value.
+    uint32_t                  measured_value;        ///< The current feedback value, without control corrections.
+    enum audio_feedback_state state;                 ///< The general state of audio feedback reporting.
+    bool                      b_is_seeded;           ///< True, if the estimated value is reported before a measurement.
+    size_t                    lock_period_count;     ///< The number of SOF periods until the first measured value.
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+    int32_t fill_size_error_integral;  ///< The accumulated audio buffer fill size error in audio frames.
+    int32_t correction;                ///< The current correction of the feedback value.
+#endif
 } g_feedback;
 
+/**
+ * @brief The clock drift of the I2S master clock against the host's SOF period, which was measured at a sample rate.
+ */
+struct audio_feedback_drift {
+    uint32_t sample_rate_hz;  ///< The sample rate, at which the drift was measured, or zero, if the entry is unused.
+    int32_t  drift_ppm;       ///< The deviation of the measured from the nominal feedback value in ppm.
+};
+
+/**
+ * @brief The latest clock drift estimates per sample rate.
+ * @details Kept across streams, but not across power cycles. The drift of the crystal against a host is very stable,
+ * so that the first feedback packet of a stream already reports the expected rate.
+ */
+static struct audio_feedback_drift g_feedback_drifts[AUDIO_FEEDBACK_DRIFT_RATE_COUNT];
+
 /**
  * @brief Get the current feedback value.
  *
@@ -77,6 +130,110 @@ struct audio_feedback {
  */
 uint32_t audio_feedback_get_value(void) { return g_feedback.value; }
 
+/**
+ * @brief Get the measured I2S sample rate, in the 10.14 feedback format (audio frames per SOF period).
+ * @details Unlike \a audio_feedback_get_value() , this excludes corrections of the feedback controller, so that it
+ * only reflects the relation of the I2S master clock to the SOF period. After \a audio_feedback_start_sof_capture() ,
+ * this is the nominal value plus the known drift, until the measurement becomes active.
+ *
+ * @param p_measured_value The pointer to the measured value to fill in.
+ * @return true if the measured value is valid.
+ * @return false if the feedback measurement is not yet active.
+ */
+bool audio_feedback_get_measured_value(uint32_t *p_measured_value) {
+    chDbgCheckClassI();
+
+    if ((g_feedback.state != AUDIO_FEEDBACK_STATE_ACTIVE) && !g_feedback.b_is_seeded) {
+        return false;
+    }
+
+    *p_measured_value = g_feedback.measured_value;
+    return true;
+}
+
+/**
+ * @brief Get the current count of the feedback timer, which counts I2S master clock cycles.
+ * @details The timer starts counting at the first SOF after \a audio_feedback_start_sof_capture() . Counts are only
+ * comparable between calls within the same capture.
+ *
+ * @param p_timer_count The pointer to the count to fill in.
+ * @return true if the timer counts.
+ * @return false if SOF capture is stopped, or awaits its first SOF.
+ */
+bool audio_feedback_get_timer_count(uint32_t *p_timer_count) {
+    chDbgCheckClassI();
+
+    if (g_feedback.state == AUDIO_FEEDBACK_STATE_IDLE) {
+        return false;
+    }
+
+    *p_timer_count = TIM2->CNT;
+    return true;
+}
+
+/**
+ * @brief Get the count of the feedback timer at the latest SOF.
+ *
+ * @param p_timer_count The pointer to the count to fill in.
+ * @return true if an SOF was captured.
+ * @return false if SOF capture is stopped, or awaits its first SOF.
+ */
+bool audio_feedback_get_sof_timer_count(uint32_t *p_timer_count) {
+    chDbgCheckClassI();
+
+    if (g_feedback.state == AUDIO_FEEDBACK_STATE_IDLE) {
+        return false;
+    }
+
+    *p_timer_count = g_feedback.latest_counter_value;
+    return true;
+}
+
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+/**
+ * @brief Calculate a correction of the feedback value from the audio buffer fill size error.
+ * @details Implements a fixpoint PI controller. If the buffer holds more data than its target fill size, the reported
+ * sample rate is decreased, so that the host sends fewer samples - and vice versa. The integral term cancels long-term
+ * offsets, and is limited for preventing windup.
+ *
+ * @return int32_t The correction to add to the feedback value, in units of the 10.14 feedback format.
+ */
+static int32_t audio_feedback_get_correction(void) {
+    chSysLockFromISR();
+    bool    b_playing = audio_playback_get_state() == AUDIO_PLAYBACK_STATE_PLAYING;
+    int32_t fill_size_error_bytes =
+        (int32_t)audio_playback_get_buffer_fill_size() - (int32_t)audio_playback_get_buffer_target_fill_size();
+    chSysUnlockFromISR();
+
+    if (!b_playing) {
+        // The fill size is only meaningful during playback.
+        return 0;
+    }
+
+    int32_t fill_size_error_frames = fill_size_error_bytes / (int32_t)AUDIO_FRAME_SIZE;
+
+    g_feedback.fill_size_error_integral += fill_size_error_frames;
+
+    if (g_feedback.fill_size_error_integral > AUDIO_FEEDBACK_CONTROL_MAX_INTEGRAL) {
+        g_feedback.fill_size_error_integral = AUDIO_FEEDBACK_CONTROL_MAX_INTEGRAL;
+    } else if (g_feedback.fill_size_error_integral < -AUDIO_FEEDBACK_CONTROL_MAX_INTEGRAL) {
+        g_feedback.fill_size_error_integral = -AUDIO_FEEDBACK_CONTROL_MAX_INTEGRAL;
+    }
+
+    int32_t correction = -(AUDIO_FEEDBACK_CONTROL_KP * fill_size_error_frames +
+                           AUDIO_FEEDBACK_CONTROL_KI * g_feedback.fill_size_error_integral) /
+                         (1 << AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT);
+
+    if (correction > AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION) {
+        correction = AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION;
+    } else if (correction < -AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION) {
+        correction = -AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION;
+    }
+
+    return correction;
+}
+#endif
+
 /**
  * @brief The interrupt handler for timer TIM2.
  * @details Called upon reception of a USB start of frame (SOF) signal. The timer is used for counting the interval
@@ -88,6 +245,7 @@ uint32_t audio_feedback_get_value(void) { return g_feedback.value; }
  */
 OSAL_IRQ_HANDLER(STM32_TIM2_HANDLER) {
     OSAL_IRQ_PROLOGUE();
+    AUDIO_PROFILE_BEGIN(AUDIO_PROFILE_SITE_FEEDBACK_TIMER);
 
     chDbgAssert(I2S_DRIVER.state == I2S_ACTIVE, "SOF period capture not possible with I2S inactive.");
 
@@ -99,32 +257,27 @@ OSAL_IRQ_HANDLER(STM32_TIM2_HANDLER) {
 
     if (!(timer_status_register & TIM_SR_TIF)) {
         // Trigger interrupt flag was not set.
+        AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_FEEDBACK_TIMER);
         OSAL_IRQ_EPILOGUE();
         return;
     }
 
-    if (g_feedback.state == AUDIO_FEEDBACK_STATE_IDLE) {
-        // On the first SOF signal, the feedback cannot be calculated yet. Only record the timer state.
-        g_feedback.last_counter_value = counter_value;
-        g_feedback.state              = AUDIO_FEEDBACK_STATE_INITIALIZED;
-        OSAL_IRQ_EPILOGUE();
-        return;
-    }
+    // The number of SOF periods between the oldest captured counter value and the current one.
+    const size_t SOF_PERIOD_COUNT = g_feedback.counter_value_count;
 
-    // Normal playback operation below.
+    if (SOF_PERIOD_COUNT > 0u) {
+        const uint32_t OLDEST_COUNTER_VALUE = g_feedback.counter_values[g_feedback.counter_value_index];
 
-    g_feedback.sof_package_count++;
-    if (g_feedback.sof_package_count == AUDIO_FEEDBACK_PERIOD_MS) {
-        // The feedback value is measured and reported every \a AUDIO_FEEDBACK_PERIOD_MS .
-        // The timer that counts its cycles during that period is clocked by the I2S master clock, which (on this
-        // hardware) runs at 256 times the audio sample rate. Considering an audio sample rate of 48 kHz, this results
-        // in a timer clock of 12.288 MHz.
+        // The timer is clocked by the I2S master clock, which (on this hardware) runs at 256 times the audio sample
+        // rate. Considering an audio sample rate of 48 kHz, this results in a timer clock of 12.288 MHz.
         //
-        // Therefore, the timer counts a total amount of N clock cycles
-        //   N = fs * 256 * \a AUDIO_FEEDBACK_PERIOD_MS ,
+        // The feedback value is measured over a sliding window of the last \a AUDIO_FEEDBACK_PERIOD_MS SOF periods,
+        // and updated at every SOF. Within a window of P SOF periods (P ms), the timer counts a total amount of N clock
+        // cycles
+        //   N = fs * 256 * P ,
         //
         // and thus the measured sample rate is
-        //   fs = N / 256 / \a AUDIO_FEEDBACK_PERIOD_MS .
+        //   fs = N / 256 / P .
         //
         // The feedback endpoint shall report the device sample rate in units of kHz in a 10.14 binary (fixpoint)
         // format. As an example, a sample rate of 48 kHz would be represented as 48 << 14 = 786432. In practice, the
@@ -133,35 +286,149 @@ OSAL_IRQ_HANDLER(STM32_TIM2_HANDLER) {
         // In mathematical terms, the reported number M must be
         //   M = 2^14 * fs / 1000 .
         //
-        // Calculating m from n (inserting for fs) yields
-        //   M = 2^14 * n / 256 / \a AUDIO_FEEDBACK_PERIOD_MS / 1000 .
+        // Calculating M from N (inserting for fs) yields
+        //   M = 2^14 * N / 256 / P / 1000 .
         //
-        // As a numerical example, consider \a AUDIO_FEEDBACK_PERIOD_MS = 64 ms. In this special case,
+        // As a numerical example, consider P = 64 ms. In this special case,
         //   2^14 / 256 / 64e-3 / 1000 = 1.0 ,
         //
-        // and the timer value can directly be used as the feedback value. If, for example, \a
-        // AUDIO_FEEDBACK_PERIOD_MS was halved to 32 ms, the counter value would have to be doubled, in order
-        // to achieve the same feedback value.
+        // and the timer value can directly be used as the feedback value. If, for example, P was halved to 32 ms, the
+        // counter value would have to be doubled, in order to achieve the same feedback value.
         //
-        // In this function, this is accomplished with a bitshift operation by \a AUDIO_FEEDBACK_SHIFT . The
-        // value of \a AUDIO_FEEDBACK_SHIFT is zero for a feedback period of 64 ms, and increases by one for
-        // every halving of the feedback period. Feedback periods longer than 64 ms are not supported.
+        // In this function, this is accomplished with a bitshift operation. The shift is zero for a window of 64 ms,
+        // and increases by one for every halving of the window. Windows longer than 64 ms are not supported, and the
+        // window must span a power of two SOF periods.
+        //
+        // Before the window is full, a coarse value is reported from the shorter windows of 2^N SOF periods
+        // (fast-lock), starting at 2^AUDIO_FEEDBACK_FAST_LOCK_EXPONENT periods. Once the window is full, the value is
+        // always measured over \a AUDIO_FEEDBACK_PERIOD_MS , and the bitshift equals \a AUDIO_FEEDBACK_SHIFT . If the
+        // value was seeded with a known clock drift, fast-lock is skipped, as its coarse values are less accurate.
         //
         // See the general USB 2.0 specification for more details (5.12.4.2, p. 75) on the format and calculation of the
         // feedback value.
-        g_feedback.value = subtract_circular_unsigned(counter_value, g_feedback.last_counter_value, UINT32_MAX)
-                           << AUDIO_FEEDBACK_SHIFT;
+        const bool B_POWER_OF_TWO = (SOF_PERIOD_COUNT & (SOF_PERIOD_COUNT - 1u)) == 0u;
+
+        if (B_POWER_OF_TWO && (SOF_PERIOD_COUNT >= g_feedback.lock_period_count)) {
+            const uint32_t WINDOW_EXPONENT = 31u - __CLZ(SOF_PERIOD_COUNT);
+
+            g_feedback.measured_value = subtract_circular_unsigned(counter_value, OLDEST_COUNTER_VALUE, UINT32_MAX)
+                                        << (AUDIO_FEEDBACK_MAX_PERIOD_EXPONENT - WINDOW_EXPONENT);
+            g_feedback.value          = g_feedback.measured_value;
+
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+            // Close the loop around the audio buffer fill size. The controller is updated once per feedback period.
+            g_feedback.sof_package_count++;
+            if (g_feedback.sof_package_count >= AUDIO_FEEDBACK_PERIOD_MS) {
+                g_feedback.correction        = audio_feedback_get_correction();
+                g_feedback.sof_package_count = 0u;
+            }
 
-        g_feedback.last_counter_value = counter_value;
-        g_feedback.sof_package_count  = 0u;
-        g_feedback.state              = AUDIO_FEEDBACK_STATE_ACTIVE;
+            g_feedback.value = (uint32_t)((int32_t)g_feedback.value + g_feedback.correction);
+#endif
+
+            g_feedback.state       = AUDIO_FEEDBACK_STATE_ACTIVE;
+            g_feedback.b_is_seeded = false;
+            audio_stats_record_feedback_update();
+        }
+    } else {
+        // On the first SOF signal, the feedback cannot be calculated yet. Only record the timer state.
+        g_feedback.state = AUDIO_FEEDBACK_STATE_INITIALIZED;
     }
 
+    g_feedback.latest_counter_value = counter_value;
+
+    // Store the current counter value in the ring, replacing the oldest one, once the ring is full.
+    if (g_feedback.counter_value_count < AUDIO_FEEDBACK_PERIOD_MS) {
+        g_feedback.counter_values[g_feedback.counter_value_count] = counter_value;
+        g_feedback.counter_value_count++;
+    } else {
+        g_feedback.counter_values[g_feedback.counter_value_index] = counter_value;
+        g_feedback.counter_value_index = (g_feedback.counter_value_index + 1u) & (AUDIO_FEEDBACK_PERIOD_MS - 1u);
+    }
+
+    AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_FEEDBACK_TIMER);
     OSAL_IRQ_EPILOGUE();
 }
 
+/**
+ * @brief Get the nominal feedback value of a sample rate.
+ *
+ * @param sample_rate_hz The sample rate in Hz.
+ * @return uint32_t The nominal feedback value in the 10.14 format (audio frames per SOF period).
+ */
+static uint32_t audio_feedback_get_nominal_value(uint32_t sample_rate_hz) { return (sample_rate_hz << 14u) / 1000u; }
+
+/**
+ * @brief Find the clock drift estimate of a sample rate.
+ *
+ * @param sample_rate_hz The sample rate in Hz.
+ * @return struct audio_feedback_drift* The pointer to the estimate, or to an unused entry, if none is known. NULL, if
+ * no entry is left.
+ */
+static struct audio_feedback_drift *audio_feedback_find_drift(uint32_t sample_rate_hz) {
+    for (size_t drift_index = 0u; drift_index < ARRAY_LENGTH(g_feedback_drifts); drift_index++) {
+        struct audio_feedback_drift *p_drift = &g_feedback_drifts[drift_index];
+
+        if ((p_drift->sample_rate_hz == sample_rate_hz) || (p_drift->sample_rate_hz == 0u)) {
+            return p_drift;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Store the clock drift of the current measurement, if it spans the full feedback period.
+ * @details Shorter fast-lock windows are too coarse for an estimate. Is called, before SOF capture stops, while the
+ * playback sample rate is still the one that was measured.
+ */
+static void audio_feedback_store_drift(void) {
+    chDbgCheckClassI();
+
+    if ((g_feedback.state != AUDIO_FEEDBACK_STATE_ACTIVE) ||
+        (g_feedback.counter_value_count < AUDIO_FEEDBACK_PERIOD_MS)) {
+        return;
+    }
+
+    const uint32_t               SAMPLE_RATE_HZ = audio_playback_get_sample_rate();
+    const int64_t                NOMINAL_VALUE  = (int64_t)audio_feedback_get_nominal_value(SAMPLE_RATE_HZ);
+    struct audio_feedback_drift *p_drift        = audio_feedback_find_drift(SAMPLE_RATE_HZ);
+
+    if (p_drift == NULL) {
+        return;
+    }
+
+    p_drift->sample_rate_hz = SAMPLE_RATE_HZ;
+    p_drift->drift_ppm = (int32_t)((((int64_t)g_feedback.measured_value - NOMINAL_VALUE) * 1000000) / NOMINAL_VALUE);
+}
+
+/**
+ * @brief Report the nominal feedback value plus the known clock drift, until the measurement becomes active.
+ * @details The host receives the expected rate with the first feedback packet, instead of empty packets, until
+ * the measurement replaces it. Without a known drift, the nominal value is reported until fast-lock.
+ */
+static void audio_feedback_seed(void) {
+    chDbgCheckClassI();
+    const uint32_t                     SAMPLE_RATE_HZ = audio_playback_get_sample_rate();
+    const struct audio_feedback_drift *p_drift        = audio_feedback_find_drift(SAMPLE_RATE_HZ);
+
+    int64_t value = (int64_t)audio_feedback_get_nominal_value(SAMPLE_RATE_HZ);
+
+    if ((p_drift != NULL) && (p_drift->sample_rate_hz == SAMPLE_RATE_HZ)) {
+        value += (value * p_drift->drift_ppm) / 1000000;
+
+        // Keep the estimate, until the full window is measured.
+        g_feedback.lock_period_count = AUDIO_FEEDBACK_PERIOD_MS;
+    }
+
+    g_feedback.value          = (uint32_t)value;
+    g_feedback.measured_value = g_feedback.value;
+    g_feedback.b_is_seeded    = true;
+}
+
 /**
  * @brief Set up the timer peripheral for counting USB start of frame (SOF) periods.
+ * @details The feedback value is seeded with the drift estimate of the sample rate, until it is measured.
  * @note Only start after the I2S peripheral is running. Its MCLK output clocks this timer.
  */
 void audio_feedback_start_sof_capture(void) {
@@ -185,12 +452,14 @@ void audio_feedback_start_sof_capture(void) {
     TIM2->OR = TIM_OR_ITR1_RMP_1;
 
     audio_feedback_init();
+    audio_feedback_seed();
 
     chSysUnlock();
 }
 
 /**
  * @brief Stop the timer peripheral for counting USB start of frame (SOF) periods.
+ * @details Keeps the clock drift of the measurement for the next start at the same sample rate.
  */
 void audio_feedback_stop_sof_capture(void) {
     chSysLock();
@@ -198,11 +467,26 @@ void audio_feedback_stop_sof_capture(void) {
     nvicDisableVector(STM32_TIM2_NUMBER);
     TIM2->CR1 = 0;
 
+    audio_feedback_store_drift();
     audio_feedback_init();
 
     chSysUnlock();
 }
 
+/**
+ * @brief Reset the feedback controller, when playback enters or leaves warm idle.
+ * @details The accumulated fill size error of a finished playback does not apply to the audio buffer, which is
+ * aligned anew on resumption. The measurement keeps running.
+ */
+void audio_feedback_reset_control(void) {
+    chDbgCheckClassI();
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+    g_feedback.sof_package_count        = 0u;
+    g_feedback.fill_size_error_integral = 0;
+    g_feedback.correction               = 0;
+#endif
+}
+
 /**
  * @brief Joint callback for when feedback was transmitted, or its transmission failed.
  *
@@ -210,18 +494,21 @@ void audio_feedback_stop_sof_capture(void) {
  * @param endpoint_identifier The endpoint, for which the feedback was called.
  */
 void audio_feedback_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
+    AUDIO_PROFILE_BEGIN(AUDIO_PROFILE_SITE_FEEDBACK_TRANSMIT);
+
     chSysLockFromISR();
     bool b_playback_idle = audio_playback_get_state() == AUDIO_PLAYBACK_STATE_IDLE;
     chSysUnlockFromISR();
 
     if (b_playback_idle) {
         // Feedback values can only be reported, when audio playback is not idle.
+        AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_FEEDBACK_TRANSMIT);
         return;
     }
 
     chSysLockFromISR();
 
-    if (g_feedback.state == AUDIO_FEEDBACK_STATE_ACTIVE) {
+    if ((g_feedback.state == AUDIO_FEEDBACK_STATE_ACTIVE) || g_feedback.b_is_seeded) {
         static uint8_t feedback_buffer[AUDIO_FEEDBACK_BUFFER_SIZE];
         value_to_byte_array(feedback_buffer, g_feedback.value, AUDIO_FEEDBACK_BUFFER_SIZE);
 
@@ -232,6 +519,8 @@ void audio_feedback_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
     }
 
     chSysUnlockFromISR();
+
+    AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_FEEDBACK_TRANSMIT);
 }
 
 /**
@@ -239,10 +528,18 @@ void audio_feedback_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
  */
 void audio_feedback_init(void) {
     chDbgCheckClassI();
-    g_feedback.state              = AUDIO_FEEDBACK_STATE_IDLE;
-    g_feedback.sof_package_count  = 0u;
-    g_feedback.last_counter_value = 0u;
-    g_feedback.value              = 0u;
+    g_feedback.state               = AUDIO_FEEDBACK_STATE_IDLE;
+    g_feedback.counter_value_index = 0u;
+    g_feedback.counter_value_count = 0u;
+    g_feedback.sof_package_count   = 0u;
+    g_feedback.value               = 0u;
+    g_feedback.measured_value      = 0u;
+    g_feedback.b_is_seeded         = false;
+    g_feedback.lock_period_count   = AUDIO_FEEDBACK_FAST_LOCK_PERIOD_MS;
+#if AUDIO_FEEDBACK_CONTROL_ENABLE
+    g_feedback.fill_size_error_integral = 0;
+    g_feedback.correction               = 0;
+#endif
 }
 
 /**
@@ -15,9 +15,13 @@
 #include "audio_playback.h"
 
 uint32_t audio_feedback_get_value(void);
+bool     audio_feedback_get_measured_value(uint32_t *p_measured_value);
+bool     audio_feedback_get_timer_count(uint32_t *p_timer_count);
+bool     audio_feedback_get_sof_timer_count(uint32_t *p_timer_count);
 
 void audio_feedback_start_sof_capture(void);
 void audio_feedback_stop_sof_capture(void);
+void audio_feedback_reset_control(void);
 
 void audio_feedback_cb(USBDriver *p_usb, usbep_t endpoint_identifier);
 
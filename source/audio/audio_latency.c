@@ -0,0 +1,217 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio latency test module.
+ * @details Measures the latency from USB reception to the I2S output. Every \a AUDIO_LATENCY_TEST_INTERVAL_PACKETS
+ * received packets, the first frame of the packet is replaced by a full-scale marker on the left channel, after all
+ * other stages of the sample path. The injection is timestamped with the feedback timer count at the SOF of the
+ * packet's frame, and with the USB frame number.
+ *
+ * The capture path looks for the marker in the captured frames, which requires a loopback from the I2S output to the
+ * I2S input. The feedback timer counts I2S master clock cycles, so that the capture time of the marker frame follows
+ * from the current timer count, and the number of frames that were received since. The resolution is about one frame.
+ *
+ * Results are collected per sample rate and buffer profile, and reset, when either changes. The host should stream
+ * silence, as other audio above \a AUDIO_LATENCY_TEST_THRESHOLD is detected as a marker as well.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_latency.h"
+
+#include "audio_feedback.h"
+#include "audio_playback.h"
+
+#if AUDIO_LATENCY_TEST_ENABLE
+
+/**
+ * @brief The USB frame number is 11 bits long.
+ */
+#define AUDIO_LATENCY_FRAME_NUMBER_MASK 0x7FFu
+
+/**
+ * @brief The number of I2S master clock cycles per audio frame.
+ * @details The master clock output runs at 256 times the sample rate.
+ */
+#define AUDIO_LATENCY_MCLK_PER_FRAME 256u
+
+/**
+ * @brief A structure that holds the state of the latency test.
+ */
+static struct audio_latency {
+    uint32_t                   packet_count;            ///< The number of received packets since the last marker.
+    uint32_t                   injection_timer_count;   ///< The feedback timer count at the SOF of the marker's packet.
+    uint16_t                   injection_frame_number;  ///< The USB frame number of the marker's packet.
+    bool                       b_is_pending;            ///< True, if a marker was injected, but not yet detected.
+    uint32_t                   sample_rate_hz;          ///< The sample rate, at which the results were measured.
+    enum audio_buffer_profile  buffer_profile;          ///< The buffer profile, with which the results were measured.
+    uint64_t                   total_latency_us;        ///< The sum of all measured latencies in us.
+    struct audio_latency_stats stats;                   ///< The latency test results.
+} g_latency;
+
+/**
+ * @brief Reset the latency test results.
+ */
+static void audio_latency_reset_stats(void) {
+    g_latency.stats.measurement_count  = 0u;
+    g_latency.stats.missed_count       = 0u;
+    g_latency.stats.min_latency_us     = UINT32_MAX;
+    g_latency.stats.max_latency_us     = 0u;
+    g_latency.stats.mean_latency_us    = 0u;
+    g_latency.stats.latest_frame_count = 0u;
+    g_latency.total_latency_us         = 0u;
+}
+
+/**
+ * @brief Record a measured latency.
+ *
+ * @param latency_us The latency in us.
+ * @param frame_count The number of SOF periods between injection and detection.
+ */
+static void audio_latency_record(uint32_t latency_us, uint32_t frame_count) {
+    g_latency.stats.measurement_count++;
+    g_latency.stats.latest_frame_count = frame_count;
+    g_latency.total_latency_us += latency_us;
+
+    if (latency_us < g_latency.stats.min_latency_us) {
+        g_latency.stats.min_latency_us = latency_us;
+    }
+
+    if (latency_us > g_latency.stats.max_latency_us) {
+        g_latency.stats.max_latency_us = latency_us;
+    }
+}
+
+/**
+ * @brief Inject a latency marker into newly written frames of the audio buffer, once per interval.
+ * @details Is called after all other stages of the sample path processed the new frames. A marker that was not
+ * detected until the next one is due, is counted as missed.
+ * @note Must be called from a locked context.
+ *
+ * @param p_buffer The pointer to the audio buffer.
+ * @param offset The byte offset of the new frames.
+ * @param size The byte count of the new frames.
+ * @param p_timestamp The pointer to the time of reception of the frames.
+ */
+void audio_latency_inject(uint8_t *p_buffer, size_t offset, size_t size,
+                          const struct audio_packet_timestamp *p_timestamp) {
+    chDbgCheckClassI();
+
+    if (++g_latency.packet_count < AUDIO_LATENCY_TEST_INTERVAL_PACKETS) {
+        return;
+    }
+
+    g_latency.packet_count = 0u;
+
+    if (g_latency.b_is_pending) {
+        g_latency.stats.missed_count++;
+        g_latency.b_is_pending = false;
+    }
+
+    if ((size < AUDIO_FRAME_SIZE) || !p_timestamp->b_is_valid) {
+        return;
+    }
+
+    uint32_t                  sample_rate_hz = audio_playback_get_sample_rate();
+    enum audio_buffer_profile buffer_profile = audio_playback_get_buffer_profile();
+
+    if ((sample_rate_hz != g_latency.sample_rate_hz) || (buffer_profile != g_latency.buffer_profile)) {
+        g_latency.sample_rate_hz = sample_rate_hz;
+        g_latency.buffer_profile = buffer_profile;
+        audio_latency_reset_stats();
+    }
+
+    // The most significant half-word of a sample comes first in the audio buffer.
+    int16_t *p_marker = (int16_t *)&p_buffer[offset];
+    p_marker[0]       = INT16_MAX;
+#if AUDIO_RESOLUTION_BIT == 32u
+    p_marker[1] = -1;
+#endif
+
+    g_latency.injection_timer_count  = p_timestamp->sof_timer_count;
+    g_latency.injection_frame_number = p_timestamp->frame_number;
+    g_latency.b_is_pending           = true;
+}
+
+/**
+ * @brief Look for a pending latency marker in captured frames.
+ * @note Must be called from a locked context.
+ *
+ * @param p_samples The pointer to the captured samples, with \a AUDIO_CAPTURE_CHANNEL_COUNT samples per frame.
+ * @param frame_count The number of captured frames.
+ * @param delay_frame_count The number of frames, which the I2S input received after the last one of these frames.
+ * @param frame_number The current USB frame number.
+ */
+void audio_latency_detect(const int16_t *p_samples, size_t frame_count, size_t delay_frame_count,
+                          uint16_t frame_number) {
+    chDbgCheckClassI();
+    uint32_t timer_count;
+
+    if (!g_latency.b_is_pending || !audio_feedback_get_timer_count(&timer_count)) {
+        return;
+    }
+
+    for (size_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        if (p_samples[frame_index * AUDIO_CAPTURE_CHANNEL_COUNT] < AUDIO_LATENCY_TEST_THRESHOLD) {
+            continue;
+        }
+
+        // The number of frames that were received, since the marker frame was captured.
+        const uint32_t AGE_FRAME_COUNT       = (uint32_t)(delay_frame_count + frame_count - frame_index);
+        const uint32_t DETECTION_TIMER_COUNT = timer_count - AGE_FRAME_COUNT * AUDIO_LATENCY_MCLK_PER_FRAME;
+        const int32_t  LATENCY_TIMER_COUNT   = (int32_t)(DETECTION_TIMER_COUNT - g_latency.injection_timer_count);
+
+        g_latency.b_is_pending = false;
+
+        if (LATENCY_TIMER_COUNT <= 0) {
+            // Captured before the marker's packet was received, so that it cannot be the marker.
+            g_latency.stats.missed_count++;
+            return;
+        }
+
+        const uint32_t LATENCY_US = (uint32_t)(((uint64_t)LATENCY_TIMER_COUNT * 1000000u) /
+                                               (AUDIO_LATENCY_MCLK_PER_FRAME * g_latency.sample_rate_hz));
+
+        const uint32_t FRAME_COUNT =
+            (uint16_t)(frame_number - g_latency.injection_frame_number) & AUDIO_LATENCY_FRAME_NUMBER_MASK;
+
+        audio_latency_record(LATENCY_US, FRAME_COUNT);
+        return;
+    }
+}
+
+/**
+ * @brief Get the latency test results.
+ *
+ * @param p_stats The pointer to the results to fill in.
+ */
+void audio_latency_get_stats(struct audio_latency_stats *p_stats) {
+    chSysLock();
+    *p_stats = g_latency.stats;
+
+    if (p_stats->measurement_count == 0u) {
+        p_stats->min_latency_us = 0u;
+    } else {
+        p_stats->mean_latency_us = (uint32_t)(g_latency.total_latency_us / p_stats->measurement_count);
+    }
+    chSysUnlock();
+}
+
+/**
+ * @brief Initialize the latency test module.
+ */
+void audio_latency_init(void) {
+    chDbgCheckClassI();
+    g_latency.packet_count   = 0u;
+    g_latency.b_is_pending   = false;
+    g_latency.sample_rate_hz = 0u;
+    audio_latency_reset_stats();
+}
+
+#endif
+
+/**
+ * @}
+ */
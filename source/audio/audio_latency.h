@@ -0,0 +1,42 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio latency test module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_LATENCY_H_
+#define SOURCE_AUDIO_AUDIO_LATENCY_H_
+
+#include "audio_common.h"
+
+/**
+ * @brief The results of the latency test, for the current sample rate and buffer profile.
+ */
+struct audio_latency_stats {
+    uint32_t measurement_count;   ///< The number of detected markers.
+    uint32_t missed_count;        ///< The number of markers that were not detected within their interval.
+    uint32_t min_latency_us;      ///< The shortest latency from the SOF of a marker's packet to its detection in us.
+    uint32_t max_latency_us;      ///< The longest latency in us.
+    uint32_t mean_latency_us;     ///< The mean latency in us.
+    uint32_t latest_frame_count;  ///< The number of SOF periods between injection and detection of the latest marker.
+};
+
+#if AUDIO_LATENCY_TEST_ENABLE
+void audio_latency_inject(uint8_t *p_buffer, size_t offset, size_t size,
+                          const struct audio_packet_timestamp *p_timestamp);
+void audio_latency_detect(const int16_t *p_samples, size_t frame_count, size_t delay_frame_count,
+                          uint16_t frame_number);
+void audio_latency_get_stats(struct audio_latency_stats *p_stats);
+
+void audio_latency_init(void);
+#endif
+
+#endif  // SOURCE_AUDIO_AUDIO_LATENCY_H_
+
+/**
+ * @}
+ */
@@ -11,12 +11,60 @@
 
 #include "audio_playback.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+#include "audio_dsp.h"
+#include "audio_feedback.h"
+#include "audio_latency.h"
+#include "audio_profile.h"
+#include "audio_resampler.h"
+#include "audio_stats.h"
+#include "audio_tdm.h"
+#include "audio_volume.h"
+#include "usb.h"
 #include "usb_descriptors.h"
 
+/**
+ * @brief The number of I2S master clock cycles per audio frame.
+ * @details The master clock runs at 256 times the sample rate, and clocks the feedback timer.
+ */
+#define AUDIO_PLAYBACK_MCLK_CYCLES_PER_FRAME 256u
+
+/**
+ * @brief The largest deviation in bytes between the read offset estimate and NDTR, at which the estimate is trusted.
+ * @details Covers the DMA transfer that is pending in the I2S data register, and the latency of the DMA interrupt.
+ */
+#define AUDIO_PLAYBACK_READ_OFFSET_TOLERANCE (4u * AUDIO_FRAME_SIZE)
+
+/**
+ * @brief The mask of the 11 bit USB frame number.
+ */
+#define AUDIO_PLAYBACK_FRAME_NUMBER_MASK 0x7FFu
+
 static void audio_playback_reset(enum audio_playback_state state);
 
+/**
+ * @brief A timestamp of the I2S DMA position, taken at its half and complete transfer interrupts.
+ */
+struct audio_playback_dma_timestamp {
+    size_t   read_offset;   ///< The read offset in bytes, at which the DMA interrupt occurred.
+    uint32_t timer_count;   ///< The count of the feedback timer (I2S master clock cycles) at the DMA interrupt.
+    uint16_t frame_number;  ///< The USB frame number at the DMA interrupt.
+    bool     b_is_valid;    ///< True, if the feedback timer was counting at the DMA interrupt.
+};
+
+/**
+ * @brief Statistics events, which occur within critical sections, and are recorded after them.
+ * @details Are collected from any locked context, including the audio thread, and only recorded by the packet reception
+ * callback, which is the single writer of the USB statistics.
+ */
+struct audio_playback_stats_events {
+    size_t   forced_correction_bytes;  ///< The magnitude of the latest forced correction in bytes, or zero.
+    uint32_t playback_start_count;     ///< The number of times that playback started.
+    uint32_t playback_stop_count;      ///< The number of times that playback stopped.
+};
+
 /**
  * @brief A structure that holds the state of audio playback, as well as the audio buffer.
  */
@@ -26,16 +74,27 @@ struct audio_playback {
     size_t  buffer_size;                                            ///< The nominal size of the audio buffer.
     size_t  buffer_write_offset;                                    ///< The current write offset in bytes (USB).
     size_t  buffer_read_offset;                                     ///< The current read offset in bytes (I2S).
+    size_t  buffer_sof_read_offset;   ///< The read offset at the latest SOF, from which the fill size is calculated.
     size_t  buffer_target_fill_size;  ///< The number of audio sample bytes to collect before starting playback.
     size_t  buffer_fill_size;         ///< The fill size, which is the distance between read (I2S) and write (USB)
                                       ///< memory locations, in bytes.
     enum audio_playback_state state;  ///< The state of audio playback.
+    enum audio_buffer_profile buffer_profile;  ///< The buffer profile to apply at the start of the next stream.
+    uint32_t                  sample_rate_hz;  ///< The audio sample rate in Hz.
+    enum audio_stream_format  stream_format;   ///< The format of the received audio stream.
+    bool b_is_streaming;  ///< True, if the host streams audio via USB. Only differs from the state in warm idle.
+    USBDriver                          *p_usb;          ///< The USB driver, which streams audio.
+    struct audio_playback_dma_timestamp dma_timestamp;  ///< The latest timestamp of the I2S DMA position.
+    struct audio_playback_stats_events  stats_events;   ///< The statistics events, which are not recorded yet.
+#if AUDIO_RESAMPLER_ENABLE
+    uint8_t receive_buffer[AUDIO_MAX_PACKET_SIZE];  ///< The buffer that receives USB packets before resampling.
+#endif
 } g_playback;
 
 /**
- * @brief A pointer to the \a audio module's mailbox.
+ * @brief A pointer to the audio thread, which receives event flags.
  */
-static mailbox_t *gp_mailbox;
+static thread_t *gp_audio_thread;
 
 /**
  * @brief Get the audio data buffer.
@@ -96,52 +155,312 @@ enum audio_playback_state audio_playback_get_state(void) {
 }
 
 /**
- * @brief Set a new audio quality, defined by sample rate and resolution.
+ * @brief Get the number of packets that the audio buffer holds with a buffer profile.
  *
- * @param sample_rate_hz The selected sample rate in Hz.
+ * @param buffer_profile The buffer profile.
+ * @return size_t The number of packets.
  */
-void audio_playback_set_sample_rate(uint32_t sample_rate_hz) {
+static size_t audio_playback_get_buffer_packet_count(enum audio_buffer_profile buffer_profile) {
+    switch (buffer_profile) {
+        case AUDIO_BUFFER_PROFILE_LOW_LATENCY:
+            return AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY;
+
+        case AUDIO_BUFFER_PROFILE_ROBUST:
+            return AUDIO_BUFFER_PACKET_COUNT_ROBUST;
+
+        case AUDIO_BUFFER_PROFILE_DEFAULT:
+        default:
+            return AUDIO_BUFFER_PACKET_COUNT;
+    }
+}
+
+/**
+ * @brief Calculate packet and buffer sizes from the current sample rate and buffer profile.
+ */
+static void audio_playback_update_buffer_size(void) {
     chDbgCheckClassI();
-    g_playback.packet_size = AUDIO_COMMON_GET_PACKET_SIZE(AUDIO_CHANNEL_COUNT, sample_rate_hz, AUDIO_SAMPLE_SIZE);
-    g_playback.buffer_size = AUDIO_COMMON_GET_BUFFER_SIZE(AUDIO_BUFFER_PACKET_COUNT, g_playback.packet_size);
+    g_playback.packet_size =
+        AUDIO_COMMON_GET_PACKET_SIZE(AUDIO_CHANNEL_COUNT, g_playback.sample_rate_hz, AUDIO_SAMPLE_SIZE);
+    g_playback.buffer_size = AUDIO_COMMON_GET_BUFFER_SIZE(
+        audio_playback_get_buffer_packet_count(g_playback.buffer_profile), g_playback.packet_size);
+
+    chDbgAssert(g_playback.buffer_size <= AUDIO_MAX_BUFFER_SIZE, "Buffer profile exceeds audio buffer.");
 
     // By adding half a packet size, the buffer level is equal to half the buffer size on average. Buffer level is
     // measured only after USB packets have arrived and count towards the buffer level.
     g_playback.buffer_target_fill_size = g_playback.buffer_size / 2u + g_playback.packet_size / 2u;
 }
 
+/**
+ * @brief Set a new audio quality, defined by sample rate and resolution.
+ *
+ * @param sample_rate_hz The selected sample rate in Hz.
+ */
+void audio_playback_set_sample_rate(uint32_t sample_rate_hz) {
+    chDbgCheckClassI();
+    g_playback.sample_rate_hz = sample_rate_hz;
+    audio_playback_update_buffer_size();
+}
+
+/**
+ * @brief Get the audio sample rate, with which the audio buffer is sized.
+ *
+ * @return uint32_t The sample rate in Hz.
+ */
+uint32_t audio_playback_get_sample_rate(void) {
+    chDbgCheckClassI();
+    return g_playback.sample_rate_hz;
+}
+
+/**
+ * @brief Select the audio buffer profile.
+ * @details The profile is applied at the start of the next audio stream, as the buffer size must not change during
+ * streaming. The I2S DMA is sized from the buffer, when playback starts.
+ *
+ * @param buffer_profile The buffer profile to select.
+ */
+void audio_playback_set_buffer_profile(enum audio_buffer_profile buffer_profile) {
+    chDbgCheckClassI();
+    chDbgAssert(buffer_profile < AUDIO_BUFFER_PROFILE_COUNT, "Invalid buffer profile.");
+    g_playback.buffer_profile = buffer_profile;
+}
+
+/**
+ * @brief Get the selected audio buffer profile.
+ *
+ * @return enum audio_buffer_profile The buffer profile.
+ */
+enum audio_buffer_profile audio_playback_get_buffer_profile(void) {
+    chDbgCheckClassI();
+    return g_playback.buffer_profile;
+}
+
+/**
+ * @brief Get the location, to which the next USB packet is received.
+ * @details Without resampling, packets are received directly into the audio buffer at the current write offset.
+ * Otherwise, they are received into a separate buffer, from which the resampler reads.
+ *
+ * @return uint8_t* The pointer to the receive location.
+ */
+static uint8_t *audio_playback_get_receive_location(void) {
+#if AUDIO_RESAMPLER_ENABLE
+    return g_playback.receive_buffer;
+#else
+    return &g_playback.buffer[g_playback.buffer_write_offset];
+#endif
+}
+
+/**
+ * @brief Determine, whether the received audio stream holds packed 24 bit samples.
+ *
+ * @return true if samples are packed.
+ * @return false if samples are in the I2S layout.
+ */
+static bool audio_playback_is_stream_packed(void) {
+    return AUDIO_PACKED_24_BIT_ENABLE && (g_playback.stream_format == AUDIO_STREAM_FORMAT_PACKED_24_BIT);
+}
+
+/**
+ * @brief Pass new samples in the audio buffer through the digital volume stage, and route them to their TDM slots, if
+ * enabled. In the latency test mode, a marker is injected last.
+ * @details Is called right after reception, or by the DSP thread, after it filtered the samples.
+ * @note Must be called from a locked context.
+ *
+ * @param offset The byte offset of the new samples in the audio buffer.
+ * @param size The byte count of the new samples.
+ * @param p_timestamp The pointer to the time of reception of the samples.
+ */
+void audio_playback_process_samples(size_t offset, size_t size, const struct audio_packet_timestamp *p_timestamp) {
+    chDbgCheckClassI();
+    (void)offset;
+    (void)size;
+    (void)p_timestamp;
+
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+    audio_volume_process(g_playback.buffer, offset, size, g_playback.buffer_size);
+#endif
+
+#if AUDIO_TDM_ENABLE
+    audio_tdm_process(g_playback.buffer, offset, size, g_playback.buffer_size);
+#endif
+
+#if AUDIO_LATENCY_TEST_ENABLE
+    audio_latency_inject(g_playback.buffer, offset, size, p_timestamp);
+#endif
+}
+
 /**
  * @brief Update the audio buffer write offset, taking into account wrap-around of the circular buffer.
  * @details If the nominal buffer size was exceeded by the last packet, the excess is copied to the beginning of the
  * buffer. The audio buffer is large enough to handle excess data of size \a AUDIO_MAX_PACKET_SIZE.
+ *
+ * Packed 24 bit samples are expanded to the 32 bit layout first, which increases the size of the packet by a third.
+ *
+ * If the resampler is enabled, the received packet is resampled into the audio buffer instead, which wraps around
+ * at the nominal buffer size by itself.
+ *
+ * Finally, the new samples in the audio buffer pass the DSP stage, which queues them for its thread, or the later
+ * stages of \a audio_playback_process_samples directly.
  * @param transaction_size The received audio byte count.
  */
 static void audio_playback_update_write_offset(size_t transaction_size) {
     chDbgCheckClassI();
+
+#if AUDIO_DSP_ENABLE || AUDIO_DIGITAL_VOLUME_ENABLE || AUDIO_TDM_ENABLE || AUDIO_LATENCY_TEST_ENABLE
+    size_t previous_buffer_write_offset = g_playback.buffer_write_offset;
+
+    // Taken right at reception, as the DSP thread may pass the samples to the later stages after the next SOF.
+    struct audio_packet_timestamp timestamp = {.frame_number = (uint16_t)usbGetFrameNumberX(g_playback.p_usb)};
+    timestamp.b_is_valid                    = audio_feedback_get_sof_timer_count(&timestamp.sof_timer_count);
+#endif
+
+#if AUDIO_RESAMPLER_ENABLE
+    if (audio_playback_is_stream_packed()) {
+        // The resampler reads samples in the USB byte order, so that half-words are not swapped here.
+        size_t sample_count = transaction_size / AUDIO_PACKED_SAMPLE_SIZE;
+        unpack_24_bit_samples((uint32_t *)g_playback.receive_buffer, g_playback.receive_buffer, sample_count, false);
+        transaction_size = sample_count * AUDIO_SAMPLE_SIZE;
+    }
+
+    size_t written_byte_count = audio_resampler_process(g_playback.receive_buffer, transaction_size, g_playback.buffer,
+                                                        g_playback.buffer_write_offset, g_playback.buffer_size);
+
+    g_playback.buffer_write_offset =
+        add_circular_unsigned(g_playback.buffer_write_offset, written_byte_count, g_playback.buffer_size);
+
+#if AUDIO_DSP_ENABLE
+    audio_dsp_process(g_playback.buffer, previous_buffer_write_offset, written_byte_count, g_playback.buffer_size,
+                      &timestamp);
+#elif AUDIO_DIGITAL_VOLUME_ENABLE || AUDIO_TDM_ENABLE || AUDIO_LATENCY_TEST_ENABLE
+    audio_playback_process_samples(previous_buffer_write_offset, written_byte_count, &timestamp);
+#endif
+#else
+    if (audio_playback_is_stream_packed()) {
+        // The size of the packet, after expanding it to the I2S layout.
+        transaction_size = (transaction_size / AUDIO_PACKED_SAMPLE_SIZE) * AUDIO_SAMPLE_SIZE;
+    }
+
     size_t new_buffer_write_offset = g_playback.buffer_write_offset + transaction_size;
 
     chDbgAssert(new_buffer_write_offset < ARRAY_LENGTH(g_playback.buffer), "Transaction size exceeds audio buffer.");
 
+    // The number of bytes that exceed the nominal buffer size, and must be moved to the start of the audio buffer.
+    size_t excess_byte_count = 0u;
+
+    if (new_buffer_write_offset > g_playback.buffer_size) {
+        excess_byte_count = new_buffer_write_offset - g_playback.buffer_size;
+    }
+
 #if AUDIO_RESOLUTION_BIT == 32u
-    // Audio samples are now words (32 bit long).
-    // Swap upper and lower 16 bit of received audio samples, as the I2S DMA otherwise transfers them in the wrong
-    // order. The I2S DMA handles word transfers as two separate half-word transfers.
-    uint32_t    *p_word     = (uint32_t *)(&g_playback.buffer[g_playback.buffer_write_offset]);
-    const size_t WORD_COUNT = transaction_size / AUDIO_SAMPLE_SIZE;
-
-    for (size_t word_index = 0; word_index < WORD_COUNT; word_index++) {
-        *p_word = SWAP_HALF_WORDS(*p_word);
-        p_word++;
+    size_t in_place_sample_count = (transaction_size - excess_byte_count) / AUDIO_SAMPLE_SIZE;
+    size_t excess_sample_count   = excess_byte_count / AUDIO_SAMPLE_SIZE;
+
+    if (audio_playback_is_stream_packed()) {
+        // Samples are received at the write offset in their packed form. They are expanded and half-word swapped in a
+        // single pass. The excess samples go first, as their packed form is overwritten when expanding the remaining
+        // samples in place.
+        const uint8_t *p_packed_samples = &g_playback.buffer[g_playback.buffer_write_offset];
+
+        unpack_24_bit_samples((uint32_t *)g_playback.buffer,
+                              &p_packed_samples[in_place_sample_count * AUDIO_PACKED_SAMPLE_SIZE], excess_sample_count,
+                              true);
+        unpack_24_bit_samples((uint32_t *)&g_playback.buffer[g_playback.buffer_write_offset], p_packed_samples,
+                              in_place_sample_count, true);
+    } else {
+        // Audio samples are now words (32 bit long).
+        // Swap upper and lower 16 bit of received audio samples, as the I2S DMA otherwise transfers them in the wrong
+        // order. The I2S DMA handles word transfers as two separate half-word transfers.
+        //
+        // Every received word is touched exactly once: samples within the nominal buffer are swapped in place, excess
+        // samples are swapped while they are moved to the start of the audio buffer.
+        swap_half_words((uint32_t *)&g_playback.buffer[g_playback.buffer_write_offset],
+                        (const uint32_t *)&g_playback.buffer[g_playback.buffer_write_offset], in_place_sample_count);
+        swap_half_words((uint32_t *)g_playback.buffer, (const uint32_t *)&g_playback.buffer[g_playback.buffer_size],
+                        excess_sample_count);
     }
+#else
+    // Copy excessive data back to the start of the audio buffer.
+    memcpy((void *)g_playback.buffer, (void *)&g_playback.buffer[g_playback.buffer_size], excess_byte_count);
 #endif
 
-    // Copy excessive data back to the start of the audio buffer.
-    if (new_buffer_write_offset > g_playback.buffer_size) {
-        size_t excess_byte_count = new_buffer_write_offset - g_playback.buffer_size;
-        memcpy((void *)g_playback.buffer, (void *)&g_playback.buffer[g_playback.buffer_size], excess_byte_count);
+    g_playback.buffer_write_offset = wrap_unsigned(new_buffer_write_offset, g_playback.buffer_size);
+
+#if AUDIO_DSP_ENABLE
+    audio_dsp_process(g_playback.buffer, previous_buffer_write_offset, transaction_size, g_playback.buffer_size,
+                      &timestamp);
+#elif AUDIO_DIGITAL_VOLUME_ENABLE || AUDIO_TDM_ENABLE || AUDIO_LATENCY_TEST_ENABLE
+    audio_playback_process_samples(previous_buffer_write_offset, transaction_size, &timestamp);
+#endif
+#endif
+}
+
+/**
+ * @brief Estimate the I2S DMA's read offset at a feedback timer count, from the latest DMA timestamp.
+ * @details The feedback timer counts I2S master clock cycles, so that the cycles since the timestamp are an exact
+ * measure of the transmitted frames, regardless of clock drift.
+ *
+ * @param timer_count The feedback timer count. May precede the timestamp by less than the audio buffer.
+ * @return size_t The read offset in bytes.
+ */
+static size_t audio_playback_estimate_read_offset(uint32_t timer_count) {
+    const struct audio_playback_dma_timestamp *p_timestamp = &g_playback.dma_timestamp;
+
+    // The number of bytes, which were transmitted since the timestamp.
+    int32_t byte_count = (int32_t)(timer_count - p_timestamp->timer_count) * (int32_t)AUDIO_FRAME_SIZE /
+                         (int32_t)AUDIO_PLAYBACK_MCLK_CYCLES_PER_FRAME;
+
+    return wrap_unsigned((size_t)((int32_t)(p_timestamp->read_offset + g_playback.buffer_size) + byte_count),
+                         g_playback.buffer_size);
+}
+
+/**
+ * @brief Replace the read offset from NDTR by an estimate from the latest DMA timestamp, if it is valid.
+ * @details NDTR is sampled at a random phase within the packet interrupt, and only resolves DMA transfers. The estimate
+ * resolves single bytes, and the read offset at the latest SOF follows from the same timestamp. The fill size refers
+ * to that, so that it does not depend on the packet arrival time within the frame.
+ *
+ * The timestamp is discarded, if it is older than half the audio buffer (missed DMA interrupts), or if the estimate
+ * deviates from NDTR by more than \a AUDIO_PLAYBACK_READ_OFFSET_TOLERANCE (restarted feedback timer).
+ */
+static void audio_playback_refine_read_offset(void) {
+    chDbgCheckClassI();
+    struct audio_playback_dma_timestamp *p_timestamp = &g_playback.dma_timestamp;
+    uint32_t                             timer_count;
+
+    if (!p_timestamp->b_is_valid || !audio_feedback_get_timer_count(&timer_count)) {
+        return;
     }
 
-    g_playback.buffer_write_offset = wrap_unsigned(new_buffer_write_offset, g_playback.buffer_size);
+    const uint16_t FRAME_AGE =
+        (uint16_t)(usbGetFrameNumberX(g_playback.p_usb) - p_timestamp->frame_number) & AUDIO_PLAYBACK_FRAME_NUMBER_MASK;
+
+    if (FRAME_AGE > (g_playback.buffer_size / g_playback.packet_size / 2u + 1u)) {
+        p_timestamp->b_is_valid = false;
+        return;
+    }
+
+    size_t read_offset = audio_playback_estimate_read_offset(timer_count);
+    size_t deviation   = subtract_circular_unsigned(read_offset, g_playback.buffer_read_offset, g_playback.buffer_size);
+
+    if (deviation > (g_playback.buffer_size / 2u)) {
+        deviation = g_playback.buffer_size - deviation;
+    }
+
+    if (deviation > AUDIO_PLAYBACK_READ_OFFSET_TOLERANCE) {
+        p_timestamp->b_is_valid = false;
+        return;
+    }
+
+    g_playback.buffer_read_offset     = read_offset;
+    g_playback.buffer_sof_read_offset = read_offset;
+
+    // The SOF period in I2S master clock cycles.
+    const uint32_t SOF_PERIOD_CYCLES = g_playback.sample_rate_hz * AUDIO_PLAYBACK_MCLK_CYCLES_PER_FRAME / 1000u;
+    uint32_t       sof_timer_count;
+
+    if (audio_feedback_get_sof_timer_count(&sof_timer_count) && ((timer_count - sof_timer_count) < SOF_PERIOD_CYCLES)) {
+        g_playback.buffer_sof_read_offset = audio_playback_estimate_read_offset(sof_timer_count);
+    }
 }
 
 /**
@@ -152,20 +471,24 @@ static void audio_playback_update_read_offset(void) {
     chDbgCheckClassI();
     size_t ndtr_value = (size_t)(I2S_DRIVER.dmatx->stream->NDTR);
 
-    // For 16 bit audio, the number of data register (NDTR) holds the number of remaining audio samples.
-    size_t transferrable_sample_count = ndtr_value;
+    // For 16 bit I2S data words, the number of data register (NDTR) holds the number of remaining words.
+    size_t transferrable_word_count = ndtr_value;
 
-#if AUDIO_RESOLUTION_BIT == 32u
-    // For 32 bit audio, the number of data register still counts 16 bit wide samples.
-    transferrable_sample_count /= 2u;
+#if AUDIO_I2S_WORD_SIZE == 4u
+    // For 32 bit I2S data words, the number of data register still counts 16 bit wide transfers.
+    transferrable_word_count /= 2u;
 #endif
 
     if (I2S_DRIVER.state == I2S_ACTIVE) {
         g_playback.buffer_read_offset =
-            (size_t)g_playback.buffer_size - (size_t)AUDIO_SAMPLE_SIZE * transferrable_sample_count;
+            (size_t)g_playback.buffer_size - (size_t)AUDIO_I2S_WORD_SIZE * transferrable_word_count;
     } else {
         g_playback.buffer_read_offset = 0u;
     }
+
+    g_playback.buffer_sof_read_offset = g_playback.buffer_read_offset;
+
+    audio_playback_refine_read_offset();
 }
 
 /**
@@ -177,12 +500,33 @@ static void audio_playback_update_fill_size(void) {
     chDbgCheckClassI();
     // Calculate the distance between the DMA read offset, and the USB driver's write offset in the playback buffer.
     g_playback.buffer_fill_size = subtract_circular_unsigned(g_playback.buffer_write_offset,
-                                                             g_playback.buffer_read_offset, g_playback.buffer_size);
+                                                             g_playback.buffer_sof_read_offset, g_playback.buffer_size);
+}
+
+/**
+ * @brief Timestamp the I2S DMA position at its half and complete transfer interrupts.
+ * @details Records the feedback timer count and the USB frame number, when the DMA passes the middle of the audio
+ * buffer, or wraps around. The read offset at a later point in time follows from the advance of the timer. The frame
+ * number is read from the USB driver directly, as I2S can run before streaming started, e.g. in warm idle.
+ * @note Is called by the I2S driver from its DMA interrupt.
+ *
+ * @param p_i2s The pointer to the I2S driver structure.
+ */
+void audio_playback_dma_cb(I2SDriver *p_i2s) {
+    chSysLockFromISR();
+
+    struct audio_playback_dma_timestamp *p_timestamp = &g_playback.dma_timestamp;
+
+    p_timestamp->read_offset  = i2sIsBufferComplete(p_i2s) ? 0u : g_playback.buffer_size / 2u;
+    p_timestamp->frame_number = (uint16_t)usbGetFrameNumberX(&USB_DRIVER);
+    p_timestamp->b_is_valid   = audio_feedback_get_timer_count(&p_timestamp->timer_count);
+
+    chSysUnlockFromISR();
 }
 
 /**
  * @brief Start playback, when the target audio buffer fill size is reached.
- * @details I2S transfers are started by sending a \a AUDIO_COMMON_MSG_START_PLAYBACK message.
+ * @details I2S transfers are started by signaling \a AUDIO_COMMON_MSG_START_PLAYBACK .
  * @note This internally uses I-class functions.
  */
 static void audio_playback_start_playing(void) {
@@ -191,21 +535,39 @@ static void audio_playback_start_playing(void) {
     if (g_playback.state == AUDIO_PLAYBACK_STATE_PLAYING) {
         // Playback already enabled.
 
-        // Forcefully adjust buffer write offset, in case the buffer fill size is outside of an acceptable range.
+#if AUDIO_RESAMPLER_ENABLE
+        // Steer the buffer fill size towards its target by resampling. Only adjust the write offset as a last resort,
+        // when a full packet of deviation is reached.
+        int32_t fill_size_error_bytes =
+            (int32_t)g_playback.buffer_fill_size - (int32_t)g_playback.buffer_target_fill_size;
+        audio_resampler_set_correction(fill_size_error_bytes / (int32_t)AUDIO_FRAME_SIZE);
+
+        const size_t MAX_BUFFER_FILL_SIZE_DEVIATION = g_playback.packet_size;
+#else
         // Allow a fraction of a packet of deviation.
-        int16_t      buffer_fill_size_error         = 0;
         const size_t MAX_BUFFER_FILL_SIZE_DEVIATION = g_playback.packet_size / 2;
+#endif
 
-        if (g_playback.buffer_fill_size > (g_playback.buffer_target_fill_size + MAX_BUFFER_FILL_SIZE_DEVIATION)) {
-            buffer_fill_size_error = g_playback.buffer_fill_size - g_playback.buffer_target_fill_size;
-        } else if ((g_playback.buffer_fill_size + MAX_BUFFER_FILL_SIZE_DEVIATION) <
-                   g_playback.buffer_target_fill_size) {
-            buffer_fill_size_error = g_playback.buffer_target_fill_size - g_playback.buffer_fill_size;
+        // Forcefully adjust buffer write offset, in case the buffer fill size is outside of an acceptable range. The
+        // error is negative, if the buffer holds too much data, which moves the write offset back.
+        int32_t buffer_fill_size_error = 0;
+
+        if ((g_playback.buffer_fill_size > (g_playback.buffer_target_fill_size + MAX_BUFFER_FILL_SIZE_DEVIATION)) ||
+            ((g_playback.buffer_fill_size + MAX_BUFFER_FILL_SIZE_DEVIATION) < g_playback.buffer_target_fill_size)) {
+            buffer_fill_size_error = (int32_t)g_playback.buffer_target_fill_size - (int32_t)g_playback.buffer_fill_size;
+        }
+
+        // Correct by whole frames, as the fill size resolves single bytes.
+        buffer_fill_size_error -= buffer_fill_size_error % (int32_t)AUDIO_FRAME_SIZE;
+
+        if (buffer_fill_size_error != 0) {
+            g_playback.stats_events.forced_correction_bytes = (size_t)abs(buffer_fill_size_error);
         }
 
-        // Update the write offset, in order to cancel fill size errors.
-        g_playback.buffer_write_offset =
-            wrap_unsigned(g_playback.buffer_write_offset + buffer_fill_size_error, g_playback.buffer_size);
+        // Update the write offset, in order to cancel fill size errors. The error magnitude is below the buffer size.
+        g_playback.buffer_write_offset = wrap_unsigned(
+            (size_t)((int32_t)(g_playback.buffer_write_offset + g_playback.buffer_size) + buffer_fill_size_error),
+            g_playback.buffer_size);
 
         return;
     }
@@ -216,14 +578,37 @@ static void audio_playback_start_playing(void) {
     if (g_playback.buffer_fill_size >= g_playback.buffer_target_fill_size) {
         // Signal that the playback buffer is at or above the target fill size. This starts audio playback via I2S.
         g_playback.state = AUDIO_PLAYBACK_STATE_PLAYING;
+        g_playback.stats_events.playback_start_count++;
 
-        chMBPostI(gp_mailbox, AUDIO_COMMON_MSG_START_PLAYBACK);
+        chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_START_PLAYBACK));
     }
 }
 
 /**
- * @brief Disables audio playback.
- * @details Sends a \a AUDIO_COMMON_MSG_STOP_PLAYBACK message.
+ * @brief Place the write offset ahead of the I2S DMA in warm idle, such that the next packet meets the target fill
+ * size.
+ * @details The next packet is received at this offset, so that playback resumes without priming the audio buffer.
+ * The offset is aligned to a frame, as the I2S DMA transmits frames from the start of the audio buffer.
+ *
+ * @param lead_size The number of bytes that the I2S DMA is expected to transmit, before the next packet arrives.
+ */
+static void audio_playback_align_write_offset(size_t lead_size) {
+    chDbgCheckClassI();
+    audio_playback_update_read_offset();
+
+    size_t buffer_write_offset =
+        wrap_unsigned(g_playback.buffer_read_offset + g_playback.buffer_target_fill_size + lead_size +
+                          g_playback.buffer_size - g_playback.packet_size,
+                      g_playback.buffer_size);
+
+    g_playback.buffer_write_offset = buffer_write_offset - (buffer_write_offset % AUDIO_FRAME_SIZE);
+}
+
+/**
+ * @brief Disables audio playback, and enters warm idle.
+ * @details The audio buffer is cleared, so that I2S keeps clocking out silence, and the feedback measurement remains
+ * valid. Signals \a AUDIO_COMMON_MSG_START_WARM_IDLE , after which the audio thread ends warm idle, if playback
+ * does not resume in time.
  * @note This internally uses I-class functions.
  */
 static void audio_playback_stop_playing(void) {
@@ -233,9 +618,122 @@ static void audio_playback_stop_playing(void) {
         return;
     }
 
-    audio_playback_reset(AUDIO_PLAYBACK_STATE_STREAMING);
+    memset(g_playback.buffer, 0, g_playback.buffer_size);
 
-    chMBPostI(gp_mailbox, AUDIO_COMMON_MSG_STOP_PLAYBACK);
+    g_playback.state            = AUDIO_PLAYBACK_STATE_WARM_IDLE;
+    g_playback.buffer_fill_size = 0u;
+    audio_feedback_reset_control();
+    g_playback.stats_events.playback_stop_count++;
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_START_WARM_IDLE));
+}
+
+/**
+ * @brief Resume audio playback from warm idle.
+ * @details I2S output and the feedback measurement are still running, so that the received packet is played back
+ * directly.
+ */
+static void audio_playback_resume_playing(void) {
+    chDbgCheckClassI();
+    if (g_playback.state != AUDIO_PLAYBACK_STATE_WARM_IDLE) {
+        return;
+    }
+
+    g_playback.state = AUDIO_PLAYBACK_STATE_PLAYING;
+    audio_feedback_reset_control();
+    g_playback.stats_events.playback_start_count++;
+}
+
+/**
+ * @brief End warm idle, and stop I2S output.
+ * @details Is called by the audio thread, when \a AUDIO_WARM_IDLE_TIMEOUT_MS has passed without playback resuming, or
+ * when I2S output must stop for reconfiguration. If the host still streams audio, the audio buffer is primed again.
+ * Signals \a AUDIO_COMMON_MSG_STOP_PLAYBACK .
+ * @note This internally uses I-class functions.
+ */
+void audio_playback_end_warm_idle(void) {
+    chDbgCheckClassI();
+    if (g_playback.state != AUDIO_PLAYBACK_STATE_WARM_IDLE) {
+        // Playback resumed, or warm idle already ended.
+        return;
+    }
+
+    audio_playback_reset(g_playback.b_is_streaming ? AUDIO_PLAYBACK_STATE_STREAMING : AUDIO_PLAYBACK_STATE_IDLE);
+    audio_feedback_reset_control();
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_STOP_PLAYBACK));
+}
+
+/**
+ * @brief Enter warm idle from idle, so that I2S clocks out silence without playback.
+ * @details Is called by the audio thread, while the capture path needs the I2S clocks. Does nothing, if playback is
+ * not idle.
+ * @note This internally uses I-class functions.
+ */
+void audio_playback_start_warm_idle(void) {
+    chDbgCheckClassI();
+    if (g_playback.state != AUDIO_PLAYBACK_STATE_IDLE) {
+        return;
+    }
+
+    memset(g_playback.buffer, 0, g_playback.buffer_size);
+
+    g_playback.state            = AUDIO_PLAYBACK_STATE_WARM_IDLE;
+    g_playback.buffer_fill_size = 0u;
+    audio_feedback_reset_control();
+}
+
+/**
+ * @brief Apply a new sample rate, while the I2S output keeps running.
+ * @details Is called by the audio thread, while the I2S DMA is paused for reprogramming the I2S clocks. Playback
+ * continues in warm idle, with the audio buffer zeroed and sized for the new rate. The DMA restarts at the start of
+ * the buffer, so that the write offset is placed relative to that, if the host still streams audio.
+ * @note This internally uses I-class functions.
+ *
+ * @param sample_rate_hz The selected sample rate in Hz.
+ */
+void audio_playback_switch_sample_rate(uint32_t sample_rate_hz) {
+    chDbgCheckClassI();
+    chDbgAssert((g_playback.state == AUDIO_PLAYBACK_STATE_PLAYING) ||
+                    (g_playback.state == AUDIO_PLAYBACK_STATE_WARM_IDLE),
+                "The output must be active for switching the sample rate.");
+
+    audio_playback_stop_playing();
+
+    g_playback.sample_rate_hz = sample_rate_hz;
+    audio_playback_update_buffer_size();
+
+    memset(g_playback.buffer, 0, g_playback.buffer_size);
+
+    // Timestamps of the previous DMA transfer are meaningless at the new rate.
+    g_playback.dma_timestamp.b_is_valid = false;
+    g_playback.buffer_fill_size         = 0u;
+    audio_resampler_init();
+
+    if (g_playback.b_is_streaming) {
+        // The next packet arrives within the next frame, at the new packet size.
+        audio_playback_align_write_offset(g_playback.packet_size / 2u);
+    }
+}
+
+/**
+ * @brief Record the statistics events, which were collected within critical sections.
+ * @note Must only be called from the USB interrupt context, outside of critical sections.
+ *
+ * @param p_stats_events The pointer to the events.
+ */
+static void audio_playback_record_stats_events(const struct audio_playback_stats_events *p_stats_events) {
+    if (p_stats_events->forced_correction_bytes != 0u) {
+        audio_stats_record_forced_correction(p_stats_events->forced_correction_bytes);
+    }
+
+    for (uint32_t event_index = 0u; event_index < p_stats_events->playback_stop_count; event_index++) {
+        audio_stats_record_playback_stop();
+    }
+
+    for (uint32_t event_index = 0u; event_index < p_stats_events->playback_start_count; event_index++) {
+        audio_stats_record_playback_start();
+    }
 }
 
 /**
@@ -246,8 +744,11 @@ static void audio_playback_stop_playing(void) {
  * @param endpoint_identifier The endpoint, for which the feedback was called.
  */
 void audio_playback_received_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
+    AUDIO_PROFILE_BEGIN(AUDIO_PROFILE_SITE_PLAYBACK_RECEIVED);
+
     if (g_playback.state == AUDIO_PLAYBACK_STATE_IDLE) {
         // Disregard packets, when idle.
+        AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_PLAYBACK_RECEIVED);
         return;
     }
 
@@ -256,47 +757,90 @@ void audio_playback_received_cb(USBDriver *p_usb, usbep_t endpoint_identifier) {
     chSysLockFromISR();
 
     if (transaction_size == 0u) {
-        // Failed transaction.
+        // Failed transaction. Playback pauses in warm idle, until the next packet arrives.
         audio_playback_stop_playing();
+
+        if (g_playback.state == AUDIO_PLAYBACK_STATE_WARM_IDLE) {
+            // The next packet is due in the next frame.
+            audio_playback_align_write_offset(g_playback.packet_size);
+        }
     } else {
         // Samples were received successfully.
+        audio_playback_resume_playing();
         audio_playback_update_write_offset(transaction_size);
         audio_playback_update_read_offset();
         audio_playback_update_fill_size();
         audio_playback_start_playing();
     }
 
-    usbStartReceiveI(p_usb, endpoint_identifier, (uint8_t *)&g_playback.buffer[g_playback.buffer_write_offset],
-                     AUDIO_MAX_PACKET_SIZE);
+    usbStartReceiveI(p_usb, endpoint_identifier, audio_playback_get_receive_location(), AUDIO_MAX_PACKET_SIZE);
+
+    struct audio_playback_stats_events stats_events = g_playback.stats_events;
+    memset(&g_playback.stats_events, 0, sizeof(g_playback.stats_events));
 
     chSysUnlockFromISR();
+
+    // Statistics are wait-free, and recorded outside of the critical section. The fill size is only ever written from
+    // this interrupt context.
+    if (transaction_size == 0u) {
+        audio_stats_record_failed_transaction();
+    } else {
+        audio_stats_record_received_packet();
+        audio_stats_record_fill_size(g_playback.buffer_fill_size, g_playback.buffer_size);
+    }
+
+    audio_playback_record_stats_events(&stats_events);
+
+    AUDIO_PROFILE_END(AUDIO_PROFILE_SITE_PLAYBACK_RECEIVED);
 }
 
 /**
  * @brief Start streaming audio via USB.
- * @details Is called, when the audio endpoint goes into its operational alternate mode (actual music playback begins).
+ * @details Is called, when the audio endpoint goes into one of its operational alternate modes (actual music playback
+ * begins).
+ *
+ * In warm idle, playback resumes with the first received packet, unless a new buffer profile changes the buffer size.
+ * In that case, I2S output is restarted after priming the audio buffer.
  *
  * @param p_usb The pointer to the USB driver structure.
+ * @param stream_format The format of the audio stream, which depends on the alternate mode.
  */
-void audio_playback_start_streaming(USBDriver *p_usb) {
+void audio_playback_start_streaming(USBDriver *p_usb, enum audio_stream_format stream_format) {
     chSysLockFromISR();
 
-    chDbgAssert(g_playback.state == AUDIO_PLAYBACK_STATE_IDLE, "Playback must be idle before starting to stream.");
-    audio_playback_reset(AUDIO_PLAYBACK_STATE_STREAMING);
+    chDbgAssert(!g_playback.b_is_streaming, "Playback must be idle before starting to stream.");
+    chDbgAssert(AUDIO_PACKED_24_BIT_ENABLE || (stream_format == AUDIO_STREAM_FORMAT_NATIVE),
+                "Unsupported stream format.");
+
+    g_playback.stream_format  = stream_format;
+    g_playback.b_is_streaming = true;
+    g_playback.p_usb          = p_usb;
+
+    // Apply the selected buffer profile.
+    const size_t PREVIOUS_BUFFER_SIZE = g_playback.buffer_size;
+    audio_playback_update_buffer_size();
+
+    if ((g_playback.state == AUDIO_PLAYBACK_STATE_WARM_IDLE) && (g_playback.buffer_size == PREVIOUS_BUFFER_SIZE)) {
+        // The I2S DMA still transmits the audio buffer. The first packet arrives within the next frame.
+        audio_playback_align_write_offset(g_playback.packet_size / 2u);
+    } else {
+        audio_playback_end_warm_idle();
+        audio_playback_reset(AUDIO_PLAYBACK_STATE_STREAMING);
+    }
 
     // Feedback yet unknown, transmit empty packet.
     usbStartTransmitI(p_usb, USB_DESC_ENDPOINT_FEEDBACK, NULL, 0);
 
     // Initial audio data reception.
-    usbStartReceiveI(p_usb, USB_DESC_ENDPOINT_PLAYBACK, (uint8_t *)&g_playback.buffer[g_playback.buffer_write_offset],
-                     AUDIO_MAX_PACKET_SIZE);
+    usbStartReceiveI(p_usb, USB_DESC_ENDPOINT_PLAYBACK, audio_playback_get_receive_location(), AUDIO_MAX_PACKET_SIZE);
 
     chSysUnlockFromISR();
 }
 
 /**
- * @brief Disable audio streaming and output.
+ * @brief Disable audio streaming.
  * @details Is called when the audio endpoint goes into its zero bandwidth alternate mode, or by \a audio_reset() .
+ * During playback, audio output enters warm idle, which the audio thread ends after \a AUDIO_WARM_IDLE_TIMEOUT_MS .
  *
  * @param p_usb The pointer to the USB driver structure.
  */
@@ -310,8 +854,12 @@ void audio_playback_stop_streaming(USBDriver *p_usb) {
 
     chSysLockFromISR();
 
+    g_playback.b_is_streaming = false;
     audio_playback_stop_playing();
-    audio_playback_reset(AUDIO_PLAYBACK_STATE_IDLE);
+
+    if (g_playback.state != AUDIO_PLAYBACK_STATE_WARM_IDLE) {
+        audio_playback_reset(AUDIO_PLAYBACK_STATE_IDLE);
+    }
 
     chSysUnlockFromISR();
 }
@@ -319,16 +867,21 @@ void audio_playback_stop_streaming(USBDriver *p_usb) {
 /**
  * @brief Initialize the audio playback module.
  *
- * @param p_mailbox A pointer to the mailbox to register.
+ * @param p_audio_thread A pointer to the audio thread, which receives event flags.
  */
-void audio_playback_init(mailbox_t *p_mailbox) {
+void audio_playback_init(thread_t *p_audio_thread) {
     chDbgCheckClassI();
-    gp_mailbox = p_mailbox;
+    gp_audio_thread = p_audio_thread;
 
-    g_playback.buffer_write_offset = 0u;
-    g_playback.buffer_read_offset  = 0u;
-    g_playback.buffer_fill_size    = 0u;
-    g_playback.state               = AUDIO_PLAYBACK_STATE_IDLE;
+    g_playback.buffer_write_offset    = 0u;
+    g_playback.buffer_read_offset     = 0u;
+    g_playback.buffer_sof_read_offset = 0u;
+    g_playback.buffer_fill_size       = 0u;
+    g_playback.state                  = AUDIO_PLAYBACK_STATE_IDLE;
+
+    g_playback.dma_timestamp.b_is_valid = false;
+
+    audio_resampler_init();
 }
 
 /**
@@ -337,7 +890,11 @@ void audio_playback_init(mailbox_t *p_mailbox) {
  * @param state The new state to assign to the playback structure.
  */
 static void audio_playback_reset(enum audio_playback_state state) {
-    audio_playback_init(gp_mailbox);
+#if AUDIO_DSP_ENABLE
+    // Queued blocks refer to the previous layout of the audio buffer.
+    audio_dsp_flush();
+#endif
+    audio_playback_init(gp_audio_thread);
     g_playback.state = state;
 }
 
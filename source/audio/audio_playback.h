@@ -19,7 +19,9 @@
 enum audio_playback_state {
     AUDIO_PLAYBACK_STATE_IDLE,       ///< The playback module is idle.
     AUDIO_PLAYBACK_STATE_STREAMING,  ///< The playback module is streaming audio via USB.
-    AUDIO_PLAYBACK_STATE_PLAYING     ///< Audio is being played back via I2S. Implies active USB streaming.
+    AUDIO_PLAYBACK_STATE_PLAYING,    ///< Audio is being played back via I2S. Implies active USB streaming.
+    AUDIO_PLAYBACK_STATE_WARM_IDLE   ///< I2S clocks out silence, until playback resumes or the warm idle timeout
+                                     ///< passes. USB streaming may be active.
 };
 
 uint8_t *audio_playback_get_buffer(void);
@@ -28,13 +30,22 @@ size_t   audio_playback_get_buffer_fill_size(void);
 size_t   audio_playback_get_buffer_target_fill_size(void);
 size_t   audio_playback_get_packet_size(void);
 
-void                      audio_playback_start_streaming(USBDriver *p_usb);
+void                      audio_playback_start_streaming(USBDriver *p_usb, enum audio_stream_format stream_format);
 void                      audio_playback_stop_streaming(USBDriver *p_usb);
 enum audio_playback_state audio_playback_get_state(void);
 
 void audio_playback_received_cb(USBDriver *p_usb, usbep_t endpoint_identifier);
-
-void audio_playback_set_sample_rate(uint32_t sample_rate_hz);
-void audio_playback_init(mailbox_t *p_mailbox);
+void audio_playback_process_samples(size_t offset, size_t size, const struct audio_packet_timestamp *p_timestamp);
+void audio_playback_dma_cb(I2SDriver *p_i2s);
+void audio_playback_start_warm_idle(void);
+void audio_playback_end_warm_idle(void);
+void audio_playback_switch_sample_rate(uint32_t sample_rate_hz);
+
+void                      audio_playback_set_sample_rate(uint32_t sample_rate_hz);
+uint32_t                  audio_playback_get_sample_rate(void);
+void                      audio_playback_set_buffer_profile(enum audio_buffer_profile buffer_profile);
+enum audio_buffer_profile audio_playback_get_buffer_profile(void);
+
+void audio_playback_init(thread_t *p_audio_thread);
 
 #endif  // SOURCE_AUDIO_AUDIO_PLAYBACK_H_
@@ -0,0 +1,100 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio profiling module.
+ * @details Measures the execution time of audio interrupt handlers and critical sections with the DWT cycle counter,
+ * when built with \a AUDIO_PROFILE enabled (e.g. via `make AUDIO_PROFILE=1`). Records minimum, maximum and mean
+ * execution times, as well as a log2 histogram, per profiled site. Without \a AUDIO_PROFILE , the profiling markers
+ * compile to nothing.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_profile.h"
+
+#include <string.h>
+
+/**
+ * @brief Enable the DWT cycle counter, which the profiling and DSP modules measure execution times with.
+ */
+void audio_profile_enable_cycle_counter(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#if AUDIO_PROFILE
+/**
+ * @brief The execution time statistics of all profiled sites.
+ * @details Every site is only ever entered from a single context, which does not nest with itself.
+ */
+static struct audio_profile_site_stats g_profile[AUDIO_PROFILE_SITE_COUNT];
+
+/**
+ * @brief Mark the entry of a profiled code site.
+ *
+ * @param site The profiled site.
+ */
+void audio_profile_begin(enum audio_profile_site site) { g_profile[site].start_cycles = DWT->CYCCNT; }
+
+/**
+ * @brief Mark the exit of a profiled code site, and record its execution time.
+ *
+ * @param site The profiled site.
+ */
+void audio_profile_end(enum audio_profile_site site) {
+    struct audio_profile_site_stats *p_stats = &g_profile[site];
+    uint32_t                         cycles  = DWT->CYCCNT - p_stats->start_cycles;
+
+    if (cycles < p_stats->min_cycles) {
+        p_stats->min_cycles = cycles;
+    }
+
+    if (cycles > p_stats->max_cycles) {
+        p_stats->max_cycles = cycles;
+    }
+
+    p_stats->total_cycles += cycles;
+    p_stats->count++;
+
+    // The histogram bin is the position of the leading one bit.
+    size_t bin_index = (cycles == 0u) ? 0u : (31u - __CLZ(cycles));
+    p_stats->histogram[bin_index]++;
+}
+
+/**
+ * @brief Get the execution time statistics of a profiled site.
+ * @note Must be called from thread context.
+ *
+ * @param p_stats The pointer to the structure that receives the statistics.
+ * @param site The profiled site.
+ */
+void audio_profile_get(struct audio_profile_site_stats *p_stats, enum audio_profile_site site) {
+    chDbgAssert(site < AUDIO_PROFILE_SITE_COUNT, "Invalid profiling site.");
+
+    chSysLock();
+    memcpy(p_stats, &g_profile[site], sizeof(*p_stats));
+    chSysUnlock();
+}
+
+/**
+ * @brief Initialize profiling, and enable the DWT cycle counter.
+ */
+void audio_profile_init(void) {
+    chDbgCheckClassI();
+
+    DWT->CYCCNT = 0u;
+    audio_profile_enable_cycle_counter();
+
+    memset(g_profile, 0, sizeof(g_profile));
+
+    for (size_t site_index = 0; site_index < ARRAY_LENGTH(g_profile); site_index++) {
+        g_profile[site_index].min_cycles = UINT32_MAX;
+    }
+}
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,76 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio profiling module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_PROFILE_H_
+#define SOURCE_AUDIO_AUDIO_PROFILE_H_
+
+#include "audio_common.h"
+
+/**
+ * @brief The number of bins in the log2 histogram of execution times.
+ * @details Bin N counts execution times of 2^N up to (2^(N+1) - 1) cycles. Bin zero also holds zero cycle durations.
+ */
+#define AUDIO_PROFILE_HISTOGRAM_BIN_COUNT 32u
+
+/**
+ * @brief The code sites that are profiled.
+ */
+enum audio_profile_site {
+    AUDIO_PROFILE_SITE_PLAYBACK_RECEIVED,      ///< The audio packet reception callback.
+    AUDIO_PROFILE_SITE_FEEDBACK_TIMER,         ///< The feedback timer (TIM2) interrupt handler.
+    AUDIO_PROFILE_SITE_FEEDBACK_TRANSMIT,      ///< The feedback packet transmission callback.
+    AUDIO_PROFILE_SITE_THREAD_SAMPLE_RATE,     ///< The sample rate update critical section in the audio thread.
+    AUDIO_PROFILE_SITE_THREAD_PLAYBACK_STATE,  ///< The playback state critical section in the audio thread.
+    AUDIO_PROFILE_SITE_COUNT                   ///< The number of profiled sites.
+};
+
+/**
+ * @brief The execution time statistics of a profiled code site, in CPU cycles.
+ */
+struct audio_profile_site_stats {
+    uint32_t start_cycles;                                  ///< The cycle counter value at the last entry of the site.
+    uint32_t count;                                         ///< The number of measurements.
+    uint32_t min_cycles;                                    ///< The shortest execution time.
+    uint32_t max_cycles;                                    ///< The longest execution time.
+    uint64_t total_cycles;                                  ///< The sum of all execution times.
+    uint32_t histogram[AUDIO_PROFILE_HISTOGRAM_BIN_COUNT];  ///< The log2 histogram of execution times.
+};
+
+void audio_profile_enable_cycle_counter(void);
+
+#if AUDIO_PROFILE
+/**
+ * @brief Mark the entry of a profiled code site.
+ *
+ * @param _site The profiled site, a value of \a audio_profile_site .
+ */
+#define AUDIO_PROFILE_BEGIN(_site) audio_profile_begin(_site)
+
+/**
+ * @brief Mark the exit of a profiled code site, and record its execution time.
+ *
+ * @param _site The profiled site, a value of \a audio_profile_site .
+ */
+#define AUDIO_PROFILE_END(_site) audio_profile_end(_site)
+
+void audio_profile_begin(enum audio_profile_site site);
+void audio_profile_end(enum audio_profile_site site);
+void audio_profile_get(struct audio_profile_site_stats *p_stats, enum audio_profile_site site);
+void audio_profile_init(void);
+#else
+#define AUDIO_PROFILE_BEGIN(_site) (void)(_site)
+#define AUDIO_PROFILE_END(_site)   (void)(_site)
+#endif
+
+#endif  // SOURCE_AUDIO_AUDIO_PROFILE_H_
+
+/**
+ * @}
+ */
@@ -3,7 +3,9 @@
 /**
  * @file
  * @brief   Audio request module.
- * @details Contains functionality for handling UAC v1 audio requests.
+ * @details Contains functionality for handling UAC v1 audio requests, or UAC v2 audio requests, if
+ * \a AUDIO_UAC2_ENABLE is set. In UAC v2, the sample rate is a control of the clock source entity, instead of the
+ * streaming endpoints.
  *
  * @addtogroup audio
  * @{
@@ -13,12 +15,46 @@
 
 #include <string.h>
 
+#include "audio_capture.h"
+#include "audio_dsp.h"
 #include "audio_playback.h"
+#include "audio_volume.h"
 #include "common.h"
 #include "usb_descriptors.h"
 
 // Control selectors
 #define AUDIO_REQUEST_CS_SAMPLING_FREQ 0x01u
+#define AUDIO_REQUEST_CS_CLOCK_VALID   0x02u  // UAC v2 clock source only.
+
+#if AUDIO_UAC2_ENABLE
+/**
+ * @brief Supported control requests from the USB Audio Class v2.
+ * @details The direction of the request distinguishes between getting and setting an attribute.
+ */
+enum audio_request_uac2 {
+    AUDIO_REQUEST_CUR   = 0x01u,
+    AUDIO_REQUEST_RANGE = 0x02u,
+};
+
+/**
+ * @brief The sample rates of the clock source entity, which are reported as discrete ranges.
+ */
+static const uint32_t g_sample_rates_hz[USB_DESCRIPTORS_SAMPLE_RATE_COUNT] = {
+    AUDIO_SAMPLE_RATE_44_1_KHZ,
+    AUDIO_SAMPLE_RATE_48_KHZ,
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+    AUDIO_SAMPLE_RATE_88_2_KHZ,
+    AUDIO_SAMPLE_RATE_96_KHZ,
+#endif
+};
+
+/**
+ * @brief The size of a sample rate range response: the number of sub-ranges, and the minimum, maximum, and resolution
+ * of every sub-range.
+ */
+#define AUDIO_REQUEST_SAMPLE_RATE_RANGE_SIZE                                                                           \
+    (sizeof(uint16_t) + 3u * sizeof(uint32_t) * USB_DESCRIPTORS_SAMPLE_RATE_COUNT)
+#endif
 
 /**
  * @brief Supported control requests from the USB Audio Class.
@@ -34,16 +70,58 @@ enum audio_request {
     AUDIO_REQUEST_GET_RES = 0x84u,
 };
 
+/**
+ * @brief Supported vendor-specific device requests.
+ */
+enum audio_request_vendor {
+    AUDIO_REQUEST_VENDOR_SET_BUFFER_PROFILE = 0x01u,  ///< Select the buffer profile in wValue, without data stage.
+    AUDIO_REQUEST_VENDOR_SET_DSP_BIQUAD     = 0x02u,  ///< Set the coefficients of a DSP biquad (see below).
+    AUDIO_REQUEST_VENDOR_GET_BUFFER_PROFILE = 0x81u,  ///< Get the selected buffer profile as a single byte.
+};
+
+/**
+ * @brief Get the channel index from the wValue field of an \a AUDIO_REQUEST_VENDOR_SET_DSP_BIQUAD request.
+ * @details The data stage holds the coefficients b0, b1, b2, a1, and a2 as little-endian 32 bit floats.
+ *
+ * @param _value The wValue field.
+ */
+#define AUDIO_REQUEST_GET_DSP_CHANNEL_INDEX(_value) ((size_t)((_value) >> 8u))
+
+/**
+ * @brief Get the biquad index from the wValue field of an \a AUDIO_REQUEST_VENDOR_SET_DSP_BIQUAD request.
+ *
+ * @param _value The wValue field.
+ */
+#define AUDIO_REQUEST_GET_DSP_BIQUAD_INDEX(_value) ((size_t)((_value) & 0xFFu))
+
+/**
+ * @brief The data stages of all handled requests, which size the request data buffer.
+ */
+union audio_request_data {
+    int16_t  volume_levels_8q8_db[1u + AUDIO_CHANNEL_COUNT];  ///< The volume levels of the master and all channels.
+    uint8_t  mute_states[1u + AUDIO_CHANNEL_COUNT];            ///< The mute states of the master and all channels.
+#if AUDIO_UAC2_ENABLE
+    uint32_t sample_rate_hz;                                          ///< The sample rate (four bytes long).
+    int16_t  volume_range_8q8_db[4u];                                 ///< The number of sub-ranges, min, max, and res.
+    uint8_t  sample_rate_range[AUDIO_REQUEST_SAMPLE_RATE_RANGE_SIZE];  ///< The sub-ranges of all sample rates.
+#else
+    uint32_t sample_rate_hz;                                   ///< The sample rate (three bytes long).
+#endif
+#if AUDIO_DSP_ENABLE
+    struct audio_dsp_biquad_coefficients dsp_biquad_coefficients;  ///< The coefficients of a biquad.
+#endif
+};
+
 /**
  * @brief A structure that holds the content of an audio request message.
  */
 static volatile struct audio_request_message {
-    uint8_t  request_type;  ///< The type of request.
-    uint8_t  request;       ///< The request code itself.
-    uint16_t value;         ///< The wValue field of the request.
-    uint16_t index;         ///< The wIndex field of the request.
-    uint16_t length;        ///< The valid data length.
-    uint8_t  data[1024u];   ///< The data buffer.
+    uint8_t  request_type;                            ///< The type of request.
+    uint8_t  request;                                 ///< The request code itself.
+    uint16_t value;                                   ///< The wValue field of the request.
+    uint16_t index;                                   ///< The wIndex field of the request.
+    uint16_t length;                                  ///< The valid data length.
+    uint8_t  data[sizeof(union audio_request_data)];  ///< The data buffer.
 } g_request;
 
 /**
@@ -55,14 +133,15 @@ static volatile struct audio_request_controls {
         uint8_t channel_index;                                      ///< The channel index.
         bool    b_channel_mute_states[AUDIO_CHANNEL_COUNT];         ///< Channel mute states.
         int16_t channel_volume_levels_8q8_db[AUDIO_CHANNEL_COUNT];  ///< Channel volumes in 8.8 format (in dB).
+        int16_t local_volume_level_8q8_db;                          ///< The volume of a control on the device.
     } volume;                                                       ///< The volume control structure.
     uint32_t sample_rate_hz;                                        ///< The audio sample rate in Hz.
 } g_controls;
 
 /**
- * @brief A pointer to the \a audio module's mailbox.
+ * @brief A pointer to the audio thread, which receives event flags.
  */
-static mailbox_t *gp_mailbox;
+static thread_t *gp_audio_thread;
 
 /**
  * @brief Check the mute state of an audio channel.
@@ -78,13 +157,20 @@ bool audio_request_is_channel_muted(enum audio_common_channel audio_channel) {
 
 /**
  * @brief Get the volume of an audio channel.
+ * @details This is the sum of the volume that the host set, and the local volume on the device. It does not fall below
+ * \a AUDIO_MIN_VOLUME_DB .
  *
  * @param audio_channel The audio channel, for which to get the volume.
  * @return int16_t The volume level in 8.8 fractional dB.
  */
 int16_t audio_request_get_channel_volume(enum audio_common_channel audio_channel) {
     chDbgCheckClassI();
-    return g_controls.volume.channel_volume_levels_8q8_db[audio_channel];
+    const int32_t MIN_VOLUME_8Q8_DB = (int32_t)AUDIO_MIN_VOLUME_DB * AUDIO_VOLUME_INCREMENT_STEPS;
+
+    int32_t volume_8q8_db = (int32_t)g_controls.volume.channel_volume_levels_8q8_db[audio_channel] +
+                            (int32_t)g_controls.volume.local_volume_level_8q8_db;
+
+    return (int16_t)((volume_8q8_db < MIN_VOLUME_8Q8_DB) ? MIN_VOLUME_8Q8_DB : volume_8q8_db);
 }
 
 /**
@@ -97,6 +183,43 @@ uint32_t audio_request_get_sample_rate_hz(void) {
     return g_controls.sample_rate_hz;
 }
 
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+/**
+ * @brief Pass the volume levels and mute states of all channels to the digital volume stage.
+ */
+static void audio_request_update_digital_volume(void) {
+    chDbgCheckClassI();
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        audio_volume_set_channel((enum audio_common_channel)channel_index,
+                                 audio_request_get_channel_volume((enum audio_common_channel)channel_index),
+                                 g_controls.volume.b_channel_mute_states[channel_index]);
+    }
+}
+#endif
+
+/**
+ * @brief Set the volume of a local control on the device, such as a potentiometer.
+ * @details The level adds to the volume of every channel, that the host set. It takes the same path as volume changes
+ * via USB, so that it is applied in the sample path, or by the application.
+ *
+ * @param volume_8q8_db The volume level in 8.8 fractional dB, at most zero.
+ */
+void audio_request_set_local_volume(int16_t volume_8q8_db) {
+    chDbgCheck(volume_8q8_db <= 0);
+
+    chSysLock();
+    g_controls.volume.local_volume_level_8q8_db = volume_8q8_db;
+
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+    audio_request_update_digital_volume();
+#endif
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_VOLUME));
+    chSchRescheduleS();
+    chSysUnlock();
+}
+
 /**
  * @brief Update changed volume levels.
  *
@@ -108,8 +231,8 @@ static void audio_request_update_volumes(USBDriver *p_usb) {
 
     chSysLockFromISR();
     if (g_controls.volume.channel_index == AUDIO_COMMON_CHANNEL_MASTER) {
-        memcpy((int16_t *)g_controls.volume.channel_volume_levels_8q8_db, (int16_t *)p_data + sizeof(int16_t),
-               2u * sizeof(int16_t));
+        memcpy((int16_t *)g_controls.volume.channel_volume_levels_8q8_db, (int16_t *)p_data + 1u,
+               AUDIO_CHANNEL_COUNT * sizeof(int16_t));
     } else {
         size_t audio_channel_index = g_controls.volume.channel_index - 1u;
         chDbgAssert(audio_channel_index < ARRAY_LENGTH(g_controls.volume.channel_volume_levels_8q8_db),
@@ -119,7 +242,11 @@ static void audio_request_update_volumes(USBDriver *p_usb) {
                sizeof(int16_t));
     }
 
-    chMBPostI(gp_mailbox, AUDIO_COMMON_MSG_SET_VOLUME);
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+    audio_request_update_digital_volume();
+#endif
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_VOLUME));
 
     chSysUnlockFromISR();
 }
@@ -135,8 +262,9 @@ static void audio_request_update_mute_states(USBDriver *p_usb) {
 
     chSysLockFromISR();
     if (g_controls.volume.channel_index == AUDIO_COMMON_CHANNEL_MASTER) {
-        g_controls.volume.b_channel_mute_states[AUDIO_COMMON_CHANNEL_LEFT]  = p_data[1u];
-        g_controls.volume.b_channel_mute_states[AUDIO_COMMON_CHANNEL_RIGHT] = p_data[2u];
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            g_controls.volume.b_channel_mute_states[channel_index] = p_data[1u + channel_index];
+        }
     } else {
         size_t audio_channel_index = g_controls.volume.channel_index - 1u;
         chDbgAssert(audio_channel_index < ARRAY_LENGTH(g_controls.volume.b_channel_mute_states),
@@ -145,7 +273,11 @@ static void audio_request_update_mute_states(USBDriver *p_usb) {
         g_controls.volume.b_channel_mute_states[audio_channel_index] = p_data[0u];
     }
 
-    chMBPostI(gp_mailbox, AUDIO_COMMON_MSG_SET_MUTE_STATE);
+#if AUDIO_DIGITAL_VOLUME_ENABLE
+    audio_request_update_digital_volume();
+#endif
+
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_MUTE_STATE));
 
     chSysUnlockFromISR();
 }
@@ -162,10 +294,166 @@ static void audio_request_update_sample_rate(USBDriver *p_usb) {
     byte_array_to_value(p_data, (uint32_t *)&g_controls.sample_rate_hz, g_request.length);
 
     chSysLockFromISR();
-    chMBPostI(gp_mailbox, AUDIO_COMMON_MSG_SET_SAMPLE_RATE);
+    chEvtSignalI(gp_audio_thread, AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_SET_SAMPLE_RATE));
     chSysUnlockFromISR();
 }
 
+#if AUDIO_UAC2_ENABLE
+/**
+ * @brief Send the response to a request, of which the host may read less than the full size.
+ * @details For example, hosts first read only the number of sub-ranges of a range attribute.
+ *
+ * @param p_usb A pointer to the USB driver structure.
+ * @param size The size of the full response in bytes.
+ */
+static void audio_request_transmit(USBDriver *p_usb, size_t size) {
+    if (size > g_request.length) {
+        size = g_request.length;
+    }
+
+    usbSetupTransfer(p_usb, (uint8_t *)g_request.data, size, NULL);
+}
+
+/**
+ * @brief Handle class interface function unit requests (UAC v2).
+ * @details Every request addresses a single channel, as the master channel has no controls.
+ *
+ * @param p_usb A pointer to the  USB driver structure.
+ * @return true if a setup request could be handled.
+ * @return false if a setup request could not be handled.
+ */
+static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
+    uint8_t *p_data = (uint8_t *)g_request.data;
+
+    uint8_t channel_index    = GET_BYTE(g_request.value, 0u);
+    uint8_t control_selector = GET_BYTE(g_request.value, 1u);
+    bool    b_is_get         = (g_request.request_type & USB_RTYPE_DIR_MASK) == USB_RTYPE_DIR_DEV2HOST;
+
+    // The volume level is given as an int16 value. An increment of 1 bit equals 1/256 dB of volume.
+    // Do not change, this is defined by the standard.
+    const int16_t AUDIO_VOLUME_STEPS_PER_DB = 256;
+
+    if ((channel_index == AUDIO_COMMON_CHANNEL_MASTER) || (channel_index > AUDIO_CHANNEL_COUNT)) {
+        return false;
+    }
+
+    if (control_selector == USB_DESC_FU_CONTROLS_MUTE) {
+        if (g_request.request != AUDIO_REQUEST_CUR) {
+            return false;
+        }
+
+        if (b_is_get) {
+            p_data[0] = g_controls.volume.b_channel_mute_states[channel_index - 1u];
+            audio_request_transmit(p_usb, sizeof(uint8_t));
+        } else {
+            if (g_request.length != sizeof(uint8_t)) {
+                return false;
+            }
+
+            g_controls.volume.channel_index = channel_index;
+            usbSetupTransfer(p_usb, p_data, g_request.length, audio_request_update_mute_states);
+        }
+        return true;
+    } else if (control_selector == USB_DESC_FU_CONTROLS_VOLUME) {
+        if (g_request.request == AUDIO_REQUEST_RANGE) {
+            if (!b_is_get) {
+                return false;
+            }
+
+            int16_t *p_range = (int16_t *)p_data;
+            p_range[0]       = 1;  // A single sub-range.
+            p_range[1]       = (int16_t)AUDIO_MIN_VOLUME_DB * AUDIO_VOLUME_STEPS_PER_DB;
+            p_range[2]       = (int16_t)AUDIO_MAX_VOLUME_DB * AUDIO_VOLUME_STEPS_PER_DB;
+            p_range[3]       = (int16_t)AUDIO_VOLUME_INCREMENT_STEPS;
+            audio_request_transmit(p_usb, 4u * sizeof(int16_t));
+            return true;
+        }
+
+        if (g_request.request != AUDIO_REQUEST_CUR) {
+            return false;
+        }
+
+        if (b_is_get) {
+            memcpy(p_data, (uint8_t *)&g_controls.volume.channel_volume_levels_8q8_db[channel_index - 1u],
+                   sizeof(int16_t));
+            audio_request_transmit(p_usb, sizeof(int16_t));
+        } else {
+            if (g_request.length != sizeof(int16_t)) {
+                return false;
+            }
+
+            g_controls.volume.channel_index = channel_index;
+            usbSetupTransfer(p_usb, p_data, g_request.length, audio_request_update_volumes);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Handle class interface clock source requests (UAC v2).
+ * @details The clock source is the single I2S clock domain, so that its sample rate applies to playback and capture.
+ *
+ * @param p_usb A pointer to the  USB driver structure.
+ * @return true if a setup request could be handled.
+ * @return false if a setup request could not be handled.
+ */
+static bool audio_request_handle_class_interface_clock(USBDriver *p_usb) {
+    uint8_t *p_data = (uint8_t *)g_request.data;
+
+    uint8_t control_selector = GET_BYTE(g_request.value, 1u);
+    bool    b_is_get         = (g_request.request_type & USB_RTYPE_DIR_MASK) == USB_RTYPE_DIR_DEV2HOST;
+
+    if (control_selector == AUDIO_REQUEST_CS_SAMPLING_FREQ) {
+        if (g_request.request == AUDIO_REQUEST_RANGE) {
+            if (!b_is_get) {
+                return false;
+            }
+
+            value_to_byte_array(p_data, USB_DESCRIPTORS_SAMPLE_RATE_COUNT, sizeof(uint16_t));
+
+            for (size_t rate_index = 0; rate_index < USB_DESCRIPTORS_SAMPLE_RATE_COUNT; rate_index++) {
+                uint8_t *p_sub_range = &p_data[sizeof(uint16_t) + 3u * sizeof(uint32_t) * rate_index];
+
+                value_to_byte_array(&p_sub_range[0u], g_sample_rates_hz[rate_index], sizeof(uint32_t));  // Min.
+                value_to_byte_array(&p_sub_range[4u], g_sample_rates_hz[rate_index], sizeof(uint32_t));  // Max.
+                value_to_byte_array(&p_sub_range[8u], 0u, sizeof(uint32_t));                             // Res.
+            }
+
+            audio_request_transmit(p_usb, AUDIO_REQUEST_SAMPLE_RATE_RANGE_SIZE);
+            return true;
+        }
+
+        if (g_request.request != AUDIO_REQUEST_CUR) {
+            return false;
+        }
+
+        if (b_is_get) {
+            value_to_byte_array(p_data, g_controls.sample_rate_hz, sizeof(uint32_t));
+            audio_request_transmit(p_usb, sizeof(uint32_t));
+        } else {
+            if (g_request.length != sizeof(uint32_t)) {
+                return false;
+            }
+
+            usbSetupTransfer(p_usb, p_data, g_request.length, audio_request_update_sample_rate);
+        }
+        return true;
+    } else if (control_selector == AUDIO_REQUEST_CS_CLOCK_VALID) {
+        if ((g_request.request != AUDIO_REQUEST_CUR) || !b_is_get) {
+            return false;
+        }
+
+        // The I2S PLL is always locked, when the host can address the device.
+        p_data[0] = 1u;
+        audio_request_transmit(p_usb, sizeof(uint8_t));
+        return true;
+    }
+
+    return false;
+}
+#else
 /**
  * @brief Handle class interface function unit requests.
  *
@@ -195,7 +483,7 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
 
         case AUDIO_REQUEST_GET_MAX:
             if (control_unit == USB_DESC_FU_CONTROLS_VOLUME) {
-                for (size_t i = 0; i < g_request.length; i++) {
+                for (size_t i = 0; i < (g_request.length / sizeof(int16_t)); i++) {
                     ((int16_t *)p_data)[i] = (int16_t)AUDIO_MAX_VOLUME_DB * AUDIO_VOLUME_STEPS_PER_DB;
                 }
                 usbSetupTransfer(p_usb, p_data, g_request.length, NULL);
@@ -205,7 +493,7 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
 
         case AUDIO_REQUEST_GET_MIN:
             if (control_unit == USB_DESC_FU_CONTROLS_VOLUME) {
-                for (size_t i = 0; i < g_request.length; i++) {
+                for (size_t i = 0; i < (g_request.length / sizeof(int16_t)); i++) {
                     ((int16_t *)p_data)[i] = (int16_t)AUDIO_MIN_VOLUME_DB * AUDIO_VOLUME_STEPS_PER_DB;
                 }
                 usbSetupTransfer(p_usb, p_data, g_request.length, NULL);
@@ -215,7 +503,7 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
 
         case AUDIO_REQUEST_GET_RES:
             if (control_unit == USB_DESC_FU_CONTROLS_VOLUME) {
-                for (size_t i = 0; i < g_request.length; i++) {
+                for (size_t i = 0; i < (g_request.length / sizeof(int16_t)); i++) {
                     ((int16_t *)p_data)[i] = (int16_t)AUDIO_VOLUME_INCREMENT_STEPS;
                 }
                 usbSetupTransfer(p_usb, p_data, g_request.length, NULL);
@@ -226,8 +514,11 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
         case AUDIO_REQUEST_GET_CUR:
             if (control_unit == USB_DESC_FU_CONTROLS_MUTE) {
                 if (channel_index == AUDIO_COMMON_CHANNEL_MASTER) {
-                    uint8_t value[3] = {0, g_controls.volume.b_channel_mute_states[AUDIO_COMMON_CHANNEL_LEFT],
-                                        g_controls.volume.b_channel_mute_states[AUDIO_COMMON_CHANNEL_RIGHT]};
+                    uint8_t value[1u + AUDIO_CHANNEL_COUNT] = {0};
+
+                    for (size_t i = 0; i < AUDIO_CHANNEL_COUNT; i++) {
+                        value[1u + i] = g_controls.volume.b_channel_mute_states[i];
+                    }
                     memcpy(p_data, value, sizeof(value));
                     usbSetupTransfer(p_usb, p_data, g_request.length, NULL);
                     return true;
@@ -239,8 +530,11 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
                 return true;
             } else if (control_unit == USB_DESC_FU_CONTROLS_VOLUME) {
                 if (channel_index == AUDIO_COMMON_CHANNEL_MASTER) {
-                    int16_t value[3] = {0, g_controls.volume.channel_volume_levels_8q8_db[AUDIO_COMMON_CHANNEL_LEFT],
-                                        g_controls.volume.channel_volume_levels_8q8_db[AUDIO_COMMON_CHANNEL_RIGHT]};
+                    int16_t value[1u + AUDIO_CHANNEL_COUNT] = {0};
+
+                    for (size_t i = 0; i < AUDIO_CHANNEL_COUNT; i++) {
+                        value[1u + i] = g_controls.volume.channel_volume_levels_8q8_db[i];
+                    }
                     memcpy(p_data, value, sizeof(value));
                     usbSetupTransfer(p_usb, p_data, g_request.length, NULL);
                     return true;
@@ -271,6 +565,7 @@ static bool audio_request_handle_class_interface_fu(USBDriver *p_usb) {
 
     return false;
 }
+#endif
 
 /**
  * @brief Handle USB audio control messages.
@@ -291,6 +586,13 @@ static bool audio_request_handle_class_interface(USBDriver *p_usb) {
         return audio_request_handle_class_interface_fu(p_usb);
     }
 
+#if AUDIO_UAC2_ENABLE
+    if (entity == USB_DESC_UNIT_CLOCK_SOURCE) {
+        // Handle requests to the clock source, which holds the sample rate.
+        return audio_request_handle_class_interface_clock(p_usb);
+    }
+#endif
+
     // No control message handling took place.
     return false;
 }
@@ -305,16 +607,38 @@ static bool audio_request_handle_class_interface(USBDriver *p_usb) {
 static bool audio_request_handle_standard_interface(USBDriver *p_usb) {
     switch (g_request.request) {
         case USB_REQ_SET_INTERFACE:
-            // Switch between operational and zero-bandwidth alternate modes.
+            // Switch between operational and zero-bandwidth alternate modes. Hosts may also switch between operational
+            // modes directly, so that streaming always stops first.
             if (g_request.index == USB_DESC_INTERFACE_STREAMING) {
+                audio_playback_stop_streaming(p_usb);
+
+                switch (g_request.value) {
+                    case USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL:
+                        audio_playback_start_streaming(p_usb, AUDIO_STREAM_FORMAT_NATIVE);
+                        break;
+#if AUDIO_PACKED_24_BIT_ENABLE
+                    case USB_DESC_INTERFACE_ALT_SETTING_PACKED_24_BIT:
+                        audio_playback_start_streaming(p_usb, AUDIO_STREAM_FORMAT_PACKED_24_BIT);
+                        break;
+#endif
+                    default:
+                        // Zero-bandwidth mode.
+                        break;
+                }
+
+                usbSetupTransfer(p_usb, NULL, 0, NULL);
+                return true;
+#if AUDIO_CAPTURE_ENABLE
+            } else if (g_request.index == USB_DESC_INTERFACE_CAPTURE) {
+                audio_capture_stop_streaming(p_usb);
+
                 if (g_request.value == USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL) {
-                    audio_playback_start_streaming(p_usb);
-                } else {
-                    audio_playback_stop_streaming(p_usb);
+                    audio_capture_start_streaming(p_usb);
                 }
 
                 usbSetupTransfer(p_usb, NULL, 0, NULL);
                 return true;
+#endif
             } else {
                 return false;
             }
@@ -323,6 +647,7 @@ static bool audio_request_handle_standard_interface(USBDriver *p_usb) {
     }
 }
 
+#if !AUDIO_UAC2_ENABLE
 /**
  * @brief Handle class endpoint audio requests.
  *
@@ -336,6 +661,7 @@ static bool audio_request_handle_class_endpoint(USBDriver *p_usb) {
     uint8_t  control_selector = GET_BYTE(g_request.value, 1u);
     uint16_t endpoint_index   = g_request.index;
 
+    // Playback and capture share the I2S clocks, so that the sampling frequency of either endpoint applies to both.
     (void)endpoint_index;
 
     if (control_selector != AUDIO_REQUEST_CS_SAMPLING_FREQ) {
@@ -346,6 +672,7 @@ static bool audio_request_handle_class_endpoint(USBDriver *p_usb) {
 
     return true;
 }
+#endif
 
 /**
  * @brief Handle standard audio requests.
@@ -376,8 +703,84 @@ static bool audio_request_handle_class(USBDriver *p_usb) {
         case USB_RTYPE_RECIPIENT_INTERFACE:
             return audio_request_handle_class_interface(p_usb);
 
+#if !AUDIO_UAC2_ENABLE
         case USB_RTYPE_RECIPIENT_ENDPOINT:
             return audio_request_handle_class_endpoint(p_usb);
+#endif
+
+        default:
+            return false;
+    }
+}
+
+#if AUDIO_DSP_ENABLE
+/**
+ * @brief Pass received biquad coefficients to the DSP stage.
+ *
+ * @param p_usb A pointer to the USB driver structure.
+ */
+static void audio_request_update_dsp_biquad(USBDriver *p_usb) {
+    (void)p_usb;
+    struct audio_dsp_biquad_coefficients coefficients;
+    memcpy(&coefficients, (uint8_t *)g_request.data, sizeof(coefficients));
+
+    chSysLockFromISR();
+    // Coefficients that are not finite, or form an unstable filter, are discarded.
+    (void)audio_dsp_set_biquad(AUDIO_REQUEST_GET_DSP_CHANNEL_INDEX(g_request.value),
+                               AUDIO_REQUEST_GET_DSP_BIQUAD_INDEX(g_request.value), &coefficients);
+    chSysUnlockFromISR();
+}
+#endif
+
+/**
+ * @brief Handle vendor-specific device requests.
+ * @details Selects the audio buffer profile, which takes effect at the start of the next audio stream. Sets DSP
+ * biquad coefficients, if the DSP stage is enabled.
+ *
+ * @param p_usb A pointer to the  USB driver structure.
+ * @return true if a setup request could be handled.
+ * @return false if a setup request could not be handled.
+ */
+static bool audio_request_handle_vendor(USBDriver *p_usb) {
+    if ((g_request.request_type & USB_RTYPE_RECIPIENT_MASK) != USB_RTYPE_RECIPIENT_DEVICE) {
+        return false;
+    }
+
+    switch (g_request.request) {
+        case AUDIO_REQUEST_VENDOR_SET_BUFFER_PROFILE:
+            if (g_request.value >= AUDIO_BUFFER_PROFILE_COUNT) {
+                return false;
+            }
+
+            chSysLockFromISR();
+            audio_playback_set_buffer_profile((enum audio_buffer_profile)g_request.value);
+            chSysUnlockFromISR();
+
+            usbSetupTransfer(p_usb, NULL, 0, NULL);
+            return true;
+
+#if AUDIO_DSP_ENABLE
+        case AUDIO_REQUEST_VENDOR_SET_DSP_BIQUAD:
+            if ((AUDIO_REQUEST_GET_DSP_CHANNEL_INDEX(g_request.value) >= AUDIO_CHANNEL_COUNT) ||
+                (AUDIO_REQUEST_GET_DSP_BIQUAD_INDEX(g_request.value) >= AUDIO_DSP_BIQUAD_COUNT) ||
+                (g_request.length != sizeof(struct audio_dsp_biquad_coefficients))) {
+                return false;
+            }
+
+            usbSetupTransfer(p_usb, (uint8_t *)g_request.data, g_request.length, audio_request_update_dsp_biquad);
+            return true;
+#endif
+
+        case AUDIO_REQUEST_VENDOR_GET_BUFFER_PROFILE: {
+            uint8_t *p_data = (uint8_t *)g_request.data;
+
+            chSysLockFromISR();
+            p_data[0] = (uint8_t)audio_playback_get_buffer_profile();
+            chSysUnlockFromISR();
+
+            usbSetupTransfer(p_usb, p_data, 1u, NULL);
+            return true;
+        }
 
         default:
             return false;
@@ -398,7 +801,15 @@ bool audio_request_hook_cb(USBDriver *p_usb) {
     g_request.index        = ((p_usb->setup[5] << 8) | p_usb->setup[4]);
     g_request.length       = ((p_usb->setup[7] << 8) | p_usb->setup[6]);
 
-    chDbgAssert(g_request.length <= ARRAY_LENGTH(g_request.data), "Request data buffer exceeded.");
+    if (g_request.length > ARRAY_LENGTH(g_request.data)) {
+        if ((g_request.request_type & USB_RTYPE_DIR_MASK) != USB_RTYPE_DIR_DEV2HOST) {
+            // Data stages that exceed the buffer are never handled by this module, e.g. standard descriptor requests.
+            return false;
+        }
+
+        // The device may answer with fewer bytes than requested.
+        g_request.length = ARRAY_LENGTH(g_request.data);
+    }
 
     switch (g_request.request_type & USB_RTYPE_TYPE_MASK) {
         case USB_RTYPE_TYPE_STD:
@@ -407,6 +818,9 @@ bool audio_request_hook_cb(USBDriver *p_usb) {
         case USB_RTYPE_TYPE_CLASS:
             return audio_request_handle_class(p_usb);
 
+        case USB_RTYPE_TYPE_VENDOR:
+            return audio_request_handle_vendor(p_usb);
+
         default:
             return false;
     }
@@ -414,10 +828,12 @@ bool audio_request_hook_cb(USBDriver *p_usb) {
 
 /**
  * @brief Initialize the audio request module.
+ *
+ * @param p_audio_thread A pointer to the audio thread, which receives event flags.
  */
-void audio_request_init(mailbox_t *p_mailbox) {
+void audio_request_init(thread_t *p_audio_thread) {
     chDbgCheckClassI();
-    gp_mailbox = p_mailbox;
+    gp_audio_thread = p_audio_thread;
 
     g_controls.volume.channel_index = 0u;
 
@@ -426,6 +842,8 @@ void audio_request_init(mailbox_t *p_mailbox) {
         g_controls.volume.channel_volume_levels_8q8_db[channel_index] = 0;
     }
 
+    g_controls.volume.local_volume_level_8q8_db = 0;
+
     g_controls.sample_rate_hz = AUDIO_DEFAULT_SAMPLE_RATE_HZ;
 }
 
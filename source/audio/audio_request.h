@@ -3,7 +3,7 @@
 /**
  * @file
  * @brief   Audio request module.
- * @details Contains functionality for handling UAC v1 audio requests.
+ * @details Contains functionality for handling UAC v1 or UAC v2 audio requests.
  *
  * @addtogroup audio
  * @{
@@ -17,9 +17,10 @@
 bool     audio_request_is_channel_muted(enum audio_common_channel audio_channel);
 int16_t  audio_request_get_channel_volume(enum audio_common_channel audio_channel);
 uint32_t audio_request_get_sample_rate_hz(void);
+void     audio_request_set_local_volume(int16_t volume_8q8_db);
 bool     audio_request_hook_cb(USBDriver *p_usb);
 
-void audio_request_init(mailbox_t *p_mailbox);
+void audio_request_init(thread_t *p_audio_thread);
 
 #endif  // SOURCE_AUDIO_AUDIO_REQUEST_H_
 
@@ -0,0 +1,192 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio resampler module.
+ * @details Contains an adaptive fractional-delay resampler, which slightly speeds up or slows down playback. The
+ * resampling ratio is driven by the audio buffer fill size error, such that the fill size converges to its target
+ * without dropping or repeating blocks of audio samples.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_resampler.h"
+
+/**
+ * @brief The nominal resampling step of one input frame per output frame, in 32.32 fixpoint format.
+ */
+#define AUDIO_RESAMPLER_UNITY_STEP (((int64_t)1) << 32u)
+
+/**
+ * @brief A structure that holds the state of the resampler.
+ */
+static struct audio_resampler {
+    int32_t history[AUDIO_CHANNEL_COUNT];  ///< The last input frame of the previous packet.
+    int64_t position;  ///< The position of the next output frame in 32.32 fixpoint format. Counted in input frames,
+                       ///< where position zero is the history frame.
+    int64_t step;      ///< The resampling step in 32.32 fixpoint format. Counted in input frames per output frame.
+    int32_t fill_size_error_integral;  ///< The accumulated buffer fill size error in audio frames.
+} g_resampler;
+
+/**
+ * @brief Load an audio sample from a received USB packet.
+ * @details The sample is converted to a 32 bit signed value, where the sample's MSB is aligned to bit 31.
+ *
+ * @param p_input The pointer to the received packet.
+ * @param frame_index The index of the frame within the packet.
+ * @param channel_index The channel index within the frame.
+ * @return int32_t The sample value.
+ */
+__STATIC_INLINE int32_t audio_resampler_load(const uint8_t *p_input, size_t frame_index, size_t channel_index) {
+    const size_t SAMPLE_INDEX = frame_index * AUDIO_CHANNEL_COUNT + channel_index;
+
+#if AUDIO_RESOLUTION_BIT == 16u
+    return (int32_t)((const int16_t *)p_input)[SAMPLE_INDEX] * (int32_t)(1u << 16u);
+#elif AUDIO_RESOLUTION_BIT == 32u
+    return ((const int32_t *)p_input)[SAMPLE_INDEX];
+#endif
+}
+
+/**
+ * @brief Store an audio sample in the audio buffer, in the format that the I2S DMA expects.
+ *
+ * @param p_output The pointer to the output location.
+ * @param value The sample value, where the sample's MSB is aligned to bit 31.
+ */
+__STATIC_INLINE void audio_resampler_store(uint8_t *p_output, int32_t value) {
+#if AUDIO_RESOLUTION_BIT == 16u
+    *(int16_t *)p_output = (int16_t)(value >> 16u);
+#elif AUDIO_RESOLUTION_BIT == 32u
+    // The I2S DMA handles word transfers as two separate half-word transfers. Swap the half-words.
+    *(uint32_t *)p_output = SWAP_HALF_WORDS(value);
+#endif
+}
+
+/**
+ * @brief Interpolate between two audio samples.
+ * @details The samples are halved before calculating their difference, so that it cannot overflow. The product with
+ * the fractional position is calculated by means of the DSP instruction \a SMMUL (most significant word multiply).
+ * The step is scaled and added as an unsigned value, as scaling it may exceed the signed range, while the sum does
+ * not.
+ *
+ * @param sample_a The sample at the integer position.
+ * @param sample_b The sample at the following integer position.
+ * @param fraction The fractional position between the samples in 0.31 format.
+ * @return int32_t The interpolated sample value.
+ */
+__STATIC_INLINE int32_t audio_resampler_interpolate(int32_t sample_a, int32_t sample_b, int32_t fraction) {
+    int32_t half_difference = (sample_b >> 1) - (sample_a >> 1);
+
+    // The result of SMMUL is (half_difference * fraction) / 2^32, which is a quarter of the desired step.
+    return (int32_t)((uint32_t)sample_a + ((uint32_t)__SMMUL(half_difference, fraction) << 2u));
+}
+
+/**
+ * @brief Set the resampling ratio correction from the current audio buffer fill size error.
+ * @details A positive error (too much buffered data) speeds up playback, a negative error slows it down. Implements a
+ * PI controller: the proportional term follows the error, and the integral term cancels the remaining offset for a
+ * constant clock deviation. The integral and the total correction are limited to
+ * \a AUDIO_RESAMPLER_MAX_CORRECTION_PPM , which prevents windup.
+ * @note This internally uses I-class functions.
+ *
+ * @param fill_size_error_frames The deviation of the buffer fill size from its target, in audio frames.
+ */
+void audio_resampler_set_correction(int32_t fill_size_error_frames) {
+    chDbgCheckClassI();
+    const int32_t MAX_CORRECTION_PPM = (int32_t)AUDIO_RESAMPLER_MAX_CORRECTION_PPM;
+
+    const int32_t MAX_INTEGRAL       = MAX_CORRECTION_PPM * (int32_t)(1u << AUDIO_RESAMPLER_INTEGRAL_SHIFT);
+
+    g_resampler.fill_size_error_integral += fill_size_error_frames;
+
+    if (g_resampler.fill_size_error_integral > MAX_INTEGRAL) {
+        g_resampler.fill_size_error_integral = MAX_INTEGRAL;
+    } else if (g_resampler.fill_size_error_integral < -MAX_INTEGRAL) {
+        g_resampler.fill_size_error_integral = -MAX_INTEGRAL;
+    }
+
+    int32_t correction_ppm = fill_size_error_frames * (int32_t)AUDIO_RESAMPLER_CORRECTION_PPM_PER_FRAME +
+                             g_resampler.fill_size_error_integral / (int32_t)(1u << AUDIO_RESAMPLER_INTEGRAL_SHIFT);
+
+    if (correction_ppm > MAX_CORRECTION_PPM) {
+        correction_ppm = MAX_CORRECTION_PPM;
+    } else if (correction_ppm < -MAX_CORRECTION_PPM) {
+        correction_ppm = -MAX_CORRECTION_PPM;
+    }
+
+    g_resampler.step = AUDIO_RESAMPLER_UNITY_STEP + ((int64_t)correction_ppm * AUDIO_RESAMPLER_UNITY_STEP) / 1000000;
+}
+
+/**
+ * @brief Resample a received audio packet into the circular audio buffer.
+ * @details Output frames are linearly interpolated between adjacent input frames (a two-tap fractional delay). The
+ * number of output frames differs from the number of input frames, depending on the resampling step. Without
+ * correction, the output is a copy of the input, delayed by one frame.
+ * @note This internally uses I-class functions.
+ *
+ * @param p_input The pointer to the received USB packet.
+ * @param input_size The size of the received USB packet in bytes.
+ * @param p_output The pointer to the circular audio buffer.
+ * @param output_offset The write offset in the circular audio buffer in bytes.
+ * @param output_size The size of the circular audio buffer in bytes, at which the write offset wraps.
+ * @return size_t The number of bytes that were written to the audio buffer.
+ */
+size_t audio_resampler_process(const uint8_t *p_input, size_t input_size, uint8_t *p_output, size_t output_offset,
+                               size_t output_size) {
+    chDbgCheckClassI();
+
+    const size_t INPUT_FRAME_COUNT = input_size / AUDIO_FRAME_SIZE;
+    size_t       output_byte_count = 0u;
+
+    if (INPUT_FRAME_COUNT == 0u) {
+        return 0u;
+    }
+
+    while ((size_t)(g_resampler.position >> 32u) < INPUT_FRAME_COUNT) {
+        const size_t  FRAME_INDEX = (size_t)(g_resampler.position >> 32u);
+        const int32_t FRACTION    = (int32_t)((uint32_t)g_resampler.position >> 1u);
+
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            // The frame at index zero is the last frame of the previous packet.
+            int32_t sample_a = (FRAME_INDEX == 0u) ? g_resampler.history[channel_index]
+                                                   : audio_resampler_load(p_input, FRAME_INDEX - 1u, channel_index);
+            int32_t sample_b = audio_resampler_load(p_input, FRAME_INDEX, channel_index);
+
+            audio_resampler_store(&p_output[output_offset], audio_resampler_interpolate(sample_a, sample_b, FRACTION));
+            output_offset = add_circular_unsigned(output_offset, AUDIO_SAMPLE_SIZE, output_size);
+        }
+
+        output_byte_count += AUDIO_FRAME_SIZE;
+        g_resampler.position += g_resampler.step;
+    }
+
+    // Continue with the next packet, relative to its first frame.
+    g_resampler.position -= (int64_t)INPUT_FRAME_COUNT * AUDIO_RESAMPLER_UNITY_STEP;
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        g_resampler.history[channel_index] = audio_resampler_load(p_input, INPUT_FRAME_COUNT - 1u, channel_index);
+    }
+
+    return output_byte_count;
+}
+
+/**
+ * @brief Initialize the resampler.
+ * @details Resets the history to silence, and the resampling ratio to unity, with an empty integral.
+ */
+void audio_resampler_init(void) {
+    chDbgCheckClassI();
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        g_resampler.history[channel_index] = 0;
+    }
+
+    g_resampler.position                 = 0;
+    g_resampler.step                     = AUDIO_RESAMPLER_UNITY_STEP;
+    g_resampler.fill_size_error_integral = 0;
+}
+
+/**
+ * @}
+ */
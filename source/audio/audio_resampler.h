@@ -0,0 +1,26 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio resampler module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_RESAMPLER_H_
+#define SOURCE_AUDIO_AUDIO_RESAMPLER_H_
+
+#include "audio_common.h"
+
+void   audio_resampler_set_correction(int32_t fill_size_error_frames);
+size_t audio_resampler_process(const uint8_t *p_input, size_t input_size, uint8_t *p_output, size_t output_offset,
+                               size_t output_size);
+
+void audio_resampler_init(void);
+
+#endif  // SOURCE_AUDIO_AUDIO_RESAMPLER_H_
+
+/**
+ * @}
+ */
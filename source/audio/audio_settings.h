@@ -11,22 +11,187 @@
 #ifndef SOURCE_AUDIO_AUDIO_SETTINGS_H_
 #define SOURCE_AUDIO_AUDIO_SETTINGS_H_
 
+/**
+ * @brief Enable the four-channel TDM output.
+ * @details The USB stream carries \a AUDIO_TDM_SLOT_COUNT channels of 16 bit, which are transmitted in 16 bit TDM
+ * slots. The slots share the I2S frame of two 32 bit words, so that bit and frame clocks remain unchanged. Requires a
+ * resolution of 16 bit.
+ */
+#ifndef AUDIO_TDM_ENABLE
+#define AUDIO_TDM_ENABLE 0u
+#endif
+
+/**
+ * @brief The TDM slot, on which each USB channel is transmitted, indexed by the USB channel.
+ * @details Must assign every slot exactly once. With the identity mapping, samples are not moved at all.
+ */
+#ifndef AUDIO_TDM_SLOT_MAP
+#define AUDIO_TDM_SLOT_MAP {0u, 1u, 2u, 3u}
+#endif
+
+/**
+ * @brief Enable the 88.2 kHz and 96 kHz sample rates, next to 44.1 kHz and 48 kHz.
+ * @details All sample buffers are sized for the highest enabled sample rate, so that disabling the high rates halves
+ * them.
+ */
+#ifndef AUDIO_HIGH_SAMPLE_RATE_ENABLE
+#define AUDIO_HIGH_SAMPLE_RATE_ENABLE 1u
+#endif
+
+/**
+ * @brief Enumerate as a USB Audio Class 2.0 device, instead of UAC 1.0.
+ * @details The device stays full-speed, so that explicit feedback keeps the 10.14 format in three bytes.
+ */
+#ifndef AUDIO_UAC2_ENABLE
+#define AUDIO_UAC2_ENABLE 0u
+#endif
+
 /**
  * @brief The resolution of an audio sample in bits.
- * @note Currently supports 16 and 32 bit.
+ * @note Currently supports 16 and 32 bit. The TDM output uses 16 bit.
  */
 #ifndef AUDIO_RESOLUTION_BIT
+#if AUDIO_TDM_ENABLE
+#define AUDIO_RESOLUTION_BIT 16u
+#else
 #define AUDIO_RESOLUTION_BIT 32u
 #endif
+#endif
+
+/**
+ * @brief Enable an additional alternate setting, which streams packed 24 bit samples (3-byte subslots).
+ * @details Received samples are expanded to the 32 bit layout of the I2S DMA. This saves a quarter of the USB bandwidth
+ * and RX FIFO space, compared to 32 bit subslots. Requires a resolution of 32 bit.
+ */
+#ifndef AUDIO_PACKED_24_BIT_ENABLE
+#if AUDIO_RESOLUTION_BIT == 32u
+#define AUDIO_PACKED_24_BIT_ENABLE 1u
+#else
+#define AUDIO_PACKED_24_BIT_ENABLE 0u
+#endif
+#endif
+
+/**
+ * @brief Enable the digital volume and mute stage in the sample path.
+ * @details If enabled, received audio samples are scaled by the volume levels and mute states that the host requests,
+ * starting with the next received packet. Gain changes are ramped over a packet. This is an alternative to volume
+ * control via the amplifiers, e.g. for boards without smart amplifiers.
+ */
+#ifndef AUDIO_DIGITAL_VOLUME_ENABLE
+#define AUDIO_DIGITAL_VOLUME_ENABLE 0u
+#endif
+
+/**
+ * @brief Enable the biquad DSP stage in the sample path.
+ * @details If enabled, every channel passes a cascade of \a AUDIO_DSP_BIQUAD_COUNT biquad filters, e.g. for a
+ * crossover, room equalization, and loudness compensation. The filters run on the FPU, and are set by the host with
+ * vendor requests. Usually set from the command line, e.g. with `make AUDIO_DSP_ENABLE=1`, which also enables the FPU.
+ */
+#ifndef AUDIO_DSP_ENABLE
+#define AUDIO_DSP_ENABLE 0u
+#endif
+
+/**
+ * @brief The number of cascaded biquad filters per channel in the DSP stage.
+ */
+#ifndef AUDIO_DSP_BIQUAD_COUNT
+#define AUDIO_DSP_BIQUAD_COUNT 6u
+#endif
+
+/**
+ * @brief The number of CPU cycles, which the DSP stage may spend on a packet.
+ * @details The default is a quarter of the 1 ms packet period at the 64 MHz system clock. If a packet takes longer,
+ * the DSP stage outputs silence until the next change of filter coefficients, so that unfiltered audio never reaches
+ * the outputs of a crossover.
+ */
+#ifndef AUDIO_DSP_CYCLE_BUDGET
+#define AUDIO_DSP_CYCLE_BUDGET 16000u
+#endif
+
+/**
+ * @brief Enable the capture path, which records the I2S input, and streams it to the host.
+ * @details The I2S3 extension receives in full-duplex with the I2S output, so that capture shares its clocks, and the
+ * feedback measurement. Usually set from the command line, e.g. with `make AUDIO_CAPTURE_ENABLE=1`, which also
+ * shrinks the USB RX FIFO, in order to make room for the TX FIFO of the capture endpoint.
+ */
+#ifndef AUDIO_CAPTURE_ENABLE
+#define AUDIO_CAPTURE_ENABLE 0u
+#endif
+
+/**
+ * @brief The number of captured audio channels (1 or 2).
+ * @details The first channel is the left I2S slot, the second one the right I2S slot.
+ */
+#ifndef AUDIO_CAPTURE_CHANNEL_COUNT
+#define AUDIO_CAPTURE_CHANNEL_COUNT 1u
+#endif
+
+/**
+ * @brief The number of audio frames in the capture buffer, which the I2S input fills. Must be a power of two.
+ */
+#ifndef AUDIO_CAPTURE_BUFFER_FRAME_COUNT
+#define AUDIO_CAPTURE_BUFFER_FRAME_COUNT 256u
+#endif
+
+/**
+ * @brief Enable the round-trip latency test mode.
+ * @details Periodically injects a full-scale marker into the left channel of the I2S output, and detects it on the
+ * capture path, which requires a loopback from the I2S output to the I2S input. Usually set from the command line,
+ * e.g. with `make AUDIO_LATENCY_TEST_ENABLE=1`, which also enables the capture path. The markers are audible, so that
+ * this mode is only meant for measurements.
+ */
+#ifndef AUDIO_LATENCY_TEST_ENABLE
+#define AUDIO_LATENCY_TEST_ENABLE 0u
+#endif
+
+/**
+ * @brief The number of received packets between two latency markers.
+ * @details Markers that are not detected within this interval are counted as missed.
+ */
+#ifndef AUDIO_LATENCY_TEST_INTERVAL_PACKETS
+#define AUDIO_LATENCY_TEST_INTERVAL_PACKETS 250u
+#endif
+
+/**
+ * @brief The smallest captured 16 bit sample value, which is detected as a latency marker.
+ */
+#ifndef AUDIO_LATENCY_TEST_THRESHOLD
+#define AUDIO_LATENCY_TEST_THRESHOLD 0x4000
+#endif
 
 /**
- * @brief The number of complete audio packets to hold in the audio buffer.
+ * @brief The number of complete audio packets to hold in the audio buffer, with the default buffer profile.
  * @details Larger numbers allow more tolerance for changes in provided sample rate, but lead to more latency.
  */
 #ifndef AUDIO_BUFFER_PACKET_COUNT
 #define AUDIO_BUFFER_PACKET_COUNT 7u
 #endif
 
+/**
+ * @brief The number of complete audio packets to hold in the audio buffer, with the low-latency buffer profile.
+ * @details Like the other profiles, it must hold at least three packets, so that playback can start.
+ */
+#ifndef AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY
+#define AUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY 3u
+#endif
+
+/**
+ * @brief The number of complete audio packets to hold in the audio buffer, with the robust buffer profile.
+ * @details For hosts with irregular packet timing. The static audio buffer is sized for this profile.
+ */
+#ifndef AUDIO_BUFFER_PACKET_COUNT_ROBUST
+#define AUDIO_BUFFER_PACKET_COUNT_ROBUST 12u
+#endif
+
+/**
+ * @brief The time in ms, for which I2S keeps clocking out silence after playback stopped (warm idle).
+ * @details If streaming resumes within this time, playback continues at the next received packet, without priming the
+ * audio buffer, or restarting I2S and feedback measurement. Afterwards, I2S and SOF capture are stopped.
+ */
+#ifndef AUDIO_WARM_IDLE_TIMEOUT_MS
+#define AUDIO_WARM_IDLE_TIMEOUT_MS 2000u
+#endif
+
 /**
  * @brief The exponent of the period between feedback packets in 2^N ms.
  */
@@ -34,6 +199,110 @@
 #define AUDIO_FEEDBACK_PERIOD_EXPONENT 0x03u
 #endif
 
+/**
+ * @brief The exponent of the shortest feedback measurement window in 2^N ms, after which a coarse feedback value is
+ * reported to the host (fast-lock).
+ * @details Until \a AUDIO_FEEDBACK_PERIOD_EXPONENT is reached, the measurement window doubles in length. Setting this
+ * equal to \a AUDIO_FEEDBACK_PERIOD_EXPONENT disables fast-lock.
+ */
+#ifndef AUDIO_FEEDBACK_FAST_LOCK_EXPONENT
+#define AUDIO_FEEDBACK_FAST_LOCK_EXPONENT 0x01u
+#endif
+
+/**
+ * @brief Enable the adaptive resampler for buffer fill size control.
+ * @details If enabled, received audio packets are resampled by a small ratio that is driven by the buffer fill size
+ * error, instead of moving the buffer write offset by the whole error. Forced write offset corrections are only applied
+ * as a last resort, which allows for a smaller \a AUDIO_BUFFER_PACKET_COUNT .
+ */
+#ifndef AUDIO_RESAMPLER_ENABLE
+#define AUDIO_RESAMPLER_ENABLE 0u
+#endif
+
+/**
+ * @brief The resampling ratio correction in ppm, per audio frame of buffer fill size error.
+ */
+#ifndef AUDIO_RESAMPLER_CORRECTION_PPM_PER_FRAME
+#define AUDIO_RESAMPLER_CORRECTION_PPM_PER_FRAME 20u
+#endif
+
+/**
+ * @brief The scale of the integral term of the resampling ratio correction, as a bit-shift.
+ * @details The buffer fill size error is accumulated once per packet. The integral term adds 1 ppm per
+ * 2^AUDIO_RESAMPLER_INTEGRAL_SHIFT frames of accumulated error, which cancels the fill size offset that the
+ * proportional term needs for a constant clock deviation.
+ */
+#ifndef AUDIO_RESAMPLER_INTEGRAL_SHIFT
+#define AUDIO_RESAMPLER_INTEGRAL_SHIFT 7u
+#endif
+
+/**
+ * @brief The maximum resampling ratio correction in ppm.
+ */
+#ifndef AUDIO_RESAMPLER_MAX_CORRECTION_PPM
+#define AUDIO_RESAMPLER_MAX_CORRECTION_PPM 1000u
+#endif
+
+/**
+ * @brief Enable closed-loop feedback control of the audio buffer fill size.
+ * @details If enabled, a PI controller adds a correction to the measured feedback value, which is derived from the
+ * deviation of the audio buffer fill size from its target. This steers the host towards keeping the buffer at its
+ * target fill size, so that forced write offset corrections are not required.
+ */
+#ifndef AUDIO_FEEDBACK_CONTROL_ENABLE
+#define AUDIO_FEEDBACK_CONTROL_ENABLE 0u
+#endif
+
+/**
+ * @brief The bit-shift that scales the feedback controller gains.
+ * @details Gains are fixpoint numbers with \a AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT fractional bits.
+ */
+#ifndef AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT
+#define AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT 8u
+#endif
+
+/**
+ * @brief The proportional gain of the feedback controller.
+ * @details In units of the 10.14 feedback format, per audio frame of buffer fill size error. The default of 8 units is
+ * roughly 0.5 Hz per frame of error.
+ */
+#ifndef AUDIO_FEEDBACK_CONTROL_KP
+#define AUDIO_FEEDBACK_CONTROL_KP (8 << AUDIO_FEEDBACK_CONTROL_GAIN_SHIFT)
+#endif
+
+/**
+ * @brief The integral gain of the feedback controller.
+ * @details In units of the 10.14 feedback format, per audio frame of accumulated buffer fill size error. The error is
+ * accumulated once per feedback period.
+ */
+#ifndef AUDIO_FEEDBACK_CONTROL_KI
+#define AUDIO_FEEDBACK_CONTROL_KI 2
+#endif
+
+/**
+ * @brief The maximum magnitude of the feedback correction, in units of the 10.14 feedback format.
+ * @details The default of 164 units is roughly 10 Hz.
+ */
+#ifndef AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION
+#define AUDIO_FEEDBACK_CONTROL_MAX_CORRECTION 164
+#endif
+
+/**
+ * @brief The number of bins in the audio buffer fill size histogram of the audio statistics.
+ * @details The bins evenly divide the nominal audio buffer size.
+ */
+#ifndef AUDIO_STATS_FILL_SIZE_BIN_COUNT
+#define AUDIO_STATS_FILL_SIZE_BIN_COUNT 16u
+#endif
+
+/**
+ * @brief Enable cycle counter profiling of audio interrupt handlers and critical sections.
+ * @details Usually set from the command line, e.g. with `make AUDIO_PROFILE=1`.
+ */
+#ifndef AUDIO_PROFILE
+#define AUDIO_PROFILE 0u
+#endif
+
 // Audio volume adjustment settings.
 #define AUDIO_MAX_VOLUME_DB          0
 #define AUDIO_MIN_VOLUME_DB          -100
@@ -0,0 +1,185 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio statistics module.
+ * @details Collects audio health counters and a buffer fill size histogram from the interrupt contexts of the audio
+ * path. Every group of statistics has exactly one writer (an interrupt context), which never waits and never locks.
+ * Readers obtain a consistent snapshot by means of a sequence counter per group (seqlock): the writer makes the counter
+ * odd while it updates the group, and readers retry until they copied the group with the same, even counter value
+ * before and after.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_stats.h"
+
+#include <string.h>
+
+/**
+ * @brief A group of statistics with a single writer, guarded by a sequence counter.
+ */
+static struct audio_stats_usb_group {
+    volatile uint32_t      sequence;  ///< The sequence counter, odd while the statistics are written.
+    struct audio_stats_usb stats;     ///< The statistics.
+} g_stats_usb;
+
+/**
+ * @brief A group of statistics with a single writer, guarded by a sequence counter.
+ */
+static struct audio_stats_feedback_group {
+    volatile uint32_t           sequence;  ///< The sequence counter, odd while the statistics are written.
+    struct audio_stats_feedback stats;     ///< The statistics.
+} g_stats_feedback;
+
+/**
+ * @brief Begin writing to a group of statistics, by making its sequence counter odd.
+ *
+ * @param p_sequence The pointer to the sequence counter of the group.
+ */
+__STATIC_INLINE void audio_stats_write_begin(volatile uint32_t *p_sequence) {
+    *p_sequence = *p_sequence + 1u;
+    __DMB();
+}
+
+/**
+ * @brief End writing to a group of statistics, by making its sequence counter even.
+ *
+ * @param p_sequence The pointer to the sequence counter of the group.
+ */
+__STATIC_INLINE void audio_stats_write_end(volatile uint32_t *p_sequence) {
+    __DMB();
+    *p_sequence = *p_sequence + 1u;
+}
+
+/**
+ * @brief Copy a group of statistics consistently, retrying while the writer interrupts the copy.
+ *
+ * @param p_sequence The pointer to the sequence counter of the group.
+ * @param p_destination The destination of the copy.
+ * @param p_source The statistics of the group.
+ * @param size The size of the statistics in bytes.
+ */
+static void audio_stats_read(const volatile uint32_t *p_sequence, void *p_destination, const void *p_source,
+                             size_t size) {
+    uint32_t sequence_before;
+    uint32_t sequence_after;
+
+    do {
+        sequence_before = *p_sequence;
+        __DMB();
+        memcpy(p_destination, p_source, size);
+        __DMB();
+        sequence_after = *p_sequence;
+    } while ((sequence_before != sequence_after) || ((sequence_before & 1u) != 0u));
+}
+
+/**
+ * @brief Record the reception of an audio packet.
+ * @note Must only be called from the USB interrupt context.
+ */
+void audio_stats_record_received_packet(void) {
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.received_packet_count++;
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record a failed (zero-length) audio packet transaction.
+ * @note Must only be called from the USB interrupt context.
+ */
+void audio_stats_record_failed_transaction(void) {
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.failed_transaction_count++;
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record a forced correction of the audio buffer write offset.
+ * @note Must only be called from the USB interrupt context.
+ *
+ * @param correction_bytes The magnitude of the correction in bytes.
+ */
+void audio_stats_record_forced_correction(size_t correction_bytes) {
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.forced_correction_count++;
+    g_stats_usb.stats.forced_correction_total_bytes += correction_bytes;
+
+    if (correction_bytes > g_stats_usb.stats.forced_correction_max_bytes) {
+        g_stats_usb.stats.forced_correction_max_bytes = correction_bytes;
+    }
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record the start of audio playback.
+ * @note Must only be called from the USB interrupt context.
+ */
+void audio_stats_record_playback_start(void) {
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.playback_start_count++;
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record the end of audio playback.
+ * @note Must only be called from the USB interrupt context.
+ */
+void audio_stats_record_playback_stop(void) {
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.playback_stop_count++;
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record the current audio buffer fill size in the histogram.
+ * @details The histogram bins evenly divide the nominal audio buffer size. Fill sizes at or above the nominal buffer
+ * size count towards the last bin.
+ * @note Must only be called from the USB interrupt context.
+ *
+ * @param fill_size The audio buffer fill size in bytes.
+ * @param buffer_size The nominal audio buffer size in bytes.
+ */
+void audio_stats_record_fill_size(size_t fill_size, size_t buffer_size) {
+    if (buffer_size == 0u) {
+        return;
+    }
+
+    size_t bin_index = (fill_size * AUDIO_STATS_FILL_SIZE_BIN_COUNT) / buffer_size;
+
+    if (bin_index >= AUDIO_STATS_FILL_SIZE_BIN_COUNT) {
+        bin_index = AUDIO_STATS_FILL_SIZE_BIN_COUNT - 1u;
+    }
+
+    audio_stats_write_begin(&g_stats_usb.sequence);
+    g_stats_usb.stats.fill_size_histogram[bin_index]++;
+    audio_stats_write_end(&g_stats_usb.sequence);
+}
+
+/**
+ * @brief Record an update of the feedback value.
+ * @note Must only be called from the feedback timer interrupt context.
+ */
+void audio_stats_record_feedback_update(void) {
+    audio_stats_write_begin(&g_stats_feedback.sequence);
+    g_stats_feedback.stats.update_count++;
+    audio_stats_write_end(&g_stats_feedback.sequence);
+}
+
+/**
+ * @brief Get a consistent snapshot of all audio statistics.
+ * @details Each group of statistics is consistent in itself. Must be called from thread context, so that the writers
+ * can preempt the copy.
+ *
+ * @param p_stats The pointer to the structure that receives the snapshot.
+ */
+void audio_stats_get(struct audio_stats *p_stats) {
+    audio_stats_read(&g_stats_usb.sequence, &p_stats->usb, &g_stats_usb.stats, sizeof(p_stats->usb));
+    audio_stats_read(&g_stats_feedback.sequence, &p_stats->feedback, &g_stats_feedback.stats,
+                     sizeof(p_stats->feedback));
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,59 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio statistics module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_STATS_H_
+#define SOURCE_AUDIO_AUDIO_STATS_H_
+
+#include "audio_common.h"
+
+/**
+ * @brief Statistics that are written from the USB interrupt context.
+ */
+struct audio_stats_usb {
+    uint32_t received_packet_count;                                 ///< The number of received audio packets.
+    uint32_t failed_transaction_count;                              ///< The number of failed, empty transactions.
+    uint32_t forced_correction_count;                               ///< The number of forced write offset corrections.
+    uint32_t forced_correction_total_bytes;                         ///< The sum of forced correction magnitudes.
+    uint32_t forced_correction_max_bytes;                           ///< The largest forced correction magnitude.
+    uint32_t playback_start_count;                                  ///< The number of times that playback started.
+    uint32_t playback_stop_count;                                   ///< The number of times that playback stopped.
+    uint32_t fill_size_histogram[AUDIO_STATS_FILL_SIZE_BIN_COUNT];  ///< The buffer fill size histogram.
+};
+
+/**
+ * @brief Statistics that are written from the feedback timer interrupt context.
+ */
+struct audio_stats_feedback {
+    uint32_t update_count;  ///< The number of feedback value updates.
+};
+
+/**
+ * @brief A consistent snapshot of all audio statistics.
+ */
+struct audio_stats {
+    struct audio_stats_usb      usb;       ///< The statistics from the USB interrupt context.
+    struct audio_stats_feedback feedback;  ///< The statistics from the feedback timer interrupt context.
+};
+
+void audio_stats_record_received_packet(void);
+void audio_stats_record_failed_transaction(void);
+void audio_stats_record_forced_correction(size_t correction_bytes);
+void audio_stats_record_playback_start(void);
+void audio_stats_record_playback_stop(void);
+void audio_stats_record_fill_size(size_t fill_size, size_t buffer_size);
+void audio_stats_record_feedback_update(void);
+
+void audio_stats_get(struct audio_stats *p_stats);
+
+#endif  // SOURCE_AUDIO_AUDIO_STATS_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,116 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio TDM module.
+ * @details Routes the channels of the received audio stream to the slots of the TDM output. Each I2S frame of two
+ * 32 bit data words holds \a AUDIO_TDM_SLOT_COUNT slots of 16 bit. The I2S peripheral transmits the first half-word of
+ * a data word first, so that the 16 bit samples of a USB frame arrive in the audio buffer in slot order already. Only
+ * a mapping other than the identity \a AUDIO_TDM_SLOT_MAP requires moving samples.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_tdm.h"
+
+#if AUDIO_TDM_ENABLE
+
+/**
+ * @brief The TDM slot of every USB channel.
+ */
+static const uint8_t g_audio_tdm_slot_map[AUDIO_CHANNEL_COUNT] = AUDIO_TDM_SLOT_MAP;
+
+/**
+ * @brief A structure that holds the state of the TDM module.
+ */
+static struct audio_tdm {
+    bool b_is_identity;  ///< True, if every USB channel is transmitted on the slot with its own index.
+} g_tdm;
+
+/**
+ * @brief Get the TDM slot, on which a USB channel is transmitted.
+ *
+ * @param channel_index The index of the USB channel.
+ * @return uint8_t The TDM slot index.
+ */
+uint8_t audio_tdm_get_slot_index(size_t channel_index) {
+    chDbgAssert(channel_index < AUDIO_CHANNEL_COUNT, "Invalid audio channel.");
+    return g_audio_tdm_slot_map[channel_index];
+}
+
+/**
+ * @brief Move the samples of a contiguous block of audio frames to their TDM slots.
+ *
+ * @param p_samples The pointer to the samples, in the USB channel order.
+ * @param frame_count The number of frames to process.
+ */
+static void audio_tdm_remap(uint8_t *p_samples, size_t frame_count) {
+    int16_t *p_frame = (int16_t *)p_samples;
+
+    for (size_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        int16_t channel_samples[AUDIO_CHANNEL_COUNT];
+
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            channel_samples[channel_index] = p_frame[channel_index];
+        }
+
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            p_frame[g_audio_tdm_slot_map[channel_index]] = channel_samples[channel_index];
+        }
+
+        p_frame += AUDIO_CHANNEL_COUNT;
+    }
+}
+
+/**
+ * @brief Route a received packet in the circular audio buffer to the TDM slots.
+ *
+ * @param p_buffer The pointer to the audio buffer.
+ * @param offset The offset of the packet in the audio buffer, in bytes.
+ * @param size The size of the packet in bytes.
+ * @param buffer_size The size of the audio buffer in bytes, at which the packet wraps around.
+ */
+void audio_tdm_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size) {
+    chDbgCheckClassI();
+
+    if (g_tdm.b_is_identity) {
+        return;
+    }
+
+    // The part of the packet, which is located before the end of the audio buffer.
+    size_t leading_size = buffer_size - offset;
+
+    if (leading_size > size) {
+        leading_size = size;
+    }
+
+    audio_tdm_remap(&p_buffer[offset], leading_size / AUDIO_FRAME_SIZE);
+    audio_tdm_remap(p_buffer, (size - leading_size) / AUDIO_FRAME_SIZE);
+}
+
+/**
+ * @brief Initialize the TDM module, and check the slot mapping.
+ */
+void audio_tdm_init(void) {
+    chDbgCheckClassI();
+
+    uint32_t slot_mask  = 0u;
+    g_tdm.b_is_identity = true;
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        uint8_t slot_index = g_audio_tdm_slot_map[channel_index];
+        chDbgAssert(slot_index < AUDIO_TDM_SLOT_COUNT, "Invalid TDM slot index.");
+
+        slot_mask           |= 1u << slot_index;
+        g_tdm.b_is_identity  = g_tdm.b_is_identity && (slot_index == channel_index);
+    }
+
+    chDbgAssert(slot_mask == ((1u << AUDIO_TDM_SLOT_COUNT) - 1u), "Every TDM slot must be assigned exactly once.");
+}
+
+#endif
+
+/**
+ * @}
+ */
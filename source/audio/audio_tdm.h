@@ -0,0 +1,25 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio TDM module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_TDM_H_
+#define SOURCE_AUDIO_AUDIO_TDM_H_
+
+#include "audio_common.h"
+
+uint8_t audio_tdm_get_slot_index(size_t channel_index);
+void    audio_tdm_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size);
+
+void audio_tdm_init(void);
+
+#endif  // SOURCE_AUDIO_AUDIO_TDM_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,198 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio volume module.
+ * @details Contains a digital volume and mute stage, which scales received audio samples in the audio buffer. Gain
+ * changes are ramped linearly over the duration of a packet, in order to avoid zipper noise. This is an alternative to
+ * setting the volume via the amplifiers, and reacts to volume and mute requests with the very next packet.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#include "audio_volume.h"
+
+/**
+ * @brief The number of entries in the gain table, one per dB of attenuation.
+ */
+#define AUDIO_VOLUME_GAIN_COUNT ((AUDIO_MAX_VOLUME_DB - AUDIO_MIN_VOLUME_DB) + 1)
+
+/**
+ * @brief The gain that leaves audio samples unchanged, in 1.31 fixpoint format.
+ */
+#define AUDIO_VOLUME_UNITY_GAIN INT32_MAX
+
+/**
+ * @brief Linear gains in 1.31 fixpoint format, indexed by the attenuation in dB from \a AUDIO_MAX_VOLUME_DB .
+ * @details Precomputed as round(2^31 * 10^(-index / 20)), and clamped to \a AUDIO_VOLUME_UNITY_GAIN .
+ */
+static const int32_t g_audio_volume_gains[AUDIO_VOLUME_GAIN_COUNT] = {
+    0x7FFFFFFF, 0x721482C0, 0x65AC8C2F, 0x5A9DF7AC, 0x50C335D4, 0x47FACCF0,
+    0x4026E73D, 0x392CED8E, 0x32F52CFF, 0x2D6A866F, 0x287A26C5, 0x241346F6,
+    0x2026F310, 0x1CA7D768, 0x198A1357, 0x16C310E3, 0x144960C5, 0x12149A60,
+    0x101D3F2E, 0x0E5CA14C, 0x0CCCCCCD, 0x0B68737A, 0x0A2ADAD2, 0x090FCBF8,
+    0x08138562, 0x0732AE18, 0x066A4A53, 0x05B7B15B, 0x05188480, 0x048AA70B,
+    0x040C3714, 0x039B8719, 0x0337184E, 0x02DD958A, 0x028DCEBC, 0x0246B4E4,
+    0x0207567A, 0x01CEDC3D, 0x019C8651, 0x016FA9BB, 0x0147AE14, 0x01240B8C,
+    0x01044915, 0x00E7FACC, 0x00CEC08A, 0x00B8449C, 0x00A43AA2, 0x00925E89,
+    0x008273A6, 0x007443E8, 0x00679F1C, 0x005C5A4F, 0x00524F3B, 0x00495BC1,
+    0x00416179, 0x003A454A, 0x0033EF0C, 0x002E4939, 0x002940A2, 0x0024C42C,
+    0x0020C49C, 0x001D345B, 0x001A074F, 0x001732AE, 0x0014ACDB, 0x00126D43,
+    0x00106C43, 0x000EA30E, 0x000D0B91, 0x000BA064, 0x000A5CB6, 0x00093C3B,
+    0x00083B20, 0x000755FA, 0x000689BF, 0x0005D3BB, 0x00053181, 0x0004A0EC,
+    0x00042010, 0x0003AD38, 0x000346DC, 0x0002EBA3, 0x00029A55, 0x000251DE,
+    0x00021149, 0x0001D7BA, 0x0001A46D, 0x000176B5, 0x00014DF5, 0x000129A4,
+    0x00010945, 0x0000EC6C, 0x0000D2B6, 0x0000BBCC, 0x0000A760, 0x0000952C,
+    0x000084F3, 0x0000767E, 0x0000699B, 0x00005E1F, 0x000053E3,
+};
+
+/**
+ * @brief A structure that holds the state of the volume stage.
+ */
+static struct audio_volume {
+    int32_t target_gains[AUDIO_CHANNEL_COUNT];  ///< The gains to reach at the end of the next packet, in 1.31 format.
+    int32_t gains[AUDIO_CHANNEL_COUNT];         ///< The current gains, in 1.31 format.
+    int32_t gain_steps[AUDIO_CHANNEL_COUNT];    ///< The gain increments per frame, while ramping.
+} g_volume;
+
+/**
+ * @brief Convert a volume level to a linear gain.
+ * @details The volume level is rounded to full dB. Levels below \a AUDIO_MIN_VOLUME_DB are silent.
+ *
+ * @param volume_8q8_db The volume level in 8.8 signed binary fixpoint format (in dB).
+ * @return int32_t The gain in 1.31 fixpoint format.
+ */
+static int32_t audio_volume_get_gain(int16_t volume_8q8_db) {
+    int32_t attenuation_8q8_db = (AUDIO_MAX_VOLUME_DB * AUDIO_VOLUME_INCREMENT_STEPS) - (int32_t)volume_8q8_db;
+
+    if (attenuation_8q8_db <= 0) {
+        return AUDIO_VOLUME_UNITY_GAIN;
+    }
+
+    size_t gain_index =
+        ((size_t)attenuation_8q8_db + AUDIO_VOLUME_INCREMENT_STEPS / 2u) / (size_t)AUDIO_VOLUME_INCREMENT_STEPS;
+
+    if (gain_index >= (size_t)AUDIO_VOLUME_GAIN_COUNT) {
+        return 0;
+    }
+
+    return g_audio_volume_gains[gain_index];
+}
+
+/**
+ * @brief Set the volume level and mute state of an audio channel.
+ * @details Takes effect with the next processed packet.
+ *
+ * @param audio_channel The audio channel to set.
+ * @param volume_8q8_db The volume level in 8.8 signed binary fixpoint format (in dB).
+ * @param b_is_muted True, if the channel is muted.
+ */
+void audio_volume_set_channel(enum audio_common_channel audio_channel, int16_t volume_8q8_db, bool b_is_muted) {
+    chDbgCheckClassI();
+    chDbgAssert((size_t)audio_channel < AUDIO_CHANNEL_COUNT, "Invalid audio channel.");
+
+    g_volume.target_gains[audio_channel] = b_is_muted ? 0 : audio_volume_get_gain(volume_8q8_db);
+}
+
+/**
+ * @brief Apply the current gains to a contiguous block of audio frames, ramping them by their increments.
+ * @details The product with the gain is calculated by means of the DSP instruction \a SMMUL (most significant word
+ * multiply). As gains are at most unity, the result cannot overflow, and does not have to be saturated.
+ *
+ * @param p_samples The pointer to the samples, in the format that the I2S DMA expects.
+ * @param frame_count The number of frames to process.
+ */
+static void audio_volume_apply(uint8_t *p_samples, size_t frame_count) {
+    for (size_t frame_index = 0; frame_index < frame_count; frame_index++) {
+        for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+            const size_t SAMPLE_INDEX = frame_index * AUDIO_CHANNEL_COUNT + channel_index;
+            int32_t      gain         = g_volume.gains[channel_index] + g_volume.gain_steps[channel_index];
+
+            g_volume.gains[channel_index] = gain;
+
+#if AUDIO_RESOLUTION_BIT == 16u
+            int16_t *p_sample = &((int16_t *)p_samples)[SAMPLE_INDEX];
+
+            // The sample is aligned to bit 31, so that the upper word of the product holds the scaled sample. Shifts
+            // are performed on unsigned values, as left-shifting negative signed values is undefined.
+            int32_t sample = (int32_t)((uint32_t)(uint16_t)*p_sample << 16u);
+            *p_sample      = (int16_t)(__SMMUL(sample, gain) >> 15u);
+#elif AUDIO_RESOLUTION_BIT == 32u
+            uint32_t *p_sample = &((uint32_t *)p_samples)[SAMPLE_INDEX];
+
+            // Samples in the audio buffer have swapped half-words.
+            int32_t sample = (int32_t)SWAP_HALF_WORDS(*p_sample);
+            *p_sample      = SWAP_HALF_WORDS((uint32_t)__SMMUL(sample, gain) << 1u);
+#endif
+        }
+    }
+}
+
+/**
+ * @brief Apply the volume stage to a received packet in the circular audio buffer.
+ * @details The gains ramp from their current values to their targets over the duration of the packet. If all channels
+ * are at unity gain, the samples are left untouched, so that playback at full volume is bit-perfect.
+ *
+ * @param p_buffer The pointer to the audio buffer.
+ * @param offset The offset of the packet in the audio buffer, in bytes.
+ * @param size The size of the packet in bytes.
+ * @param buffer_size The size of the audio buffer in bytes, at which the packet wraps around.
+ */
+void audio_volume_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size) {
+    chDbgCheckClassI();
+
+    size_t frame_count = size / AUDIO_FRAME_SIZE;
+
+    if (frame_count == 0u) {
+        return;
+    }
+
+    bool b_is_unity = true;
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        int32_t gain        = g_volume.gains[channel_index];
+        int32_t target_gain = g_volume.target_gains[channel_index];
+
+        g_volume.gain_steps[channel_index] =
+            (int32_t)(((int64_t)target_gain - (int64_t)gain) / (int64_t)frame_count);
+
+        b_is_unity = b_is_unity && (gain == AUDIO_VOLUME_UNITY_GAIN) && (target_gain == AUDIO_VOLUME_UNITY_GAIN);
+    }
+
+    if (b_is_unity) {
+        return;
+    }
+
+    // The part of the packet, which is located before the end of the audio buffer.
+    size_t leading_size = buffer_size - offset;
+
+    if (leading_size > size) {
+        leading_size = size;
+    }
+
+    audio_volume_apply(&p_buffer[offset], leading_size / AUDIO_FRAME_SIZE);
+    audio_volume_apply(p_buffer, (size - leading_size) / AUDIO_FRAME_SIZE);
+
+    // Remove the rounding error of the gain increments.
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        g_volume.gains[channel_index] = g_volume.target_gains[channel_index];
+    }
+}
+
+/**
+ * @brief Initialize the volume stage at unity gain.
+ */
+void audio_volume_init(void) {
+    chDbgCheckClassI();
+
+    for (size_t channel_index = 0; channel_index < AUDIO_CHANNEL_COUNT; channel_index++) {
+        g_volume.target_gains[channel_index] = AUDIO_VOLUME_UNITY_GAIN;
+        g_volume.gains[channel_index]        = AUDIO_VOLUME_UNITY_GAIN;
+        g_volume.gain_steps[channel_index]   = 0;
+    }
+}
+
+/**
+ * @}
+ */
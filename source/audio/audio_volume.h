@@ -0,0 +1,25 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Audio volume module headers.
+ *
+ * @addtogroup audio
+ * @{
+ */
+
+#ifndef SOURCE_AUDIO_AUDIO_VOLUME_H_
+#define SOURCE_AUDIO_AUDIO_VOLUME_H_
+
+#include "audio_common.h"
+
+void audio_volume_set_channel(enum audio_common_channel audio_channel, int16_t volume_8q8_db, bool b_is_muted);
+void audio_volume_process(uint8_t *p_buffer, size_t offset, size_t size, size_t buffer_size);
+
+void audio_volume_init(void);
+
+#endif  // SOURCE_AUDIO_AUDIO_VOLUME_H_
+
+/**
+ * @}
+ */
@@ -29,17 +29,21 @@ void tas2780_acquire_lock(void) { chBSemWait(&g_bsem); }
  */
 void tas2780_release_lock(void) { chBSemSignal(&g_bsem); }
 
-/**
- * @brief Initialize the TAS2780 module.
- */
-void tas2780_init(void) { chBSemObjectInit(&g_bsem, false); }
-
 /**
  * @brief All amplifier contexts.
  * @details Will be set up with settings from \a tas2780_settings.h .
  */
 static struct tas2780_context g_tas2780_contexts[TAS2780_DEVICE_COUNT];
 
+/**
+ * @brief The queue of register writes and fault events, which the TAS2780 thread handles asynchronously.
+ */
+static struct tas2780_queue {
+    struct tas2780_queue_entry entries[TAS2780_DEVICE_COUNT][TAS2780_QUEUE_LENGTH];  ///< Queued writes per device.
+    binary_semaphore_t         bsem;             ///< Signals queued writes and fault events.
+    bool                       b_fault_pending;  ///< True, if IRQZ signalled a fault that was not handled yet.
+} g_tas2780_queue;
+
 /**
  * @brief Initialize a TAS2780 amplifier context.
  *
@@ -57,6 +61,7 @@ static void tas2780_init_context(struct tas2780_context *p_context, enum tas2780
     p_context->channel        = channel;
     p_context->device_address = device_address;
     p_context->tdm_slot_index = tdm_slot_index;
+    p_context->volume         = TAS2780_VOLUME_MAX;
     p_context->book_index     = TAS2780_DEFAULT_BOOK_INDEX;
     p_context->page_index     = TAS2780_DEFAULT_PAGE_INDEX;
 }
@@ -102,27 +107,17 @@ static void tas2780_write(struct tas2780_context *p_context, uint8_t *p_write_bu
 }
 
 /**
- * @brief Write a value to a register.
+ * @brief Write a value to the register at an address on the active page, without any tracking.
  *
  * @param p_context The pointer to the amplifier context.
  * @param register_address The address to write to.
  * @param value The value to write.
  */
-static void tas2780_write_register(struct tas2780_context *p_context, uint8_t register_address, uint8_t value) {
-    if (register_address == TAS2780_PAGE_REG) {
-        // Record the new page index.
-        p_context->page_index = value;
-    } else if (register_address == TAS2780_BOOK_REG) {
-        // Record the new book index.
-        p_context->book_index = value;
-    }
-
-    // FIXME: Add a check for the correct book and page indices and change automatically.
-
+static void tas2780_write_raw(struct tas2780_context *p_context, uint8_t register_address, uint8_t value) {
     uint8_t *p_write_buffer = p_context->write_buffer;
     p_write_buffer[0u]      = register_address;
     p_write_buffer[1u]      = value;
-    tas2780_write(p_context, p_write_buffer, TAS2780_BUFFER_LENGTH);
+    tas2780_write(p_context, p_write_buffer, 2u);
 }
 
 /**
@@ -132,115 +127,403 @@ static void tas2780_write_register(struct tas2780_context *p_context, uint8_t re
  * @param page_index The page to change to.
  */
 static void tas2780_set_page(struct tas2780_context *p_context, uint8_t page_index) {
-    tas2780_write_register(p_context, TAS2780_PAGE_REG, page_index);
+    tas2780_write_raw(p_context, TAS2780_PAGE_REG, page_index);
+    p_context->page_index = page_index;
 }
 
 /**
  * @brief Change the amplifier's active book.
+ * @details The book register is located on page 0 of every book. Changing the book leaves the device on page 0.
  *
  * @param p_context The pointer to the amplifier context.
- * @param page_index The book to change to.
+ * @param book_index The book to change to.
  */
 static void tas2780_set_book(struct tas2780_context *p_context, uint8_t book_index) {
-    tas2780_write_register(p_context, TAS2780_BOOK_REG, book_index);
+    if (p_context->page_index != TAS2780_BOOK_PAGE) {
+        tas2780_set_page(p_context, TAS2780_BOOK_PAGE);
+    }
+
+    tas2780_write_raw(p_context, TAS2780_BOOK_REG, book_index);
+    p_context->book_index = book_index;
 }
 
 /**
- * @brief Set the volume on a single TAS2780 amplifier.
+ * @brief Select a book and page on an amplifier, if it is not already set to them.
  *
  * @param p_context The pointer to the amplifier context.
- * @param volume_8q8_db The volume to set in 8.8 signed binary fixpoint format.
+ * @param book_index The book to change to.
+ * @param page_index The page to change to.
  */
-static void tas2780_set_volume(struct tas2780_context *p_context, int16_t volume_8q8_db) {
-    tas2780_write_register(p_context, TAS2780_DVC_REG, TAS2780_VOLUME_FROM_8Q8_DB(volume_8q8_db));
+static void tas2780_select_book_and_page(struct tas2780_context *p_context, uint8_t book_index, uint8_t page_index) {
+    if (p_context->book_index != book_index) {
+        tas2780_set_book(p_context, book_index);
+    }
+
+    if (p_context->page_index != page_index) {
+        tas2780_set_page(p_context, page_index);
+    }
 }
 
 /**
- * @brief Perform a soft reset of a TAS2780 amplifier.
+ * @brief Determine, whether or not a register changes its value without being written by the host.
+ * @details Volatile registers are never served from the register cache.
+ *
+ * @param book_index The book, in which the register is located.
+ * @param page_index The page, on which the register is located.
+ * @param register_address The register address.
+ * @return true if the register is volatile.
+ * @return false if the register only changes when written.
+ */
+static bool tas2780_register_is_volatile(uint8_t book_index, uint8_t page_index, uint8_t register_address) {
+    if ((book_index != TAS2780_DEFAULT_BOOK_INDEX) || (page_index != TAS2780_DEFAULT_PAGE_INDEX)) {
+        return false;
+    }
+
+    switch (register_address) {
+        case TAS2780_SW_RESET_REG:
+        case TAS2780_MODE_CTRL_REG:
+        case TAS2780_INT_CLK_CFG_REG:
+            // The software reset and interrupt clear bits clear themselves.
+            // The device leaves the active mode on faults.
+            return true;
+
+        default:
+            return ((register_address >= TAS2780_INT_STATUS_FIRST_REG) &&
+                    (register_address <= TAS2780_INT_STATUS_LAST_REG)) ||
+                   ((register_address >= TAS2780_MEASUREMENT_FIRST_REG) &&
+                    (register_address <= TAS2780_MEASUREMENT_LAST_REG));
+    }
+}
+
+/**
+ * @brief Get the register cache slot for a register.
+ * @details Only book 0 is cached, and only the pages that are used by this module. Page and book selection registers
+ * are tracked by the context instead.
+ *
+ * @param book_index The book, in which the register is located.
+ * @param page_index The page, on which the register is located.
+ * @param register_address The register address.
+ * @return size_t The index of the slot in the register cache, or \a TAS2780_CACHE_SIZE, if the register is not cached.
+ */
+static size_t tas2780_get_cache_index(uint8_t book_index, uint8_t page_index, uint8_t register_address) {
+    if ((book_index != TAS2780_DEFAULT_BOOK_INDEX) || (page_index >= TAS2780_CACHE_PAGE_COUNT) ||
+        (register_address >= TAS2780_PAGE_SIZE) || (register_address == TAS2780_PAGE_REG) ||
+        ((page_index == TAS2780_BOOK_PAGE) && (register_address == TAS2780_BOOK_REG)) ||
+        tas2780_register_is_volatile(book_index, page_index, register_address)) {
+        return TAS2780_CACHE_SIZE;
+    }
+
+    return (size_t)page_index * TAS2780_PAGE_SIZE + register_address;
+}
+
+/**
+ * @brief Get a register value from the register cache.
  *
  * @param p_context The pointer to the amplifier context.
+ * @param cache_index The index of the slot in the register cache.
+ * @param p_value The pointer to the value that is read from the cache.
+ * @return true if the cache holds a valid value for the register.
+ * @return false if the register is not cached, or its value is unknown.
  */
-static void tas2780_reset(struct tas2780_context *p_context) {
-    // FIXME: Use the updated reset procedure (datasheet, p. 84).
+static bool tas2780_cache_lookup(struct tas2780_context *p_context, size_t cache_index, uint8_t *p_value) {
+    if (cache_index >= TAS2780_CACHE_SIZE) {
+        return false;
+    }
 
-    // Go to page 0.
-    tas2780_set_page(p_context, TAS2780_DEFAULT_PAGE_INDEX);
+    if ((p_context->cache_valid_masks[cache_index / 32u] & (1u << (cache_index % 32u))) == 0u) {
+        return false;
+    }
 
-    // Go to book 0.
-    tas2780_set_book(p_context, TAS2780_DEFAULT_BOOK_INDEX);
+    *p_value = p_context->cache[cache_index];
+    return true;
+}
 
-    // Perform software reset.
-    tas2780_write_register(p_context, TAS2780_SW_RESET_REG,
-                           (0x01u << TAS2780_SW_RESET_SW_RESET_POS) & TAS2780_SW_RESET_SW_RESET_MASK);
+/**
+ * @brief Store a register value in the register cache.
+ *
+ * @param p_context The pointer to the amplifier context.
+ * @param cache_index The index of the slot in the register cache. Uncached registers are ignored.
+ * @param value The value to store.
+ */
+static void tas2780_cache_store(struct tas2780_context *p_context, size_t cache_index, uint8_t value) {
+    if (cache_index >= TAS2780_CACHE_SIZE) {
+        return;
+    }
 
-    // Wait for the device to start up.
-    osalThreadSleepMilliseconds(1);
+    p_context->cache[cache_index]                   = value;
+    p_context->cache_valid_masks[cache_index / 32u] |= (1u << (cache_index % 32u));
+}
+
+/**
+ * @brief Mark all cached register values as unknown, e.g. after a reset.
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_cache_invalidate(struct tas2780_context *p_context) {
+    for (size_t mask_index = 0; mask_index < ARRAY_LENGTH(p_context->cache_valid_masks); mask_index++) {
+        p_context->cache_valid_masks[mask_index] = 0u;
+    }
+}
+
+/**
+ * @brief Write values to consecutive registers, in a single auto-increment transaction.
+ * @details Changes the book and page, if the registers are located elsewhere. The write is dropped, if the register
+ * cache shows that all registers already hold their values.
+ *
+ * @param p_context The pointer to the amplifier context.
+ * @param book_index The book, in which the registers are located.
+ * @param page_index The page, on which the registers are located.
+ * @param start_register_address The address of the first register to write to.
+ * @param p_values The pointer to the values to write.
+ * @param value_count The number of values to write, up to \a TAS2780_BURST_LENGTH_MAX .
+ */
+static void tas2780_write_registers(struct tas2780_context *p_context, uint8_t book_index, uint8_t page_index,
+                                    uint8_t start_register_address, const uint8_t *p_values, size_t value_count) {
+    chDbgAssert((value_count > 0u) && (value_count <= TAS2780_BURST_LENGTH_MAX), "Invalid burst length.");
+    chDbgAssert((start_register_address + value_count) <= TAS2780_PAGE_SIZE, "Burst exceeds the page.");
+    chDbgAssert(start_register_address != TAS2780_PAGE_REG, "Page selection is automatic.");
+    chDbgAssert((page_index != TAS2780_BOOK_PAGE) || ((start_register_address + value_count) <= TAS2780_BOOK_REG),
+                "Book selection is automatic.");
+
+    bool b_is_cached = true;
+
+    for (size_t value_index = 0; value_index < value_count; value_index++) {
+        size_t  cache_index = tas2780_get_cache_index(book_index, page_index, start_register_address + value_index);
+        uint8_t cached_value;
+
+        if (!tas2780_cache_lookup(p_context, cache_index, &cached_value) || (cached_value != p_values[value_index])) {
+            b_is_cached = false;
+            break;
+        }
+    }
+
+    if (b_is_cached) {
+        return;
+    }
+
+    tas2780_select_book_and_page(p_context, book_index, page_index);
+
+    uint8_t *p_write_buffer = p_context->write_buffer;
+    p_write_buffer[0u]      = start_register_address;
+
+    for (size_t value_index = 0; value_index < value_count; value_index++) {
+        p_write_buffer[1u + value_index] = p_values[value_index];
+        tas2780_cache_store(p_context,
+                            tas2780_get_cache_index(book_index, page_index, start_register_address + value_index),
+                            p_values[value_index]);
+    }
+
+    tas2780_write(p_context, p_write_buffer, 1u + value_count);
 }
 
 /**
- * @brief Set up a single TAS2780 amplifier with default values.
+ * @brief Write a value to a register.
+ * @details See \a tas2780_write_registers .
  *
  * @param p_context The pointer to the amplifier context.
+ * @param book_index The book, in which the register is located.
+ * @param page_index The page, on which the register is located.
+ * @param register_address The address to write to.
+ * @param value The value to write.
  */
-static void tas2780_setup(struct tas2780_context *p_context) {
-    tas2780_reset(p_context);
+static void tas2780_write_register(struct tas2780_context *p_context, uint8_t book_index, uint8_t page_index,
+                                   uint8_t register_address, uint8_t value) {
+    tas2780_write_registers(p_context, book_index, page_index, register_address, &value, 1u);
+}
 
-    // Go to page 1.
-    tas2780_set_page(p_context, 1u);
+/**
+ * @brief Read a value from a register.
+ * @details Non-volatile registers with known values are read from the register cache, without bus access.
+ *
+ * @param p_context The pointer to the amplifier context.
+ * @param book_index The book, in which the register is located.
+ * @param page_index The page, on which the register is located.
+ * @param register_address The address to read from.
+ * @return uint8_t The register value.
+ */
+static uint8_t tas2780_read_register(struct tas2780_context *p_context, uint8_t book_index, uint8_t page_index,
+                                     uint8_t register_address) {
+    size_t  cache_index = tas2780_get_cache_index(book_index, page_index, register_address);
+    uint8_t value;
+
+    if (tas2780_cache_lookup(p_context, cache_index, &value)) {
+        return value;
+    }
+
+    tas2780_select_book_and_page(p_context, book_index, page_index);
+
+    uint8_t *p_write_buffer = p_context->write_buffer;
+    uint8_t *p_read_buffer  = p_context->read_buffer;
 
+    p_write_buffer[0] = register_address;
+    tas2780_write(p_context, p_write_buffer, 1u);
+    tas2780_read(p_context, p_read_buffer, 1u);
+
+    value = p_read_buffer[0];
+    tas2780_cache_store(p_context, cache_index, value);
+
+    return value;
+}
+
+/**
+ * @brief Queue a register write for an amplifier, without blocking.
+ * @details If a write to the same register is still pending, its value is replaced (latest value wins). The write is
+ * performed by the TAS2780 thread. Queued registers must be located in the default book.
+ *
+ * @param device_index The index of the amplifier.
+ * @param page_index The page, on which the register is located.
+ * @param register_address The register address.
+ * @param value The value to write.
+ */
+static void tas2780_queue_write_register(size_t device_index, uint8_t page_index, uint8_t register_address,
+                                         uint8_t value) {
+    struct tas2780_queue_entry *p_entries    = g_tas2780_queue.entries[device_index];
+    struct tas2780_queue_entry *p_free_entry = NULL;
+
+    chSysLock();
+    for (size_t entry_index = 0; entry_index < TAS2780_QUEUE_LENGTH; entry_index++) {
+        struct tas2780_queue_entry *p_entry = &p_entries[entry_index];
+
+        if (!p_entry->b_pending) {
+            if (p_free_entry == NULL) {
+                p_free_entry = p_entry;
+            }
+        } else if ((p_entry->page_index == page_index) && (p_entry->register_address == register_address)) {
+            // Coalesce with the pending write.
+            p_free_entry = p_entry;
+            break;
+        }
+    }
+
+    chDbgAssert(p_free_entry != NULL, "TAS2780 queue is full.");
+
+    p_free_entry->page_index       = page_index;
+    p_free_entry->register_address = register_address;
+    p_free_entry->value            = value;
+    p_free_entry->b_pending        = true;
+
+    chBSemSignalI(&g_tas2780_queue.bsem);
+    chSchRescheduleS();
+    chSysUnlock();
+}
+
+/**
+ * @brief Perform all queued register writes of an amplifier.
+ * @details Entries are taken from the queue one at a time, so that new values can be queued while the bus is busy.
+ *
+ * @param device_index The index of the amplifier.
+ */
+static void tas2780_process_queue(size_t device_index) {
+    struct tas2780_context     *p_context = &g_tas2780_contexts[device_index];
+    struct tas2780_queue_entry *p_entries = g_tas2780_queue.entries[device_index];
+
+    for (size_t entry_index = 0; entry_index < TAS2780_QUEUE_LENGTH; entry_index++) {
+        chSysLock();
+        struct tas2780_queue_entry entry = p_entries[entry_index];
+        p_entries[entry_index].b_pending = false;
+        chSysUnlock();
+
+        if (!entry.b_pending) {
+            continue;
+        }
+
+        tas2780_write_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, entry.page_index, entry.register_address,
+                               entry.value);
+    }
+}
+
+/**
+ * @brief The initialization sequence that is shared by all amplifiers.
+ * @details Entries are sorted by book and page, so that every amplifier changes pages as few times as possible.
+ */
+static const struct tas2780_init_entry g_tas2780_init_sequence[] = {
     // undocumented
     // SARBurstMask = 0
-    tas2780_write_register(p_context, 0x17u, 0xC0u);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_PAGE_1_INDEX, 0x17u, 1u, {0xC0u}},
 
-    tas2780_write_register(p_context, TAS2780_LSR_REG, (0x01u << TAS2780_LSR_EN_LLSR_POS) & TAS2780_LSR_EN_LLSR_MASK);
+    {TAS2780_DEFAULT_BOOK_INDEX,
+     TAS2780_PAGE_1_INDEX,
+     TAS2780_LSR_REG,
+     1u,
+     {(0x01u << TAS2780_LSR_EN_LLSR_POS) & TAS2780_LSR_EN_LLSR_MASK}},
 
     // undocumented
     // Disable comparator hysteresis
-    tas2780_write_register(p_context, 0x21u, 0x00u);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_PAGE_1_INDEX, 0x21u, 1u, {0x00u}},
 
     // undocumented
     // Noise minimized
-    tas2780_write_register(p_context, 0x35u, 0x74u);
-
-    // Go to page 0xFD.
-    tas2780_set_page(p_context, 0xFDu);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_PAGE_1_INDEX, 0x35u, 1u, {0x74u}},
 
     // undocumented
     // Allow access to page 0xFD
-    tas2780_write_register(p_context, 0x0Du, 0x0Du);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_TEST_PAGE_INDEX, 0x0Du, 1u, {0x0Du}},
 
     // undocumented
     // Optimal Dmin setting
-    tas2780_write_register(p_context, 0x3Eu, 0x4Au);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_TEST_PAGE_INDEX, 0x3Eu, 1u, {0x4Au}},
 
     // undocumented
     // Remove access to page 0xFD
-    tas2780_write_register(p_context, 0x0Du, 0x00u);
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_TEST_PAGE_INDEX, 0x0Du, 1u, {0x00u}},
 
-    // Go to page 0.
-    tas2780_set_page(p_context, TAS2780_DEFAULT_PAGE_INDEX);
+    // Set up the noise gate.
+    {TAS2780_DEFAULT_BOOK_INDEX,
+     TAS2780_DEFAULT_PAGE_INDEX,
+     TAS2780_NG_CFG0_REG,
+     1u,
+     {((TAS2780_NG_CFG0_RES_DEFAULT << TAS2780_NG_CFG0_RES_POS) & TAS2780_NG_CFG0_RES_MASK) |
+      ((TAS2780_NG_CFG0_NG_EN_DEFAULT << TAS2780_NG_CFG0_NG_EN_POS) & TAS2780_NG_CFG0_NG_EN_MASK) |
+      ((TAS2780_NG_CFG0_NG_LVL_DEFAULT << TAS2780_NG_CFG0_NG_LVL_POS) & TAS2780_NG_CFG0_NG_LVL_MASK) |
+      ((TAS2780_NG_CFG0_NG_HYST_DEFAULT << TAS2780_NG_CFG0_NG_HYST_POS) & TAS2780_NG_CFG0_NG_HYST_MASK)}},
 
-    // Set the analog gain of the amplifier.
-    tas2780_write_register(
-        p_context, TAS2780_CHNL_0_REG,
+    // Under-voltage lockout, set to 6.5 V.
+    {TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_PVDD_UVLO_REG, 1u, {0x0Eu}},
+
+    // Only over-temperature and over-current faults assert IRQZ.
+    {TAS2780_DEFAULT_BOOK_INDEX,
+     TAS2780_DEFAULT_PAGE_INDEX,
+     TAS2780_INT_MASK0_REG,
+     1u,
+     {(uint8_t)~(TAS2780_INT_MASK0_OTE_MASK | TAS2780_INT_MASK0_OCE_MASK)}},
+
+    // IRQZ stays asserted, until the latched interrupts are cleared.
+    {TAS2780_DEFAULT_BOOK_INDEX,
+     TAS2780_DEFAULT_PAGE_INDEX,
+     TAS2780_INT_CLK_CFG_REG,
+     1u,
+     {(TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_LATCHED << TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_POS) &
+      TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_MASK}},
+};
+
+/**
+ * @brief Set up the device-specific registers of a single TAS2780 amplifier, and activate it.
+ * @details Must follow the shared initialization sequence \a g_tas2780_init_sequence .
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_setup_device(struct tas2780_context *p_context) {
+    // CHNL_0 and DC_BLK0 are consecutive registers, and written in a single transaction.
+    const uint8_t CHNL_0_DC_BLK0_VALUES[] = {
+        // Set the analog gain of the amplifier.
         ((TAS2780_CHNL_0_CDS_MODE_DEFAULT << TAS2780_CHNL_0_CDS_MODE_POS) & TAS2780_CHNL_0_CDS_MODE_MASK) |
-            ((p_context->analog_gain_setting << TAS2780_CHNL_0_AMP_LEVEL_POS) & TAS2780_CHNL_0_AMP_LEVEL_MASK));
+            ((p_context->analog_gain_setting << TAS2780_CHNL_0_AMP_LEVEL_POS) & TAS2780_CHNL_0_AMP_LEVEL_MASK),
 
-    // Set up "PWR_MODE2".
-    // PVDD is the only supply. VBAT1S is delivered by an internal LDO and used to supply at signals close to idle
-    // channel levels. When audio signal levels crosses -100dBFS (default), Class-D output switches to PVDD.
-    tas2780_write_register(p_context, TAS2780_DC_BLK0_REG,
-                           ((0x01u << TAS2780_DC_BLK0_VBAT1S_MODE_POS) & TAS2780_DC_BLK0_VBAT1S_MODE_MASK) |
-                               ((0x01u << TAS2780_DC_BLK0_AMP_SS_POS) & TAS2780_DC_BLK0_AMP_SS_MASK) |
-                               ((0x01u << TAS2780_DC_BLK0_HPF_FREQ_PB_POS) & TAS2780_DC_BLK0_HPF_FREQ_PB_MASK));
+        // Set up "PWR_MODE2".
+        // PVDD is the only supply. VBAT1S is delivered by an internal LDO and used to supply at signals close to idle
+        // channel levels. When audio signal levels crosses -100dBFS (default), Class-D output switches to PVDD.
+        ((0x01u << TAS2780_DC_BLK0_VBAT1S_MODE_POS) & TAS2780_DC_BLK0_VBAT1S_MODE_MASK) |
+            ((0x01u << TAS2780_DC_BLK0_AMP_SS_POS) & TAS2780_DC_BLK0_AMP_SS_MASK) |
+            ((0x01u << TAS2780_DC_BLK0_HPF_FREQ_PB_POS) & TAS2780_DC_BLK0_HPF_FREQ_PB_MASK),
+    };
 
-    // Under-voltage lockout, set to 6.5 V.
-    tas2780_write_register(p_context, TAS2780_PVDD_UVLO_REG, 0x0Eu);
+    tas2780_write_registers(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_CHNL_0_REG,
+                            CHNL_0_DC_BLK0_VALUES, ARRAY_LENGTH(CHNL_0_DC_BLK0_VALUES));
 
     // The TDM_CFG2 register content - initially without channel information.
     uint8_t tdm_cfg2 =
-        ((TAS2780_TDM_CFG2_RX_SLEN_DEFAULT << TAS2780_TDM_CFG2_RX_SLEN_POS) & TAS2780_TDM_CFG2_RX_SLEN_MASK) |
-        ((TAS2780_TDM_CFG2_RX_WLEN_DEFAULT << TAS2780_TDM_CFG2_RX_WLEN_POS) & TAS2780_TDM_CFG2_RX_WLEN_MASK) |
+        ((TAS2780_TDM_CFG2_RX_SLEN << TAS2780_TDM_CFG2_RX_SLEN_POS) & TAS2780_TDM_CFG2_RX_SLEN_MASK) |
+        ((TAS2780_TDM_CFG2_RX_WLEN << TAS2780_TDM_CFG2_RX_WLEN_POS) & TAS2780_TDM_CFG2_RX_WLEN_MASK) |
         ((TAS2780_TDM_CFG2_RX_SCFG_DEFAULT << TAS2780_TDM_CFG2_RX_SCFG_POS) & TAS2780_TDM_CFG2_RX_SCFG_MASK);
 
     // The TDM_CFG3 register content.
@@ -286,29 +569,243 @@ static void tas2780_setup(struct tas2780_context *p_context) {
     }
 
     // Set up the determined audio channel.
-    tas2780_write_register(p_context, TAS2780_TDM_CFG2_REG, tdm_cfg2);
+    tas2780_write_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_TDM_CFG2_REG,
+                           tdm_cfg2);
 
     // Set up the matching TDM slot.
-    tas2780_write_register(p_context, TAS2780_TDM_CFG3_REG, tdm_cfg3);
-
-    // Set up the noise gate.
-    tas2780_write_register(
-        p_context, TAS2780_NG_CFG0_REG,
-        ((TAS2780_NG_CFG0_RES_DEFAULT << TAS2780_NG_CFG0_RES_POS) & TAS2780_NG_CFG0_RES_MASK) |
-            ((TAS2780_NG_CFG0_NG_EN_DEFAULT << TAS2780_NG_CFG0_NG_EN_POS) & TAS2780_NG_CFG0_NG_EN_MASK) |
-            ((TAS2780_NG_CFG0_NG_LVL_DEFAULT << TAS2780_NG_CFG0_NG_LVL_POS) & TAS2780_NG_CFG0_NG_LVL_MASK) |
-            ((TAS2780_NG_CFG0_NG_HYST_DEFAULT << TAS2780_NG_CFG0_NG_HYST_POS) & TAS2780_NG_CFG0_NG_HYST_MASK));
+    tas2780_write_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_TDM_CFG3_REG,
+                           tdm_cfg3);
 
     // Enable active mode without mute.
     tas2780_write_register(
-        p_context, TAS2780_MODE_CTRL_REG,
+        p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_MODE_CTRL_REG,
         ((TAS2780_MODE_CTRL_MODE_ACTIVE_WITHOUT_MUTE << TAS2780_MODE_CTRL_MODE_POS) & TAS2780_MODE_CTRL_MODE_MASK));
 }
 
+/**
+ * @brief Restore the configuration of an amplifier, after it lost its register contents.
+ * @details Replays the shared initialization sequence and the device-specific setup, which activates the amplifier, and
+ * restores the latest volume.
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_restore_device(struct tas2780_context *p_context) {
+    // All registers hold their reset values, including the page and book selection.
+    tas2780_cache_invalidate(p_context);
+    tas2780_set_page(p_context, TAS2780_DEFAULT_PAGE_INDEX);
+    tas2780_set_book(p_context, TAS2780_DEFAULT_BOOK_INDEX);
+    p_context->book_index = TAS2780_DEFAULT_BOOK_INDEX;
+    p_context->page_index = TAS2780_DEFAULT_PAGE_INDEX;
+
+    for (size_t entry_index = 0; entry_index < ARRAY_LENGTH(g_tas2780_init_sequence); entry_index++) {
+        const struct tas2780_init_entry *p_entry = &g_tas2780_init_sequence[entry_index];
+
+        tas2780_write_registers(p_context, p_entry->book_index, p_entry->page_index, p_entry->start_register_address,
+                                p_entry->values, p_entry->value_count);
+    }
+
+    tas2780_setup_device(p_context);
+
+    tas2780_write_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_DVC_REG,
+                           p_context->volume);
+}
+
+/**
+ * @brief Check the amplifier state to be active without mute, and enforce it.
+ * @details An amplifier that left the active state was reset, or went through a power-on reset or brown-out, so that
+ * its configuration is restored.
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_ensure_active(struct tas2780_context *p_context) {
+    uint8_t mode_ctrl =
+        tas2780_read_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_MODE_CTRL_REG);
+
+    uint8_t state = (mode_ctrl & TAS2780_MODE_CTRL_MODE_MASK) >> TAS2780_MODE_CTRL_MODE_POS;
+
+    if (state != TAS2780_MODE_CTRL_MODE_ACTIVE_WITHOUT_MUTE) {
+        tas2780_restore_device(p_context);
+    }
+}
+
+/**
+ * @brief Clear all latched interrupts of an amplifier, which releases its IRQZ output.
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_clear_faults(struct tas2780_context *p_context) {
+    tas2780_write_register(
+        p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_INT_CLK_CFG_REG,
+        ((TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_LATCHED << TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_POS) &
+         TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_MASK) |
+            ((0x01u << TAS2780_INT_CLK_CFG_IRQZ_CLR_POS) & TAS2780_INT_CLK_CFG_IRQZ_CLR_MASK));
+}
+
+/**
+ * @brief Handle latched faults of an amplifier.
+ * @details If the amplifier latched an over-temperature or over-current fault, the fault is cleared, and the amplifier
+ * is re-activated. Amplifiers without latched faults are not accessed any further. The register cache is invalidated,
+ * as the fault may have changed the device state.
+ *
+ * @param p_context The pointer to the amplifier context.
+ * @return true if a fault was latched and handled.
+ * @return false if no fault was latched.
+ */
+static bool tas2780_handle_faults(struct tas2780_context *p_context) {
+    uint8_t int_ltch0 =
+        tas2780_read_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_INT_LTCH0_REG);
+
+    if ((int_ltch0 & (TAS2780_INT_MASK0_OTE_MASK | TAS2780_INT_MASK0_OCE_MASK)) == 0u) {
+        return false;
+    }
+
+    tas2780_cache_invalidate(p_context);
+    tas2780_clear_faults(p_context);
+    tas2780_ensure_active(p_context);
+
+    return true;
+}
+
+/**
+ * @brief The IRQZ interrupt callback, which is called on the falling edge of the shared amplifier interrupt line.
+ *
+ * @param arg Unused.
+ */
+static void tas2780_irq_callback(void *arg) {
+    (void)arg;
+
+    chSysLockFromISR();
+    g_tas2780_queue.b_fault_pending = true;
+    chBSemSignalI(&g_tas2780_queue.bsem);
+    chSysUnlockFromISR();
+}
+
+static THD_WORKING_AREA(wa_tas2780_thread, 256u);
+
+/**
+ * @brief A thread that handles amplifier faults, and performs queued register writes.
+ * @details Any number of writes to the same register, which are queued while the thread is busy, result in a single
+ * I2C transaction.
+ */
+static THD_FUNCTION(tas2780_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("tas2780");
+
+    size_t fault_retry_count = 0u;
+
+    while (true) {
+        chBSemWait(&g_tas2780_queue.bsem);
+
+        chSysLock();
+        bool b_fault_pending            = g_tas2780_queue.b_fault_pending;
+        g_tas2780_queue.b_fault_pending = false;
+        chSysUnlock();
+
+        tas2780_acquire_lock();
+        bool b_fault_handled = false;
+        for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
+            if (b_fault_pending && tas2780_handle_faults(&g_tas2780_contexts[device_index])) {
+                // Only the amplifiers with latched faults are re-activated.
+                b_fault_handled = true;
+            }
+
+            tas2780_process_queue(device_index);
+        }
+
+        // IRQZ is shared and edge-triggered. An amplifier that latches a fault while another one holds the line low
+        // causes no new edge, so faults are handled again until the line is released.
+        bool b_fault_retry = false;
+
+        if (b_fault_pending && (palReadLine(LINE_SPK_IRQ) == PAL_LOW)) {
+            if (!b_fault_handled) {
+                // Other latched interrupts hold the line, which are released unconditionally.
+                for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
+                    tas2780_clear_faults(&g_tas2780_contexts[device_index]);
+                }
+            }
+
+            if (fault_retry_count < TAS2780_FAULT_RETRY_COUNT) {
+                fault_retry_count++;
+                b_fault_retry = true;
+            } else {
+                // The fault persists. The slow poll in \a tas2780_ensure_active_all takes over, until the line is
+                // released, and a new edge occurs.
+                fault_retry_count = 0u;
+            }
+        } else if (b_fault_pending) {
+            fault_retry_count = 0u;
+        }
+        tas2780_release_lock();
+
+        if (b_fault_retry) {
+            // Back off, so that a fault which returns right after clearing does not hold the I2C bus.
+            chThdSleepMilliseconds(TAS2780_FAULT_RETRY_DELAY_MS);
+
+            chSysLock();
+            g_tas2780_queue.b_fault_pending = true;
+            chBSemSignalI(&g_tas2780_queue.bsem);
+            chSysUnlock();
+        }
+    }
+}
+
+/**
+ * @brief Initialize the TAS2780 module.
+ * @details Starts the thread that performs queued register writes.
+ */
+void tas2780_init(void) {
+    chBSemObjectInit(&g_bsem, false);
+    chBSemObjectInit(&g_tas2780_queue.bsem, true);
+
+    chThdCreateStatic(wa_tas2780_thread, sizeof(wa_tas2780_thread), NORMALPRIO, tas2780_thread, NULL);
+}
+
+/**
+ * @brief Set the volume on a single TAS2780 amplifier.
+ * @details The write is queued, and performed asynchronously.
+ *
+ * @param device_index The index of the amplifier.
+ * @param volume_8q8_db The volume to set in 8.8 signed binary fixpoint format.
+ */
+static void tas2780_set_volume(size_t device_index, int16_t volume_8q8_db) {
+    const uint8_t VOLUME = TAS2780_VOLUME_FROM_8Q8_DB(volume_8q8_db);
+
+    // Kept for restoring the volume after a reset.
+    g_tas2780_contexts[device_index].volume = VOLUME;
+    tas2780_queue_write_register(device_index, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_DVC_REG, VOLUME);
+}
+
+/**
+ * @brief Perform a soft reset of a TAS2780 amplifier.
+ * @details Does not wait for the device to start up, so that the start-up times of several amplifiers can overlap.
+ *
+ * @param p_context The pointer to the amplifier context.
+ */
+static void tas2780_reset(struct tas2780_context *p_context) {
+    // FIXME: Use the updated reset procedure (datasheet, p. 84).
+
+    // Go to page 0 and book 0 unconditionally, as the device state is unknown.
+    tas2780_set_page(p_context, TAS2780_DEFAULT_PAGE_INDEX);
+    tas2780_set_book(p_context, TAS2780_DEFAULT_BOOK_INDEX);
+
+    // Perform software reset.
+    tas2780_write_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_SW_RESET_REG,
+                           (0x01u << TAS2780_SW_RESET_SW_RESET_POS) & TAS2780_SW_RESET_SW_RESET_MASK);
+
+    // All registers return to their reset values, which are not cached.
+    tas2780_cache_invalidate(p_context);
+    p_context->book_index = TAS2780_DEFAULT_BOOK_INDEX;
+    p_context->page_index = TAS2780_DEFAULT_PAGE_INDEX;
+}
+
 /**
  * @brief Set up all connected TAS2780 amplifiers.
+ * @details All amplifiers are reset first, and share a single start-up delay.
  */
 void tas2780_setup_all(void) {
+    // The amplifier interrupt line toggles during reset.
+    palDisableLineEvent(LINE_SPK_IRQ);
+
     // Common hardware reset for all amplifiers.
     palClearLine(LINE_NSPK_SD);
     chThdSleepMilliseconds(1);
@@ -318,12 +815,35 @@ void tas2780_setup_all(void) {
         tas2780_init_context(&g_tas2780_contexts[device_index], TAS2780_DEVICE_CHANNELS[device_index],
                              TAS2780_DEVICE_ADDRESSES[device_index], TAS2780_TDM_SLOT_INDICES[device_index],
                              TAS2780_CHNL_0_AMP_LEVEL_MIN);
-        tas2780_setup(&g_tas2780_contexts[device_index]);
+        tas2780_reset(&g_tas2780_contexts[device_index]);
     }
+
+    // Wait for all amplifiers to start up at once.
+    osalThreadSleepMilliseconds(1);
+
+    // The shared sequence is interleaved across amplifiers, entry by entry.
+    for (size_t entry_index = 0; entry_index < ARRAY_LENGTH(g_tas2780_init_sequence); entry_index++) {
+        const struct tas2780_init_entry *p_entry = &g_tas2780_init_sequence[entry_index];
+
+        for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
+            tas2780_write_registers(&g_tas2780_contexts[device_index], p_entry->book_index, p_entry->page_index,
+                                    p_entry->start_register_address, p_entry->values, p_entry->value_count);
+        }
+    }
+
+    for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
+        tas2780_setup_device(&g_tas2780_contexts[device_index]);
+    }
+
+    // IRQZ is open-drain and shared by all amplifiers.
+    palEnableLineEvent(LINE_SPK_IRQ, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(LINE_SPK_IRQ, tas2780_irq_callback, NULL);
 }
 
 /**
  * @brief Sets the volume on all connected TAS2780 amplifiers, for a chosen channel.
+ * @details Does not block, and does not require the TAS2780 lock. Writes are queued, and coalesced with pending writes
+ * of earlier volume levels.
  *
  * @param volume_8q8_db The volume to set in 8.8 signed binary fixpoint format.
  * @param channel The channel to set the volume for.
@@ -335,40 +855,40 @@ void tas2780_set_volume_all(int16_t volume_8q8_db, enum tas2780_channel channel)
         if (((p_context->channel == TAS2780_CHANNEL_LEFT) && (channel == TAS2780_CHANNEL_LEFT)) ||
             ((p_context->channel == TAS2780_CHANNEL_RIGHT) && (channel == TAS2780_CHANNEL_RIGHT)) ||
             (channel == TAS2780_CHANNEL_BOTH)) {
-            tas2780_set_volume(p_context, volume_8q8_db);
+            tas2780_set_volume(device_index, volume_8q8_db);
         }
     }
 }
 
 /**
- * @brief Check the amplifier state to be active without mute, and enforce it.
+ * @brief Sets the volume on all connected TAS2780 amplifiers, which play a chosen TDM slot.
+ * @details Does not block, and does not require the TAS2780 lock. Writes are queued, and coalesced with pending writes
+ * of earlier volume levels.
  *
- * @param p_context The pointer to the amplifier context.
+ * @param volume_8q8_db The volume to set in 8.8 signed binary fixpoint format.
+ * @param tdm_slot_index The TDM slot index to set the volume for.
  */
-static void tas2780_ensure_active(struct tas2780_context *p_context) {
-    uint8_t *p_write_buffer = p_context->write_buffer;
-    uint8_t *p_read_buffer  = p_context->read_buffer;
-
-    p_write_buffer[0] = TAS2780_MODE_CTRL_REG;
-    tas2780_write(p_context, p_write_buffer, 1u);
-    tas2780_read(p_context, p_read_buffer, 1u);
-
-    uint8_t state = (p_read_buffer[0] & TAS2780_MODE_CTRL_MODE_MASK) >> TAS2780_MODE_CTRL_MODE_POS;
-
-    if (state != TAS2780_MODE_CTRL_MODE_ACTIVE_WITHOUT_MUTE) {
-        p_write_buffer[0] = TAS2780_MODE_CTRL_REG;
-        p_write_buffer[1] =
-            ((TAS2780_MODE_CTRL_MODE_ACTIVE_WITHOUT_MUTE << TAS2780_MODE_CTRL_MODE_POS) & TAS2780_MODE_CTRL_MODE_MASK);
-        tas2780_write(p_context, p_write_buffer, 2);
+void tas2780_set_volume_slot(int16_t volume_8q8_db, uint8_t tdm_slot_index) {
+    for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
+        if (g_tas2780_contexts[device_index].tdm_slot_index == tdm_slot_index) {
+            tas2780_set_volume(device_index, volume_8q8_db);
+        }
     }
 }
 
 /**
  * @brief Ensure the active state without mute on all connected amplifiers.
+ * @details This is the slow fallback for fault handling via IRQZ. It also clears latched interrupts that are not
+ * handled by \a tas2780_handle_faults , so that IRQZ is released in any case.
  */
 void tas2780_ensure_active_all(void) {
     for (size_t device_index = 0; device_index < TAS2780_DEVICE_COUNT; device_index++) {
-        tas2780_ensure_active(&g_tas2780_contexts[device_index]);
+        struct tas2780_context *p_context = &g_tas2780_contexts[device_index];
+
+        if (!tas2780_handle_faults(p_context)) {
+            tas2780_clear_faults(p_context);
+            tas2780_ensure_active(p_context);
+        }
     }
 }
 
@@ -382,14 +902,10 @@ void tas2780_ensure_active_all(void) {
  * @return false if the noise gate is inactive.
  */
 static bool tas2780_noise_gate_is_enabled(struct tas2780_context *p_context) {
-    uint8_t *p_write_buffer = p_context->write_buffer;
-    uint8_t *p_read_buffer  = p_context->read_buffer;
-
-    p_write_buffer[0] = TAS2780_INT_LIVE1_REG;
-    tas2780_write(p_context, p_write_buffer, 1u);
-    tas2780_read(p_context, p_read_buffer, 1u);
+    uint8_t int_live1 =
+        tas2780_read_register(p_context, TAS2780_DEFAULT_BOOK_INDEX, TAS2780_DEFAULT_PAGE_INDEX, TAS2780_INT_LIVE1_REG);
 
-    uint8_t state = (p_read_buffer[0] & TAS2780_INT_LIVE1_IL_NGA_MASK) >> TAS2780_INT_LIVE1_IL_NGA_POS;
+    uint8_t state = (int_live1 & TAS2780_INT_LIVE1_IL_NGA_MASK) >> TAS2780_INT_LIVE1_IL_NGA_POS;
 
     return (bool)state;
 }
@@ -26,10 +26,45 @@
  */
 #define TAS2780_VOLUME_MAX (0x00u)
 
+/**
+ * @brief The maximum number of consecutive registers that are written in a single auto-increment transaction.
+ */
+#define TAS2780_BURST_LENGTH_MAX 4u
+
 /**
  * @brief Read and write buffer lengths.
+ * @details Holds a register address, followed by up to \a TAS2780_BURST_LENGTH_MAX register values.
+ */
+#define TAS2780_BUFFER_LENGTH (1u + TAS2780_BURST_LENGTH_MAX)
+
+/**
+ * @brief The number of distinct registers per amplifier, for which writes can be queued at the same time.
+ * @details Queued writes to the same register of the same amplifier are coalesced, so that only the latest value is
+ * written.
+ */
+#define TAS2780_QUEUE_LENGTH 4u
+
+/**
+ * @brief The number of times that faults are handled again while IRQZ stays low, before the slow poll takes over.
+ * @details Bounds the I2C load of faults that return as soon as they are cleared, e.g. over-current into a shorted
+ * speaker.
+ */
+#define TAS2780_FAULT_RETRY_COUNT 4u
+
+/**
+ * @brief The delay in ms, after which faults are handled again while IRQZ stays low.
+ */
+#define TAS2780_FAULT_RETRY_DELAY_MS 10u
+
+/**
+ * @brief The number of pages in book 0, starting at page 0, that are held in the register cache.
  */
-#define TAS2780_BUFFER_LENGTH 2u
+#define TAS2780_CACHE_PAGE_COUNT 2u
+
+/**
+ * @brief The number of registers in the register cache, with 128 registers per page.
+ */
+#define TAS2780_CACHE_SIZE (TAS2780_CACHE_PAGE_COUNT * 128u)
 
 /**
  * @brief The selected channel.
@@ -49,10 +84,35 @@ struct tas2780_context {
     uint8_t              book_index;                           ///< The book that the device is set to.
     uint16_t             device_address;                       ///< The I2C device address.
     uint8_t              tdm_slot_index;                       ///< The TDM slot index on which this device plays.
+    uint8_t              volume;                               ///< The latest volume register value.
     enum tas2780_channel channel;  ///< The audio channel (left/right). When TAS2780_CHANNEL_BOTH
                                    ///< is selected, sets up stereo mixing.
     uint8_t analog_gain_setting;   ///< Can be between 0x00 and 0x14, where 0x14
                                    ///< is loudest. The range of gains is 10 dB.
+    uint8_t  cache[TAS2780_CACHE_SIZE];                    ///< The register cache (shadow copies of register values).
+    uint32_t cache_valid_masks[TAS2780_CACHE_SIZE / 32u];  ///< One bit per cached register, set if its value is known.
+};
+
+/**
+ * @brief A queued register write.
+ */
+struct tas2780_queue_entry {
+    uint8_t page_index;        ///< The page, on which the register is located.
+    uint8_t register_address;  ///< The register address.
+    uint8_t value;             ///< The latest value to write.
+    bool    b_pending;         ///< True, if the entry holds a value that was not written yet.
+};
+
+/**
+ * @brief An entry of the initialization sequence, which is shared by all amplifiers.
+ * @details Values are written to consecutive registers, starting at \a start_register_address .
+ */
+struct tas2780_init_entry {
+    uint8_t book_index;                        ///< The book, in which the registers are located.
+    uint8_t page_index;                        ///< The page, on which the registers are located.
+    uint8_t start_register_address;            ///< The address of the first register.
+    uint8_t value_count;                       ///< The number of consecutive registers to write.
+    uint8_t values[TAS2780_BURST_LENGTH_MAX];  ///< The values to write.
 };
 
 void tas2780_acquire_lock(void);
@@ -61,6 +121,7 @@ void tas2780_init(void);
 
 void    tas2780_setup_all(void);
 void    tas2780_set_volume_all(int16_t volume_8q8_db, enum tas2780_channel channel);
+void    tas2780_set_volume_slot(int16_t volume_8q8_db, uint8_t tdm_slot_index);
 void    tas2780_ensure_active_all(void);
 uint8_t tas2780_get_noise_gate_mask_all(void);
 
@@ -37,6 +37,9 @@
 // PAGE register
 #define TAS2780_PAGE_REG           (0x00u)
 #define TAS2780_DEFAULT_PAGE_INDEX (0x00u)
+#define TAS2780_PAGE_1_INDEX       (0x01u)
+#define TAS2780_TEST_PAGE_INDEX    (0xFDu)  ///< Undocumented, must be unlocked before access.
+#define TAS2780_PAGE_SIZE          (128u)   ///< The number of register addresses per page.
 
 // PAGE 0 registers
 // SW_RESET register
@@ -119,10 +122,12 @@
 #define TAS2780_TDM_CFG2_RX_SLEN_POS     (0u)
 #define TAS2780_TDM_CFG2_RX_SLEN_MASK    (BIT_MASK_2 << TAS2780_TDM_CFG2_RX_SLEN_POS)
 #define TAS2780_TDM_CFG2_RX_SLEN_DEFAULT (0x03u)  ///< 32 bit word length.
+#define TAS2780_TDM_CFG2_RX_SLEN_16_BIT  (0x00u)  ///< 16 bit slot length.
 
 #define TAS2780_TDM_CFG2_RX_WLEN_POS     (2u)
 #define TAS2780_TDM_CFG2_RX_WLEN_MASK    (BIT_MASK_2 << TAS2780_TDM_CFG2_RX_WLEN_POS)
 #define TAS2780_TDM_CFG2_RX_WLEN_DEFAULT (0x03u)  ///< 32 bit word length.
+#define TAS2780_TDM_CFG2_RX_WLEN_16_BIT  (0x00u)  ///< 16 bit word length.
 
 #define TAS2780_TDM_CFG2_RX_SCFG_MONO_I2C        (0x0u)  ///< TDM channel selection by I2C address.
 #define TAS2780_TDM_CFG2_RX_SCFG_MONO_LEFT       (0x1u)  ///< TDM channel selection: left.
@@ -173,6 +178,36 @@
 #define TAS2780_INT_LIVE1_IL_NGA_POS  (2u)
 #define TAS2780_INT_LIVE1_IL_NGA_MASK (BIT_MASK_1 << TAS2780_INT_LIVE1_IL_NGA_POS)
 
+// INT_MASK0 register
+#define TAS2780_INT_MASK0_REG (0x3Bu)
+
+#define TAS2780_INT_MASK0_OTE_POS  (0u)  ///< Over-temperature error.
+#define TAS2780_INT_MASK0_OTE_MASK (BIT_MASK_1 << TAS2780_INT_MASK0_OTE_POS)
+
+#define TAS2780_INT_MASK0_OCE_POS  (1u)  ///< Over-current error.
+#define TAS2780_INT_MASK0_OCE_MASK (BIT_MASK_1 << TAS2780_INT_MASK0_OCE_POS)
+
+// INT_LTCH0 register (latched over-temperature, over-current, and clock errors)
+#define TAS2780_INT_LTCH0_REG (0x49u)
+
+// INT_CLK_CFG register
+#define TAS2780_INT_CLK_CFG_REG (0x5Cu)
+
+#define TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_POS     (0u)
+#define TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_MASK    (BIT_MASK_2 << TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_POS)
+#define TAS2780_INT_CLK_CFG_IRQZ_PIN_CFG_LATCHED (0x01u)  ///< IRQZ is asserted on unmasked latched interrupts.
+
+#define TAS2780_INT_CLK_CFG_IRQZ_CLR_POS  (2u)  ///< Clears all latched interrupts, self-clearing.
+#define TAS2780_INT_CLK_CFG_IRQZ_CLR_MASK (BIT_MASK_1 << TAS2780_INT_CLK_CFG_IRQZ_CLR_POS)
+
+// Interrupt status registers (live and latched flags), which change without host writes.
+#define TAS2780_INT_STATUS_FIRST_REG (0x41u)
+#define TAS2780_INT_STATUS_LAST_REG  (0x51u)
+
+// Measurement readback registers (supply voltages, temperature), which change without host writes.
+#define TAS2780_MEASUREMENT_FIRST_REG (0x77u)
+#define TAS2780_MEASUREMENT_LAST_REG  (0x7Eu)
+
 // DVC (digital volume control) register
 #define TAS2780_DVC_REG (0x1Au)
 
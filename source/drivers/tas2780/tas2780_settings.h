@@ -34,6 +34,25 @@ static const enum tas2780_channel TAS2780_DEVICE_CHANNELS[TAS2780_DEVICE_COUNT]
  */
 static const uint8_t TAS2780_TDM_SLOT_INDICES[TAS2780_DEVICE_COUNT] = {0u, 1u, 2u, 3u};
 
+/**
+ * @brief The length of the TDM slots, on which the amplifiers receive audio, in bit.
+ * @details 32 bit slots match standard I2S with two 32 bit channels. For four slots in the same frame, use 16 bit.
+ */
+#ifndef TAS2780_TDM_SLOT_LENGTH_BIT
+#define TAS2780_TDM_SLOT_LENGTH_BIT 32u
+#endif
+
+// Select the receive slot and word lengths for the TDM_CFG2 register.
+#if TAS2780_TDM_SLOT_LENGTH_BIT == 16u
+#define TAS2780_TDM_CFG2_RX_SLEN TAS2780_TDM_CFG2_RX_SLEN_16_BIT
+#define TAS2780_TDM_CFG2_RX_WLEN TAS2780_TDM_CFG2_RX_WLEN_16_BIT
+#elif TAS2780_TDM_SLOT_LENGTH_BIT == 32u
+#define TAS2780_TDM_CFG2_RX_SLEN TAS2780_TDM_CFG2_RX_SLEN_DEFAULT
+#define TAS2780_TDM_CFG2_RX_WLEN TAS2780_TDM_CFG2_RX_WLEN_DEFAULT
+#else
+#error "Unsupported TDM slot length. Must be 16, or 32 bit."
+#endif
+
 #endif  // SOURCE_DRIVERS_TAS2780_TAS2780_SETTINGS_H_
 
 /**
@@ -0,0 +1,187 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Binary event log.
+ * @details Collects diagnostic events as compact binary entries (timestamp, event, arguments) in a lock-free ring, so
+ * that ISRs and threads never format strings, or wait for output. Writers reserve an entry by an atomic increment of
+ * the write index, fill it, and commit it by setting its sequence number. A thread with the lowest priority drains the
+ * ring in order, and formats the entries via \a PRINTF .
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#include "log.h"
+
+#include "print.h"
+
+#if LOG_ENABLE
+
+#if (LOG_RING_LENGTH & (LOG_RING_LENGTH - 1u)) != 0u
+#error "The log ring length must be a power of two."
+#endif
+
+/**
+ * @brief The period in ms, with which the log thread drains the log ring.
+ */
+#define LOG_DRAIN_PERIOD_MS 10u
+
+/**
+ * @brief An entry of the log ring.
+ */
+struct log_entry {
+    volatile uint32_t sequence;                       ///< One more than the write index, after the entry was written.
+    systime_t         timestamp;                      ///< The system time of the event.
+    enum log_event    event;                          ///< The event.
+    uint32_t          arguments[LOG_ARGUMENT_COUNT];  ///< The event arguments.
+};
+
+/**
+ * @brief The log ring.
+ * @details Indices are free-running, and are wrapped to the ring length on access.
+ */
+static struct log_ring {
+    struct log_entry  entries[LOG_RING_LENGTH];  ///< The log entries.
+    volatile uint32_t write_index;               ///< The index of the next entry to reserve.
+    volatile uint32_t read_index;                ///< The index of the next entry to drain.
+    volatile uint32_t dropped_count;             ///< The number of entries that were dropped, due to a full ring.
+} g_log;
+
+/**
+ * @brief The format strings of all log events.
+ */
+static const char *const g_log_formats[LOG_EVENT_COUNT] = {
+    [LOG_EVENT_BRIDGE_START]          = "### Starting USB-I2S bridge.\n",
+    [LOG_EVENT_AUDIO_SET_SAMPLE_RATE] = "### Set sample rate: %u Hz (changed %u).\n",
+    [LOG_EVENT_AUDIO_PLLI2S_TIMEOUT]  = "### I2S PLL did not lock.\n",
+    [LOG_EVENT_AUDIO_STOP_PLAYBACK]   = "### Stop playback.\n",
+    [LOG_EVENT_AUDIO_START_PLAYBACK]  = "### Start playback.\n",
+    [LOG_EVENT_AUDIO_START_WARM_IDLE] = "### Start warm idle.\n",
+    [LOG_EVENT_APP_RESET_VOLUME]      = "### Reset volume.\n",
+    [LOG_EVENT_APP_SET_MUTE_STATE]    = "### Set mute state.\n",
+    [LOG_EVENT_APP_SET_VOLUME]        = "### Set volume.\n",
+    [LOG_EVENT_REPORT_BUFFER]         = "Buffer: %u / %u (fb %u) @ state %u\n",
+    [LOG_EVENT_REPORT_USB_STATS]      = "Stats: rx %u, fail %u, corr %u (max %u)\n",
+    [LOG_EVENT_REPORT_PLAYBACK_STATS] = "Stats: start %u, stop %u, fb %u\n",
+    [LOG_EVENT_REPORT_DSP_STATS]      = "DSP: blocks %u, max %u cycles, overruns %u, muted %u\n",
+    [LOG_EVENT_REPORT_PROFILE]        = "Profile %u: min %u, max %u, mean %u cycles\n",
+    [LOG_EVENT_REPORT_LATENCY]        = "Latency: %u markers, min %u, max %u, mean %u us\n",
+    [LOG_EVENT_REPORT_LATENCY_STATE]  = "Latency: missed %u, %u frames @ %u Hz, profile %u\n",
+    [LOG_EVENT_REPORT_STACK]          = "Stack %s: %u of %u bytes used\n",
+};
+
+/**
+ * @brief Write an event to the log.
+ * @details Does not lock, and does not wait. If the log ring is full, the event is dropped and counted.
+ *
+ * @param event The event.
+ * @param argument_0 The first event argument.
+ * @param argument_1 The second event argument.
+ * @param argument_2 The third event argument.
+ * @param argument_3 The fourth event argument.
+ */
+void log_write(enum log_event event, uint32_t argument_0, uint32_t argument_1, uint32_t argument_2,
+               uint32_t argument_3) {
+    uint32_t write_index = g_log.write_index;
+
+    // Reserve an entry. Retries, if another context reserved the same entry in the meantime.
+    do {
+        if ((write_index - g_log.read_index) >= LOG_RING_LENGTH) {
+            __atomic_fetch_add(&g_log.dropped_count, 1u, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&g_log.write_index, &write_index, write_index + 1u, true, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+
+    struct log_entry *p_entry = &g_log.entries[write_index & (LOG_RING_LENGTH - 1u)];
+
+    p_entry->timestamp    = chVTGetSystemTimeX();
+    p_entry->event        = event;
+    p_entry->arguments[0] = argument_0;
+    p_entry->arguments[1] = argument_1;
+    p_entry->arguments[2] = argument_2;
+    p_entry->arguments[3] = argument_3;
+
+    // Commit the entry.
+    __DMB();
+    p_entry->sequence = write_index + 1u;
+}
+
+/**
+ * @brief Read the next committed entry from the log ring.
+ * @details Entries are read in the order of reservation. An entry that is reserved, but not yet committed, holds back
+ * all following entries.
+ * @note There must only be a single reader.
+ *
+ * @param p_entry The pointer to the entry that receives the copy.
+ * @return true if an entry was read.
+ * @return false if no committed entry is available.
+ */
+static bool log_read(struct log_entry *p_entry) {
+    uint32_t          read_index = g_log.read_index;
+    struct log_entry *p_source   = &g_log.entries[read_index & (LOG_RING_LENGTH - 1u)];
+
+    if (p_source->sequence != (read_index + 1u)) {
+        return false;
+    }
+
+    __DMB();
+    p_entry->timestamp = p_source->timestamp;
+    p_entry->event     = p_source->event;
+
+    for (size_t argument_index = 0; argument_index < LOG_ARGUMENT_COUNT; argument_index++) {
+        p_entry->arguments[argument_index] = p_source->arguments[argument_index];
+    }
+
+    // Release the entry to the writers.
+    __DMB();
+    g_log.read_index = read_index + 1u;
+
+    return true;
+}
+
+static THD_WORKING_AREA(wa_log_thread, 256);
+
+/**
+ * @brief A thread that drains the log ring, and formats its entries.
+ */
+static THD_FUNCTION(log_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("log");
+
+    uint32_t reported_dropped_count = 0u;
+
+    while (true) {
+        struct log_entry entry;
+
+        while (log_read(&entry)) {
+            chDbgAssert(entry.event < LOG_EVENT_COUNT, "Invalid log event.");
+
+            PRINTF("[%u] ", entry.timestamp);
+            PRINTF(g_log_formats[entry.event], entry.arguments[0], entry.arguments[1], entry.arguments[2],
+                   entry.arguments[3]);
+        }
+
+        uint32_t dropped_count = g_log.dropped_count;
+
+        if (dropped_count != reported_dropped_count) {
+            PRINTF("### Dropped %u log entries.\n", dropped_count - reported_dropped_count);
+            reported_dropped_count = dropped_count;
+        }
+
+        chThdSleepMilliseconds(LOG_DRAIN_PERIOD_MS);
+    }
+}
+
+/**
+ * @brief Start the log thread.
+ * @details Entries that were written before are kept. Call after the print stream was started.
+ */
+void log_setup(void) { chThdCreateStatic(wa_log_thread, sizeof(wa_log_thread), LOWPRIO, log_thread, NULL); }
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,125 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Binary event log headers.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#ifndef SOURCE_LOG_H_
+#define SOURCE_LOG_H_
+
+#include "common.h"
+
+/**
+ * @brief Enable the event log. Without it, events are discarded, and the log thread is not started.
+ */
+#ifndef LOG_ENABLE
+#define LOG_ENABLE 1u
+#endif
+
+/**
+ * @brief The number of entries in the log ring. Must be a power of two.
+ * @details If the ring is full, new entries are dropped and counted, until the log thread caught up.
+ */
+#ifndef LOG_RING_LENGTH
+#define LOG_RING_LENGTH 32u
+#endif
+
+/**
+ * @brief The number of arguments that are stored with every log entry.
+ */
+#define LOG_ARGUMENT_COUNT 4u
+
+/**
+ * @brief The events that can be logged.
+ * @details Every event has a format string in the log module, which receives all \a LOG_ARGUMENT_COUNT arguments.
+ */
+enum log_event {
+    LOG_EVENT_BRIDGE_START,           ///< The bridge started.
+    LOG_EVENT_AUDIO_SET_SAMPLE_RATE,  ///< The host set a sample rate (rate in Hz, true if the rate changed).
+    LOG_EVENT_AUDIO_PLLI2S_TIMEOUT,   ///< The I2S PLL did not lock, which leaves the output stopped.
+    LOG_EVENT_AUDIO_STOP_PLAYBACK,    ///< The audio thread stopped I2S output.
+    LOG_EVENT_AUDIO_START_PLAYBACK,   ///< The audio thread started I2S output.
+    LOG_EVENT_AUDIO_START_WARM_IDLE,  ///< The audio thread armed the warm idle timer.
+    LOG_EVENT_APP_RESET_VOLUME,       ///< The application reset the volume.
+    LOG_EVENT_APP_SET_MUTE_STATE,     ///< The application set a new mute state.
+    LOG_EVENT_APP_SET_VOLUME,         ///< The application set a new volume.
+    LOG_EVENT_REPORT_BUFFER,          ///< The buffer state (fill size, maximum size, feedback, playback state).
+    LOG_EVENT_REPORT_USB_STATS,       ///< The USB statistics (packets, failures, corrections, max. correction).
+    LOG_EVENT_REPORT_PLAYBACK_STATS,  ///< The playback statistics (starts, stops, feedback updates).
+    LOG_EVENT_REPORT_DSP_STATS,       ///< The DSP load (blocks, max. cycles, overruns, mute state).
+    LOG_EVENT_REPORT_PROFILE,         ///< The profile of a site (site, min. cycles, max. cycles, mean cycles).
+    LOG_EVENT_REPORT_LATENCY,         ///< The latency test results (measurements, min. us, max. us, mean us).
+    LOG_EVENT_REPORT_LATENCY_STATE,   ///< The latency test state (missed markers, frames, sample rate, profile).
+    LOG_EVENT_REPORT_STACK,           ///< The watermark of a stack (static name string, used bytes, size).
+    LOG_EVENT_COUNT                   ///< The number of log events.
+};
+
+/**
+ * @brief Write an event without arguments to the log.
+ * @details Can be called from any context.
+ *
+ * @param _event The event, a value of \a log_event .
+ */
+#define LOG_WRITE_EVENT(_event) log_write((_event), 0u, 0u, 0u, 0u)
+
+/**
+ * @brief Write an event to the log, with one to \a LOG_ARGUMENT_COUNT arguments.
+ * @details Missing arguments are zero. More arguments fail to compile, instead of being dropped. Can be called from
+ * any context. Events without arguments are written with \a LOG_WRITE_EVENT .
+ *
+ * @param _event The event, a value of \a log_event .
+ * @param ... The event arguments.
+ */
+#define LOG_WRITE(_event, ...)                                                                                         \
+    do {                                                                                                               \
+        _Static_assert(LOG_COUNT_ARGUMENTS(__VA_ARGS__) <= LOG_ARGUMENT_COUNT,                                         \
+                       "LOG_WRITE takes at most LOG_ARGUMENT_COUNT arguments.");                                       \
+        LOG_WRITE_ARGUMENTS(_event, __VA_ARGS__, 0u, 0u, 0u, 0u);                                                      \
+    } while (0)
+
+/**
+ * @brief Helper for \a LOG_WRITE , which counts up to eight arguments.
+ * @details With more arguments, the count is an argument itself, which is not a constant in practice, and fails the
+ * static assertion as well.
+ */
+#define LOG_COUNT_ARGUMENTS(...) LOG_COUNT_ARGUMENTS_SELECT(__VA_ARGS__, 8u, 7u, 6u, 5u, 4u, 3u, 2u, 1u, 0u)
+
+/**
+ * @brief Helper for \a LOG_COUNT_ARGUMENTS , which selects the count from behind the arguments.
+ */
+#define LOG_COUNT_ARGUMENTS_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _count, ...) (_count)
+
+/**
+ * @brief Helper for \a LOG_WRITE , which drops the surplus zero arguments.
+ */
+#define LOG_WRITE_ARGUMENTS(_event, _argument_0, _argument_1, _argument_2, _argument_3, ...)                          \
+    log_write((_event), (uint32_t)(_argument_0), (uint32_t)(_argument_1), (uint32_t)(_argument_2),                    \
+              (uint32_t)(_argument_3))
+
+#if LOG_ENABLE
+void log_write(enum log_event event, uint32_t argument_0, uint32_t argument_1, uint32_t argument_2,
+               uint32_t argument_3);
+void log_setup(void);
+#else
+/**
+ * @brief Discard an event, as the event log is disabled.
+ */
+static inline void log_write(enum log_event event, uint32_t argument_0, uint32_t argument_1, uint32_t argument_2,
+                             uint32_t argument_3) {
+    (void)event;
+    (void)argument_0;
+    (void)argument_1;
+    (void)argument_2;
+    (void)argument_3;
+}
+#endif
+
+#endif  // SOURCE_LOG_H_
+
+/**
+ * @}
+ */
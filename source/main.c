@@ -6,7 +6,7 @@
  * @details Contains the main application thread, and from there sets up
  * - general USB handling,
  * - the audio module,
- * - reporting functionality, and
+ * - reporting functionality via the event log, and
  * - the user application
  *
  * @addtogroup main
@@ -18,7 +18,7 @@
 #include "audio.h"
 #include "ch.h"
 #include "hal.h"
-#include "print.h"
+#include "log.h"
 #include "usb.h"
 
 /**
@@ -84,10 +84,13 @@ int main(void) {
     // Initialize the USB module.
     usb_setup();
 
-    // Initialize a stream for print messages.
+    // Initialize a stream for print messages, and start formatting log entries.
     sdStart(&SD2, NULL);
+#if LOG_ENABLE
+    log_setup();
+#endif
 
-    PRINTF("### Starting USB-I2S bridge.\n");
+    LOG_WRITE_EVENT(LOG_EVENT_BRIDGE_START);
 
     // Set up the user application.
     app_setup();
@@ -103,17 +106,17 @@ int main(void) {
 
         switch (message) {
             case AUDIO_COMMON_MSG_RESET_VOLUME:
-                PRINTF("### Reset volume.\n");
+                LOG_WRITE_EVENT(LOG_EVENT_APP_RESET_VOLUME);
                 app_reset_volume();
                 break;
 
             case AUDIO_COMMON_MSG_SET_MUTE_STATE:
-                PRINTF("### Set mute state.\n");
+                LOG_WRITE_EVENT(LOG_EVENT_APP_SET_MUTE_STATE);
                 app_set_mute_state();
                 break;
 
             case AUDIO_COMMON_MSG_SET_VOLUME:
-                PRINTF("### Set volume.\n");
+                LOG_WRITE_EVENT(LOG_EVENT_APP_SET_VOLUME);
                 app_set_volume();
                 break;
 
@@ -0,0 +1,96 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Memory report module.
+ * @details Reports the stack watermarks of all threads, and of the exception stack. The kernel paints the working area
+ * of every thread with \a CH_DBG_STACK_FILL_VALUE at its creation, and the startup code paints the exception and
+ * process stacks. Stacks grow downwards, so that the painted bytes at the bottom of a stack were never used.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#include "memory_report.h"
+
+#include "log.h"
+
+#if MEMORY_REPORT_ENABLE
+
+#if CH_DBG_FILL_THREADS != TRUE
+#error "The memory report requires stack painting (CH_DBG_FILL_THREADS)."
+#endif
+
+#if CH_CFG_USE_REGISTRY != TRUE
+#error "The memory report requires the thread registry (CH_CFG_USE_REGISTRY)."
+#endif
+
+/**
+ * @brief The name, with which the exception stack is reported.
+ */
+#define MEMORY_REPORT_EXCEPTION_STACK_NAME "exceptions"
+
+/**
+ * @brief The bounds of the exception stack and the process stack, from the linker script.
+ */
+extern uint8_t __main_stack_base__[], __main_stack_end__[], __process_stack_base__[], __process_stack_end__[];
+
+/**
+ * @brief Count the bytes at the bottom of a stack, which still hold the paint.
+ *
+ * @param p_base The pointer to the lowest address of the stack.
+ * @param p_end The pointer past the highest address of the stack.
+ * @return size_t The number of unused bytes.
+ */
+static size_t memory_report_get_unused_size(const uint8_t *p_base, const uint8_t *p_end) {
+    const uint8_t *p_byte = p_base;
+
+    while ((p_byte < p_end) && (*p_byte == CH_DBG_STACK_FILL_VALUE)) {
+        p_byte++;
+    }
+
+    return (size_t)(p_byte - p_base);
+}
+
+/**
+ * @brief Log the watermark of a stack.
+ *
+ * @param p_name The name of the stack. Must be a static string, as the log only stores the pointer.
+ * @param p_base The pointer to the lowest address of the stack.
+ * @param p_end The pointer past the highest address of the stack.
+ */
+static void memory_report_stack(const char *p_name, const uint8_t *p_base, const uint8_t *p_end) {
+    const size_t SIZE = (size_t)(p_end - p_base);
+
+    LOG_WRITE(LOG_EVENT_REPORT_STACK, (uintptr_t)p_name, SIZE - memory_report_get_unused_size(p_base, p_end), SIZE);
+}
+
+/**
+ * @brief Report the stack watermarks of all threads, and of the exception stack.
+ * @details Every stack is logged with its peak usage and its size in bytes. The kernel places the thread structure at
+ * the top of a working area, which thus marks the end of the stack. The stack of the main thread is the process stack.
+ */
+void memory_report_stacks(void) {
+    memory_report_stack(MEMORY_REPORT_EXCEPTION_STACK_NAME, __main_stack_base__, __main_stack_end__);
+
+    thread_t *p_thread = chRegFirstThread();
+
+    while (p_thread != NULL) {
+        const uint8_t *p_base = (const uint8_t *)chThdGetWorkingAreaX(p_thread);
+        const uint8_t *p_end  = (const uint8_t *)p_thread;
+
+        if (p_base == __process_stack_base__) {
+            p_end = __process_stack_end__;
+        }
+
+        memory_report_stack(chRegGetThreadNameX(p_thread), p_base, p_end);
+
+        p_thread = chRegNextThread(p_thread);
+    }
+}
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,32 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Memory report module headers.
+ *
+ * @addtogroup common
+ * @{
+ */
+
+#ifndef SOURCE_MEMORY_REPORT_H_
+#define SOURCE_MEMORY_REPORT_H_
+
+#include "common.h"
+
+/**
+ * @brief Enable reporting the stack watermarks of all threads and the exception stack.
+ * @details Requires stack painting (\a CH_DBG_FILL_THREADS ), which the Makefile enables with this option.
+ */
+#ifndef MEMORY_REPORT_ENABLE
+#define MEMORY_REPORT_ENABLE 0u
+#endif
+
+#if MEMORY_REPORT_ENABLE
+void memory_report_stacks(void);
+#endif
+
+#endif  // SOURCE_MEMORY_REPORT_H_
+
+/**
+ * @}
+ */
@@ -15,6 +15,17 @@
 
 #include "chprintf.h"
 #include "common.h"
+#include "usb_telemetry.h"
+
+/**
+ * @brief The stream, to which print messages are written.
+ * @details With telemetry, messages go to the USB virtual serial port, instead of the UART.
+ */
+#if USB_TELEMETRY_ENABLE
+#define PRINT_STREAM USB_TELEMETRY_STREAM
+#else
+#define PRINT_STREAM ((BaseSequentialStream*)&SD2)
+#endif
 
 /**
  * @brief Generic print function, which can perform different functions.
@@ -25,7 +36,7 @@
 static inline void PRINTF(const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    chvprintf((BaseSequentialStream*)&SD2, fmt, args);
+    chvprintf(PRINT_STREAM, fmt, args);
     va_end(args);
 }
 
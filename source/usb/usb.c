@@ -10,8 +10,23 @@
 
 #include "usb.h"
 
+#include "audio_capture.h"
 #include "audio_feedback.h"
 #include "audio_playback.h"
+#include "usb_telemetry.h"
+
+#if USB_TELEMETRY_ENABLE
+/**
+ * @brief Handles setup requests, which the audio function or the telemetry function support.
+ *
+ * @param p_usb A pointer to the USB driver structure.
+ * @return true if a setup request could be handled.
+ * @return false if a setup request could not be handled.
+ */
+static bool usb_request_hook_cb(USBDriver *p_usb) {
+    return audio_request_hook_cb(p_usb) || usb_telemetry_request_hook_cb(p_usb);
+}
+#endif
 
 /**
  * @brief Settings structure for the USB driver.
@@ -19,8 +34,13 @@
 static const USBConfig g_usb_config = {
     .event_cb          = usb_event_cb,
     .get_descriptor_cb = usb_get_descriptor_cb,
-    .requests_hook_cb  = audio_request_hook_cb,
-    .sof_cb            = NULL,
+#if USB_TELEMETRY_ENABLE
+    .requests_hook_cb = usb_request_hook_cb,
+    .sof_cb           = usb_telemetry_sof_cb,
+#else
+    .requests_hook_cb = audio_request_hook_cb,
+    .sof_cb           = NULL,
+#endif
 };
 
 /**
@@ -28,6 +48,28 @@ static const USBConfig g_usb_config = {
  */
 static USBOutEndpointState endpoint1_out_state;
 
+#if USB_TELEMETRY_ENABLE
+/**
+ * @brief A structure that holds the IN state of endpoint 1.
+ */
+static USBInEndpointState endpoint1_in_state;
+
+/**
+ * @brief The configuration structure for endpoint 1.
+ * @details Receives audio playback data, and transmits audio feedback, so that endpoints 2 and 3 remain available for
+ * the telemetry function.
+ */
+static const USBEndpointConfig endpoint1_config = {.ep_mode       = USB_EP_MODE_TYPE_ISOC,
+                                                   .setup_cb      = NULL,
+                                                   .in_cb         = audio_feedback_cb,
+                                                   .out_cb        = audio_playback_received_cb,
+                                                   .in_maxsize    = USB_DESC_MAX_IN_SIZE,
+                                                   .out_maxsize   = AUDIO_MAX_PACKET_SIZE,
+                                                   .in_state      = &endpoint1_in_state,
+                                                   .out_state     = &endpoint1_out_state,
+                                                   .in_multiplier = 1u,
+                                                   .setup_buf     = NULL};
+#else
 /**
  * @brief The configuration structure for endpoint 1.
  */
@@ -60,6 +102,29 @@ static const USBEndpointConfig endpoint2_config = {.ep_mode       = USB_EP_MODE_
                                                    .out_state     = NULL,
                                                    .in_multiplier = 1u,
                                                    .setup_buf     = NULL};
+#endif
+
+#if AUDIO_CAPTURE_ENABLE
+/**
+ * @brief A structure that holds the state of endpoint 3.
+ */
+static USBInEndpointState endpoint3_in_state;
+
+/**
+ * @brief The configuration structure for endpoint 3.
+ * @details Transmits captured audio data.
+ */
+static const USBEndpointConfig endpoint3_config = {.ep_mode       = USB_EP_MODE_TYPE_ISOC,
+                                                   .setup_cb      = NULL,
+                                                   .in_cb         = audio_capture_cb,
+                                                   .out_cb        = NULL,
+                                                   .in_maxsize    = AUDIO_CAPTURE_MAX_PACKET_SIZE,
+                                                   .out_maxsize   = 0u,
+                                                   .in_state      = &endpoint3_in_state,
+                                                   .out_state     = NULL,
+                                                   .in_multiplier = 1u,
+                                                   .setup_buf     = NULL};
+#endif
 
 /**
  * @brief Handles global events that the USB driver triggers.
@@ -76,7 +141,14 @@ void usb_event_cb(USBDriver *p_usb, usbevent_t event) {
             // Enables configured endpoints.
             chSysLockFromISR();
             usbInitEndpointI(p_usb, USB_DESC_ENDPOINT_PLAYBACK, &endpoint1_config);
+#if USB_TELEMETRY_ENABLE
+            usb_telemetry_configure_hook_i(p_usb);
+#else
             usbInitEndpointI(p_usb, USB_DESC_ENDPOINT_FEEDBACK, &endpoint2_config);
+#endif
+#if AUDIO_CAPTURE_ENABLE
+            usbInitEndpointI(p_usb, USB_DESC_ENDPOINT_CAPTURE, &endpoint3_config);
+#endif
             chSysUnlockFromISR();
             return;
 
@@ -84,9 +156,19 @@ void usb_event_cb(USBDriver *p_usb, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
         case USB_EVENT_SUSPEND:
             audio_reset(p_usb);
+#if USB_TELEMETRY_ENABLE
+            chSysLockFromISR();
+            usb_telemetry_suspend_hook_i();
+            chSysUnlockFromISR();
+#endif
             return;
 
         case USB_EVENT_WAKEUP:
+#if USB_TELEMETRY_ENABLE
+            chSysLockFromISR();
+            usb_telemetry_wakeup_hook_i();
+            chSysUnlockFromISR();
+#endif
             return;
 
         case USB_EVENT_STALLED:
@@ -128,6 +210,10 @@ const USBDescriptor *usb_get_descriptor_cb(USBDriver *p_usb, uint8_t descriptor_
  * @brief Activate the USB peripheral.
  */
 void usb_setup(void) {
+#if USB_TELEMETRY_ENABLE
+    usb_telemetry_setup();
+#endif
+
     usbDisconnectBus(&USB_DRIVER);
     usbStart(&USB_DRIVER, &g_usb_config);
     usbConnectBus(&USB_DRIVER);
@@ -2,7 +2,9 @@
 
 /**
  * @file
- * @brief   USB descriptors for UAC v1 functionality.
+ * @brief   USB descriptors for UAC v1 and UAC v2 functionality.
+ * @details With \a AUDIO_UAC2_ENABLE , the audio function is described by UAC v2 descriptors, with a clock source
+ * entity, which is required for it. Otherwise, UAC v1 descriptors are used.
  *
  * @addtogroup usb
  * @{
@@ -14,7 +16,19 @@
 #include "audio.h"
 #include "common.h"
 #include "hal.h"
+#include "usb_telemetry.h"
 
+#if AUDIO_UAC2_ENABLE
+/**
+ * @brief The current version of the USB specification (2.0), which UAC v2 hosts require.
+ */
+#define USB_DESC_SPEC_VERSION 0x0200u
+
+/**
+ * @brief The current version of the ADC specification (2.0).
+ */
+#define USB_DESC_ADC_VERSION 0x0200u
+#else
 /**
  * @brief The current version of the USB specification (1.1).
  */
@@ -24,6 +38,7 @@
  * @brief The current version of the ADC specification (1.0).
  */
 #define USB_DESC_ADC_VERSION 0x0100u
+#endif
 
 /**
  * @brief The current version of the USB device (1.0).
@@ -45,6 +60,29 @@
  */
 #define USB_DESC_MAX_IN_SIZE 4u
 
+#if USB_TELEMETRY_ENABLE
+/**
+ * @brief Maximum size for a packet on the telemetry data in-endpoint.
+ */
+#define USB_DESC_TELEMETRY_DATA_IN_SIZE 64u
+
+/**
+ * @brief Maximum size for a packet on the telemetry data out-endpoint.
+ * @details The smallest size that full-speed bulk endpoints support, as the host does not send telemetry data.
+ */
+#define USB_DESC_TELEMETRY_DATA_OUT_SIZE 8u
+
+/**
+ * @brief Maximum size for a packet on the telemetry notification endpoint.
+ */
+#define USB_DESC_TELEMETRY_NOTIFICATION_SIZE 16u
+
+/**
+ * @brief Polling interval of the telemetry notification endpoint in ms.
+ */
+#define USB_DESC_TELEMETRY_NOTIFICATION_BINTERVAL 0xFFu
+#endif
+
 /**
  * @brief Packet interval for USB FS. Must be 1 ms.
  */
@@ -52,15 +90,32 @@
 
 #define USB_DESC_ENDPOINT_COUNT_ZERO_BANDWIDTH 0u
 #define USB_DESC_ENDPOINT_COUNT_OPERATIONAL    2u
+#define USB_DESC_ENDPOINT_COUNT_CAPTURE        1u
+
+#if AUDIO_CAPTURE_ENABLE && USB_TELEMETRY_ENABLE
+#error "The capture endpoint and the telemetry function do not fit into the available endpoints at the same time."
+#endif
 
 /**
- * @brief Audio endpoint assignments.
+ * @brief Endpoint assignments.
  * @note These values are not defined by the standard, but arbitrary. In some cases, there are hardware limitations with
- * regard to endpoint numbers.
+ * regard to endpoint numbers. The STM32F401 only has three endpoints besides the control endpoint, and both directions
+ * of an endpoint share its transfer type. With telemetry, the feedback endpoint therefore uses the IN direction of the
+ * playback endpoint, so that the bulk and interrupt endpoints of the telemetry function fit. The capture endpoint
+ * takes the remaining endpoint instead of the telemetry function.
  */
 enum usb_desc_endpoint {
-    USB_DESC_ENDPOINT_PLAYBACK = 0x01u,  ///< The endpoint for audio playback.
-    USB_DESC_ENDPOINT_FEEDBACK = 0x02u,  ///< The endpoint for audio feedback.
+    USB_DESC_ENDPOINT_PLAYBACK               = 0x01u,  ///< The endpoint for audio playback.
+#if USB_TELEMETRY_ENABLE
+    USB_DESC_ENDPOINT_FEEDBACK               = 0x01u,  ///< The endpoint for audio feedback.
+    USB_DESC_ENDPOINT_TELEMETRY_NOTIFICATION = 0x02u,  ///< The endpoint for telemetry notifications.
+    USB_DESC_ENDPOINT_TELEMETRY_DATA         = 0x03u,  ///< The endpoint for telemetry data.
+#else
+    USB_DESC_ENDPOINT_FEEDBACK               = 0x02u,  ///< The endpoint for audio feedback.
+#endif
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_ENDPOINT_CAPTURE                = 0x03u,  ///< The endpoint for audio capture.
+#endif
 };
 
 /**
@@ -68,9 +123,16 @@ enum usb_desc_endpoint {
  * @note These values are not defined by the standard, but arbitrary.
  */
 enum usb_desc_unit {
-    USB_DESC_UNIT_INPUT    = 0x01u,  ///< The index of the input unit.
-    USB_DESC_UNIT_FUNCTION = 0x02u,  ///< The index of the function unit.
-    USB_DESC_UNIT_OUTPUT   = 0x03u,  ///< The index of the output unit.
+    USB_DESC_UNIT_INPUT          = 0x01u,  ///< The index of the input unit.
+    USB_DESC_UNIT_FUNCTION       = 0x02u,  ///< The index of the function unit.
+    USB_DESC_UNIT_OUTPUT         = 0x03u,  ///< The index of the output unit.
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_UNIT_CAPTURE_INPUT  = 0x04u,  ///< The index of the capture input unit.
+    USB_DESC_UNIT_CAPTURE_OUTPUT = 0x05u,  ///< The index of the capture output unit.
+#endif
+#if AUDIO_UAC2_ENABLE
+    USB_DESC_UNIT_CLOCK_SOURCE   = 0x06u,  ///< The index of the clock source entity (UAC v2 only).
+#endif
 };
 
 /**
@@ -78,8 +140,15 @@ enum usb_desc_unit {
  * @note These values are not defined by the standard, but arbitrary.
  */
 enum usb_desc_interface {
-    USB_DESC_INTERFACE_CONTROL   = 0x00u,  ///< The index of the control interface.
-    USB_DESC_INTERFACE_STREAMING = 0x01u,  ///< The index of the streaming interface.
+    USB_DESC_INTERFACE_CONTROL           = 0x00u,  ///< The index of the control interface.
+    USB_DESC_INTERFACE_STREAMING         = 0x01u,  ///< The index of the streaming interface.
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_INTERFACE_CAPTURE           = 0x02u,  ///< The index of the capture streaming interface.
+#endif
+#if USB_TELEMETRY_ENABLE
+    USB_DESC_INTERFACE_TELEMETRY_CONTROL = 0x02u,  ///< The index of the telemetry communications interface.
+    USB_DESC_INTERFACE_TELEMETRY_DATA    = 0x03u,  ///< The index of the telemetry data interface.
+#endif
 };
 
 /**
@@ -121,6 +190,16 @@ enum usb_desc_output_terminal_type {
     USB_DESC_OUTPUT_TERMINAL_TYPE_LOW_FREQUENCY_SPEAKER      = 0x0307u   ///< Speaker for low frequency effects.
 };
 
+/**
+ * @brief USB external terminal types.
+ */
+enum usb_desc_external_terminal_type {
+    USB_DESC_EXTERNAL_TERMINAL_TYPE_UNDEFINED               = 0x0600u,  ///< An undefined external terminal type.
+    USB_DESC_EXTERNAL_TERMINAL_TYPE_ANALOG_CONNECTOR        = 0x0601u,  ///< A generic analog connector.
+    USB_DESC_EXTERNAL_TERMINAL_TYPE_DIGITAL_AUDIO_INTERFACE = 0x0602u,  ///< A generic digital audio interface.
+    USB_DESC_EXTERNAL_TERMINAL_TYPE_LINE_CONNECTOR          = 0x0603u,  ///< An analog connector at line level.
+};
+
 /**
  * @brief Channel configuration bit masks.
  */
@@ -157,6 +236,16 @@ enum usb_desc_fu_controls {
     USB_DESC_FU_CONTROLS_LOUDNESS          = 0x0200u,
 };
 
+/**
+ * @brief Feature unit control bit masks of UAC v2, with two bits per control (host programmable).
+ * @note The control selectors in requests are the same as in UAC v1, e.g. \a USB_DESC_FU_CONTROLS_VOLUME .
+ */
+enum usb_desc_uac2_fu_controls {
+    USB_DESC_UAC2_FU_CONTROLS_NONE   = 0x00000000u,
+    USB_DESC_UAC2_FU_CONTROLS_MUTE   = 0x00000003u,
+    USB_DESC_UAC2_FU_CONTROLS_VOLUME = 0x0000000Cu,
+};
+
 /**
  * @brief Type Values for the bDescriptorType Field.
  * @note The bDescriptorType values are the same ones defined in the USB Device Class Definition for Audio Devices
@@ -175,43 +264,540 @@ enum usb_desc_class_specific_type {
 #define USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_CONTROL   0x01u
 #define USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING 0x02u
 
-#define USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW     0x00u
-#define USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL 0x01u
+#define USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW       0x00u
+#define USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL   0x01u
+#define USB_DESC_INTERFACE_ALT_SETTING_PACKED_24_BIT 0x02u
+
+#define USB_DESC_INTERFACE_NONE                      0x00u
+#define USB_DESC_INTERFACE_PROTOCOL_UNDEFINED        0x00u
+#define USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00 0x20u
 
-#define USB_DESC_INTERFACE_NONE               0x00u
-#define USB_DESC_INTERFACE_PROTOCOL_UNDEFINED 0x00u
+// CDC interface definitions, see "Universal Serial Bus Class Definitions for Communications Devices".
+#define USB_DESC_INTERFACE_CLASS_CDC                  0x02u
+#define USB_DESC_INTERFACE_CLASS_CDC_SUBCLASS_ACM     0x02u
+#define USB_DESC_INTERFACE_CLASS_CDC_DATA             0x0Au
+#define USB_DESC_CDC_VERSION                          0x0110u
+#define USB_DESC_CDC_FUNCTIONAL_SUBTYPE_HEADER        0x00u
+#define USB_DESC_CDC_FUNCTIONAL_SUBTYPE_CALL_MGMT     0x01u
+#define USB_DESC_CDC_FUNCTIONAL_SUBTYPE_ACM           0x02u
+#define USB_DESC_CDC_FUNCTIONAL_SUBTYPE_UNION         0x06u
+#define USB_DESC_CDC_ACM_CAPABILITY_LINE_CODING_STATE 0x02u
+
+/**
+ * @brief Write a 32 bit value to a descriptor, starting at the LSB.
+ *
+ * @param _value The value to write.
+ */
+#define USB_DESC_DWORD(_value) USB_DESC_WORD((_value) & 0xFFFFu), USB_DESC_WORD(((_value) >> 16u) & 0xFFFFu)
+
+/**
+ * @brief The device class, which announces interface association descriptors for a composite device.
+ * @details UAC v2 always describes the audio function with an interface association descriptor. Without UAC v2 and
+ * telemetry, the class is defined at the interface level.
+ */
+#if USB_TELEMETRY_ENABLE || AUDIO_UAC2_ENABLE
+#define USB_DESC_DEVICE_CLASS    0xEFu  // Miscellaneous.
+#define USB_DESC_DEVICE_SUBCLASS 0x02u  // Common class.
+#define USB_DESC_DEVICE_PROTOCOL 0x01u  // Interface association descriptor.
+#else
+#define USB_DESC_DEVICE_CLASS    0x00u
+#define USB_DESC_DEVICE_SUBCLASS 0x00u
+#define USB_DESC_DEVICE_PROTOCOL 0x00u
+#endif
 
 static const uint8_t audio_device_descriptor_data[18u] = {
-    USB_DESC_DEVICE(USB_DESC_SPEC_VERSION,    // bcdUSB (1.1).
-                    0x00u,                    // bDeviceClass (None).
-                    0x00u,                    // bDeviceSubClass.
-                    0x00u,                    // bDeviceProtocol.
-                    0x40u,                    // bMaxPacketSize.
-                    USB_DESC_VID,             // idVendor.
-                    USB_DESC_PID,             // idProduct.
-                    USB_DESC_DEVICE_VERSION,  // bcdDevice.
-                    1u,                       // iManufacturer.
-                    2u,                       // iProduct.
-                    3u,                       // iSerialNumber.
-                    1u)                       // bNumConfigurations.
+    USB_DESC_DEVICE(USB_DESC_SPEC_VERSION,     // bcdUSB.
+                    USB_DESC_DEVICE_CLASS,     // bDeviceClass.
+                    USB_DESC_DEVICE_SUBCLASS,  // bDeviceSubClass.
+                    USB_DESC_DEVICE_PROTOCOL,  // bDeviceProtocol.
+                    0x40u,                     // bMaxPacketSize.
+                    USB_DESC_VID,              // idVendor.
+                    USB_DESC_PID,              // idProduct.
+                    USB_DESC_DEVICE_VERSION,   // bcdDevice.
+                    1u,                        // iManufacturer.
+                    2u,                        // iProduct.
+                    3u,                        // iSerialNumber.
+                    1u)                        // bNumConfigurations.
 };
 
 // Device Descriptor wrapper.
 static const USBDescriptor audio_device_descriptor = {sizeof audio_device_descriptor_data,
                                                       audio_device_descriptor_data};
 
-#define USB_DESCRIPTORS_TOTAL_LENGTH 125u
+/**
+ * @brief The spatial locations of the audio channels.
+ * @details The four channels of the TDM output are announced as a quadraphonic layout.
+ */
+#if AUDIO_TDM_ENABLE
+#define USB_DESCRIPTORS_CHANNEL_CONFIG                                                                                 \
+    (USB_DESC_CHANNEL_CONFIG_LEFT_FRONT | USB_DESC_CHANNEL_CONFIG_RIGHT_FRONT |                                        \
+     USB_DESC_CHANNEL_CONFIG_LEFT_SURROUND | USB_DESC_CHANNEL_CONFIG_RIGHT_SURROUND)
+#else
+#define USB_DESCRIPTORS_CHANNEL_CONFIG (USB_DESC_CHANNEL_CONFIG_LEFT_FRONT | USB_DESC_CHANNEL_CONFIG_RIGHT_FRONT)
+#endif
+
+/**
+ * @brief The number of discrete sample rates, which the format type descriptors (UAC v1) or the sample rate range
+ * (UAC v2) list.
+ */
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+#define USB_DESCRIPTORS_SAMPLE_RATE_COUNT 4u
+#else
+#define USB_DESCRIPTORS_SAMPLE_RATE_COUNT 2u
+#endif
+
+/**
+ * @brief The spatial locations of the captured audio channels.
+ */
+#if AUDIO_CAPTURE_CHANNEL_COUNT == 2u
+#define USB_DESCRIPTORS_CAPTURE_CHANNEL_CONFIG                                                                         \
+    (USB_DESC_CHANNEL_CONFIG_LEFT_FRONT | USB_DESC_CHANNEL_CONFIG_RIGHT_FRONT)
+#else
+#define USB_DESCRIPTORS_CAPTURE_CHANNEL_CONFIG USB_DESC_CHANNEL_CONFIG_NONE
+#endif
+
+/**
+ * @brief The length of the interface association descriptor of the audio function.
+ */
+#if USB_TELEMETRY_ENABLE || AUDIO_UAC2_ENABLE
+#define USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH 8u
+#else
+#define USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH 0u
+#endif
+
+/**
+ * @brief The length of the descriptors that the telemetry function adds.
+ * @details Consists of the interface association descriptor of the function, the communications interface with its
+ * functional and notification endpoint descriptors, and the data interface with its endpoint descriptors.
+ */
+#if USB_TELEMETRY_ENABLE
+#define USB_DESCRIPTORS_TELEMETRY_LENGTH 66u
+#else
+#define USB_DESCRIPTORS_TELEMETRY_LENGTH 0u
+#endif
+
+#if USB_TELEMETRY_ENABLE
+#define USB_DESCRIPTORS_INTERFACE_COUNT 4u
+#elif AUDIO_CAPTURE_ENABLE
+#define USB_DESCRIPTORS_INTERFACE_COUNT 3u
+#else
+#define USB_DESCRIPTORS_INTERFACE_COUNT 2u
+#endif
+
+#if AUDIO_UAC2_ENABLE
+/**
+ * @brief The length of the UAC v2 feature unit descriptor, which holds a four-byte control bit mask for the master
+ * channel, and for each audio channel.
+ */
+#define USB_DESCRIPTORS_FEATURE_UNIT_LENGTH (6u + 4u * (AUDIO_CHANNEL_COUNT + 1u))
+
+/**
+ * @brief The length of the capture input and output terminal descriptors.
+ */
+#if AUDIO_CAPTURE_ENABLE
+#define USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH 29u
+#else
+#define USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH 0u
+#endif
+
+/**
+ * @brief The total length of the class-specific audio control interface descriptors.
+ * @details Consists of the header, the clock source, the input and output terminals, and the feature unit.
+ */
+#define USB_DESCRIPTORS_CONTROL_LENGTH                                                                                 \
+    (46u + USB_DESCRIPTORS_FEATURE_UNIT_LENGTH + USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH)
+
+/**
+ * @brief The length of an operational alternate setting of the audio streaming interface.
+ * @details Consists of the standard and class-specific interface descriptors, the format type descriptor, and the
+ * audio data and feedback endpoint descriptors.
+ */
+#define USB_DESCRIPTORS_STREAMING_ALT_SETTING_LENGTH 53u
+
+/**
+ * @brief The length of the descriptors that the capture path adds to the streaming interfaces.
+ * @details Consists of the capture streaming interface with its zero-bandwidth and operational alternate settings.
+ */
+#if AUDIO_CAPTURE_ENABLE
+#define USB_DESCRIPTORS_CAPTURE_LENGTH 55u
+#else
+#define USB_DESCRIPTORS_CAPTURE_LENGTH 0u
+#endif
+
+/**
+ * @brief The total length of the configuration descriptor tree.
+ * @details Consists of the configuration descriptor, the standard audio control interface, its class-specific
+ * descriptors, the zero-bandwidth and operational alternate settings of the streaming interface, and the descriptors of
+ * optional functions.
+ */
+#if AUDIO_PACKED_24_BIT_ENABLE
+#define USB_DESCRIPTORS_TOTAL_LENGTH                                                                                   \
+    (27u + USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH + USB_DESCRIPTORS_CONTROL_LENGTH +                                 \
+     2u * USB_DESCRIPTORS_STREAMING_ALT_SETTING_LENGTH + USB_DESCRIPTORS_TELEMETRY_LENGTH +                            \
+     USB_DESCRIPTORS_CAPTURE_LENGTH)
+#else
+#define USB_DESCRIPTORS_TOTAL_LENGTH                                                                                   \
+    (27u + USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH + USB_DESCRIPTORS_CONTROL_LENGTH +                                 \
+     USB_DESCRIPTORS_STREAMING_ALT_SETTING_LENGTH + USB_DESCRIPTORS_TELEMETRY_LENGTH + USB_DESCRIPTORS_CAPTURE_LENGTH)
+#endif
+#else
+/**
+ * @brief The length of the feature unit descriptor, which holds a two-byte control bit mask for the master channel,
+ * and for each audio channel.
+ */
+#define USB_DESCRIPTORS_FEATURE_UNIT_LENGTH (7u + 2u * (AUDIO_CHANNEL_COUNT + 1u))
+
+/**
+ * @brief The length of a format type descriptor, which holds three bytes per sample rate.
+ */
+#define USB_DESCRIPTORS_FORMAT_TYPE_LENGTH (8u + 3u * USB_DESCRIPTORS_SAMPLE_RATE_COUNT)
+
+/**
+ * @brief The length of the capture input and output terminal descriptors, and of the second streaming interface
+ * number in the class-specific audio control interface descriptor.
+ */
+#if AUDIO_CAPTURE_ENABLE
+#define USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH 22u
+#else
+#define USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH 0u
+#endif
+
+/**
+ * @brief The total length of the class-specific audio control interface descriptors.
+ */
+#define USB_DESCRIPTORS_CONTROL_LENGTH                                                                                 \
+    (30u + USB_DESCRIPTORS_FEATURE_UNIT_LENGTH + USB_DESCRIPTORS_CAPTURE_CONTROL_LENGTH)
+
+/**
+ * @brief The length of an operational alternate setting of the audio streaming interface.
+ * @details Consists of the standard and class-specific interface descriptors, the format type descriptor, and the
+ * audio data and feedback endpoint descriptors.
+ */
+#define USB_DESCRIPTORS_STREAMING_ALT_SETTING_LENGTH (41u + USB_DESCRIPTORS_FORMAT_TYPE_LENGTH)
 
-// Configuration Descriptor tree for a UAC.
+/**
+ * @brief The length of the descriptors that the capture path adds.
+ * @details Consists of the capture terminals and of the capture streaming interface with its zero-bandwidth and
+ * operational alternate settings.
+ */
+#if AUDIO_CAPTURE_ENABLE
+#define USB_DESCRIPTORS_CAPTURE_LENGTH (63u + USB_DESCRIPTORS_FORMAT_TYPE_LENGTH)
+#else
+#define USB_DESCRIPTORS_CAPTURE_LENGTH 0u
+#endif
+
+#if AUDIO_PACKED_24_BIT_ENABLE
+#define USB_DESCRIPTORS_TOTAL_LENGTH                                                                                   \
+    (98u + USB_DESCRIPTORS_FORMAT_TYPE_LENGTH + USB_DESCRIPTORS_FEATURE_UNIT_LENGTH +                                  \
+     USB_DESCRIPTORS_STREAMING_ALT_SETTING_LENGTH + USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH +                         \
+     USB_DESCRIPTORS_TELEMETRY_LENGTH + USB_DESCRIPTORS_CAPTURE_LENGTH)
+#else
+#define USB_DESCRIPTORS_TOTAL_LENGTH                                                                                   \
+    (98u + USB_DESCRIPTORS_FORMAT_TYPE_LENGTH + USB_DESCRIPTORS_FEATURE_UNIT_LENGTH +                                  \
+     USB_DESCRIPTORS_AUDIO_ASSOCIATION_LENGTH + USB_DESCRIPTORS_TELEMETRY_LENGTH + USB_DESCRIPTORS_CAPTURE_LENGTH)
+#endif
+#endif
+
+// Configuration Descriptor tree for a UAC (v1 or v2).
 static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_LENGTH] = {
     // Configuration Descriptor. (UAC 4.2)
-    USB_DESC_CONFIGURATION(USB_DESCRIPTORS_TOTAL_LENGTH,  // wTotalLength.
-                           0x02u,                         // bNumInterfaces.
-                           0x01u,                         // bConfigurationValue.
-                           0u,                            // iConfiguration.
-                           0xC0u,                         // bmAttributes (self powered).
-                           50u),                          // bMaxPower (100mA).
+    USB_DESC_CONFIGURATION(USB_DESCRIPTORS_TOTAL_LENGTH,     // wTotalLength.
+                           USB_DESCRIPTORS_INTERFACE_COUNT,  // bNumInterfaces.
+                           0x01u,                            // bConfigurationValue.
+                           0u,                               // iConfiguration.
+                           0xC0u,                            // bmAttributes (self powered).
+                           50u),                             // bMaxPower (100mA).
+
+#if AUDIO_UAC2_ENABLE
+    // Interface Association Descriptor of the audio function (UAC2 4.6)
+    USB_DESC_INTERFACE_ASSOCIATION(USB_DESC_INTERFACE_CONTROL,                    // bFirstInterface.
+#if AUDIO_CAPTURE_ENABLE
+                                   0x03u,                                         // bInterfaceCount.
+#else
+                                   0x02u,                                         // bInterfaceCount.
+#endif
+                                   USB_DESC_INTERFACE_CLASS_AUDIO,                // bFunctionClass.
+                                   0x00u,                                         // bFunctionSubClass (undefined).
+                                   USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,  // bFunctionProtocol.
+                                   0u),                                           // iFunction.
+
+    // Standard Audio Control Interface Descriptor (UAC2 4.7.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_CONTROL,                       // bInterfaceNumber.
+                       0x00u,                                            // bAlternateSetting.
+                       0x00u,                                            // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                   // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_CONTROL,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,     // bInterfaceProtocol.
+                       0u),                                              // iInterface.
+
+    // Class-specific AC Interface Header Descriptor (UAC2 4.7.2)
+    USB_DESC_BYTE(9u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (Header).
+    USB_DESC_BCD(USB_DESC_ADC_VERSION),                     // bcdADC.
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_BYTE(0x08u),                                   // bCategory (I/O box).
+#else
+    USB_DESC_BYTE(0x01u),                                   // bCategory (desktop speaker).
+#endif
+    USB_DESC_WORD(USB_DESCRIPTORS_CONTROL_LENGTH),          // wTotalLength.
+    USB_DESC_BYTE(0x00u),                                   // bmControls (no latency control).
+
+    // Clock Source Descriptor (UAC2 4.7.2.1)
+    USB_DESC_BYTE(8u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(0x0Au),                                   // bDescriptorSubtype (Clock Source).
+    USB_DESC_BYTE(USB_DESC_UNIT_CLOCK_SOURCE),              // bClockID.
+    USB_DESC_BYTE(0x03u),                                   // bmAttributes (internal programmable clock).
+    USB_DESC_BYTE(0x07u),                                   // bmControls (programmable frequency, read-only validity).
+    USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
+    USB_DESC_BYTE(0x00u),                                   // iClockSource (none).
+
+    // Input Terminal Descriptor (UAC2 4.7.2.4)
+    USB_DESC_BYTE(17u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_INPUT),            // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                     // bTerminalID.
+    USB_DESC_WORD(USB_DESC_TERMINAL_TYPE_STREAMING),        // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
+    USB_DESC_BYTE(USB_DESC_UNIT_CLOCK_SOURCE),              // bCSourceID.
+    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                     // bNrChannels.
+    USB_DESC_DWORD(USB_DESCRIPTORS_CHANNEL_CONFIG),         // bmChannelConfig.
+    USB_DESC_BYTE(0x00u),                                   // iChannelNames (none).
+    USB_DESC_WORD(0x0000u),                                 // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
+
+    // Feature Unit Descriptor (UAC2 4.7.2.8)
+    USB_DESC_BYTE(USB_DESCRIPTORS_FEATURE_UNIT_LENGTH),                                  // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),                               // bDescriptorType.
+    USB_DESC_BYTE(0x06u),                                                                // bDescriptorSubtype (FU).
+    USB_DESC_BYTE(USB_DESC_UNIT_FUNCTION),                                               // bUnitID.
+    USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                                                  // bSourceID.
+    USB_DESC_DWORD(USB_DESC_UAC2_FU_CONTROLS_NONE),                                      // Master controls.
+    USB_DESC_DWORD(USB_DESC_UAC2_FU_CONTROLS_MUTE | USB_DESC_UAC2_FU_CONTROLS_VOLUME),  // Channel 0 controls
+    USB_DESC_DWORD(USB_DESC_UAC2_FU_CONTROLS_MUTE | USB_DESC_UAC2_FU_CONTROLS_VOLUME),  // Channel 1 controls
+#if AUDIO_TDM_ENABLE
+    USB_DESC_DWORD(USB_DESC_UAC2_FU_CONTROLS_MUTE | USB_DESC_UAC2_FU_CONTROLS_VOLUME),  // Channel 2 controls
+    USB_DESC_DWORD(USB_DESC_UAC2_FU_CONTROLS_MUTE | USB_DESC_UAC2_FU_CONTROLS_VOLUME),  // Channel 3 controls
+#endif
+    USB_DESC_BYTE(0x00u),                                                                // iFeature (none)
+
+    // Output Terminal Descriptor (UAC2 4.7.2.5)
+    USB_DESC_BYTE(12u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_OUTPUT),           // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_OUTPUT),                    // bTerminalID.
+    USB_DESC_WORD(USB_DESC_OUTPUT_TERMINAL_TYPE_SPEAKER),   // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
+    USB_DESC_BYTE(USB_DESC_UNIT_FUNCTION),                  // bSourceID.
+    USB_DESC_BYTE(USB_DESC_UNIT_CLOCK_SOURCE),              // bCSourceID.
+    USB_DESC_WORD(0x0000u),                                 // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
+
+#if AUDIO_CAPTURE_ENABLE
+    // Capture Input Terminal Descriptor (UAC2 4.7.2.4)
+    USB_DESC_BYTE(17u),                                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),                   // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_INPUT),                             // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_INPUT),                              // bTerminalID.
+    USB_DESC_WORD(USB_DESC_EXTERNAL_TERMINAL_TYPE_DIGITAL_AUDIO_INTERFACE),  // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                                    // bAssocTerminal (none).
+    USB_DESC_BYTE(USB_DESC_UNIT_CLOCK_SOURCE),                               // bCSourceID.
+    USB_DESC_BYTE(AUDIO_CAPTURE_CHANNEL_COUNT),                              // bNrChannels.
+    USB_DESC_DWORD(USB_DESCRIPTORS_CAPTURE_CHANNEL_CONFIG),                  // bmChannelConfig.
+    USB_DESC_BYTE(0x00u),                                                    // iChannelNames (none).
+    USB_DESC_WORD(0x0000u),                                                  // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                                    // iTerminal (none).
+
+    // Capture Output Terminal Descriptor (UAC2 4.7.2.5)
+    USB_DESC_BYTE(12u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_OUTPUT),           // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_OUTPUT),            // bTerminalID.
+    USB_DESC_WORD(USB_DESC_TERMINAL_TYPE_STREAMING),        // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_INPUT),             // bSourceID.
+    USB_DESC_BYTE(USB_DESC_UNIT_CLOCK_SOURCE),              // bCSourceID.
+    USB_DESC_WORD(0x0000u),                                 // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
+#endif
+
+    // Standard AS Interface Descriptor (zero-bandwidth) (UAC2 4.9.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_STREAMING,                       // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW,             // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_ZERO_BANDWIDTH,             // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,       // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Standard AS Interface Descriptor (operational) (UAC2 4.9.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_STREAMING,                       // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL,         // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_OPERATIONAL,                // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,       // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
 
+    // Class-specific AS Interface Descriptor (UAC2 4.9.2)
+    USB_DESC_BYTE(16u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (general).
+    USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                     // bTerminalLink.
+    USB_DESC_BYTE(0x00u),                                   // bmControls (none).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
+    USB_DESC_DWORD(0x00000001u),                            // bmFormats (PCM).
+    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                     // bNrChannels.
+    USB_DESC_DWORD(USB_DESCRIPTORS_CHANNEL_CONFIG),         // bmChannelConfig.
+    USB_DESC_BYTE(0x00u),                                   // iChannelNames (none).
+
+    // Class-Specific AS Format Type Descriptor (UAC2 Frmts 2.3.1.6)
+    USB_DESC_BYTE(6u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                   // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_SAMPLE_SIZE),                       // bSubslotSize.
+    USB_DESC_BYTE(AUDIO_RESOLUTION_BIT),                    // bBitResolution.
+
+    // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.1)
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_PLAYBACK,  // bEndpointAddress.
+                      0x05u,                       // bmAttributes (asynchronous isochronous).
+                      AUDIO_MAX_PACKET_SIZE,       // wMaxPacketSize.
+                      USB_DESC_FS_BINTERVAL),      // bInterval.
+
+    // C-S AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.2)
+    USB_DESC_BYTE(8u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_ENDPOINT),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                  // bDescriptorSubtype (General).
+    USB_DESC_BYTE(0x00u),                                  // bmAttributes (none).
+    USB_DESC_BYTE(0x00u),                                  // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                  // bLockDelayUnits (undefined).
+    USB_DESC_WORD(0x0000u),                                // wLockDelay (0).
+
+    // Standard AS Isochronous Feedback Endpoint Descriptor (UAC2 4.10.2.1)
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_FEEDBACK | 0x80u,    // bEndpointAddress.
+                      USB_EP_MODE_TYPE_ISOC | 0x10u,         // bmAttributes (isochronous feedback).
+                      USB_DESC_MAX_IN_SIZE,                  // wMaxPacketSize.
+                      AUDIO_FEEDBACK_PERIOD_EXPONENT + 1u),  // bInterval (2^(bInterval - 1) ms).
+
+#if AUDIO_PACKED_24_BIT_ENABLE
+    // Standard AS Interface Descriptor (operational, packed 24 bit) (UAC2 4.9.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_STREAMING,                       // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_PACKED_24_BIT,       // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_OPERATIONAL,                // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,       // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Class-specific AS Interface Descriptor (UAC2 4.9.2)
+    USB_DESC_BYTE(16u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (general).
+    USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                     // bTerminalLink.
+    USB_DESC_BYTE(0x00u),                                   // bmControls (none).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
+    USB_DESC_DWORD(0x00000001u),                            // bmFormats (PCM).
+    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                     // bNrChannels.
+    USB_DESC_DWORD(USB_DESCRIPTORS_CHANNEL_CONFIG),         // bmChannelConfig.
+    USB_DESC_BYTE(0x00u),                                   // iChannelNames (none).
+
+    // Class-Specific AS Format Type Descriptor (UAC2 Frmts 2.3.1.6)
+    USB_DESC_BYTE(6u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                   // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_PACKED_SAMPLE_SIZE),                // bSubslotSize.
+    USB_DESC_BYTE(AUDIO_PACKED_RESOLUTION_BIT),             // bBitResolution.
+
+    // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.1)
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_PLAYBACK,    // bEndpointAddress.
+                      0x05u,                         // bmAttributes (asynchronous isochronous).
+                      AUDIO_MAX_PACKED_PACKET_SIZE,  // wMaxPacketSize.
+                      USB_DESC_FS_BINTERVAL),        // bInterval.
+
+    // C-S AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.2)
+    USB_DESC_BYTE(8u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_ENDPOINT),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                  // bDescriptorSubtype (General).
+    USB_DESC_BYTE(0x00u),                                  // bmAttributes (none).
+    USB_DESC_BYTE(0x00u),                                  // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                  // bLockDelayUnits (undefined).
+    USB_DESC_WORD(0x0000u),                                // wLockDelay (0).
+
+    // Standard AS Isochronous Feedback Endpoint Descriptor (UAC2 4.10.2.1)
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_FEEDBACK | 0x80u,    // bEndpointAddress.
+                      USB_EP_MODE_TYPE_ISOC | 0x10u,         // bmAttributes (isochronous feedback).
+                      USB_DESC_MAX_IN_SIZE,                  // wMaxPacketSize.
+                      AUDIO_FEEDBACK_PERIOD_EXPONENT + 1u),  // bInterval (2^(bInterval - 1) ms).
+#endif
+
+#if AUDIO_CAPTURE_ENABLE
+    // Standard AS Interface Descriptor (capture, zero-bandwidth) (UAC2 4.9.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_CAPTURE,                         // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW,             // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_ZERO_BANDWIDTH,             // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,       // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Standard AS Interface Descriptor (capture, operational) (UAC2 4.9.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_CAPTURE,                         // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL,         // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_CAPTURE,                    // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_IP_VERSION_02_00,       // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Class-specific AS Interface Descriptor (UAC2 4.9.2)
+    USB_DESC_BYTE(16u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),   // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x01u),                                    // bDescriptorSubtype (general).
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_OUTPUT),             // bTerminalLink.
+    USB_DESC_BYTE(0x00u),                                    // bmControls (none).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),             // bFormatType (Type I).
+    USB_DESC_DWORD(0x00000001u),                             // bmFormats (PCM).
+    USB_DESC_BYTE(AUDIO_CAPTURE_CHANNEL_COUNT),              // bNrChannels.
+    USB_DESC_DWORD(USB_DESCRIPTORS_CAPTURE_CHANNEL_CONFIG),  // bmChannelConfig.
+    USB_DESC_BYTE(0x00u),                                    // iChannelNames (none).
+
+    // Class-Specific AS Format Type Descriptor (UAC2 Frmts 2.3.1.6)
+    USB_DESC_BYTE(6u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                   // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_CAPTURE_SAMPLE_SIZE),               // bSubslotSize.
+    USB_DESC_BYTE(AUDIO_CAPTURE_RESOLUTION_BIT),            // bBitResolution.
+
+    // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.1)
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_CAPTURE | 0x80u,  // bEndpointAddress.
+                      0x05u,                              // bmAttributes (asynchronous isochronous).
+                      AUDIO_CAPTURE_MAX_PACKET_SIZE,      // wMaxPacketSize.
+                      USB_DESC_FS_BINTERVAL),             // bInterval.
+
+    // C-S AS Isochronous Audio Data Endpoint Descriptor (UAC2 4.10.1.2)
+    USB_DESC_BYTE(8u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_ENDPOINT),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                  // bDescriptorSubtype (General).
+    USB_DESC_BYTE(0x00u),                                  // bmAttributes (none).
+    USB_DESC_BYTE(0x00u),                                  // bmControls (none).
+    USB_DESC_BYTE(0x00u),                                  // bLockDelayUnits (undefined).
+    USB_DESC_WORD(0x0000u),                                // wLockDelay (0).
+#endif
+#else
+#if USB_TELEMETRY_ENABLE
+    // Interface Association Descriptor of the audio function.
+    USB_DESC_INTERFACE_ASSOCIATION(USB_DESC_INTERFACE_CONTROL,             // bFirstInterface.
+                                   0x02u,                                  // bInterfaceCount.
+                                   USB_DESC_INTERFACE_CLASS_AUDIO,         // bFunctionClass.
+                                   0x00u,                                  // bFunctionSubClass (undefined).
+                                   USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,  // bFunctionProtocol.
+                                   0u),                                    // iFunction.
+
+#endif
     // Standard Audio Control Interface Descriptor (UAC 4.3.1)
     USB_DESC_INTERFACE(USB_DESC_INTERFACE_CONTROL,                       // bInterfaceNumber.
                        0x00u,                                            // bAlternateSetting.
@@ -222,13 +808,23 @@ static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_L
                        0u),                                              // iInterface.
 
     // Class-specific AC Interface Descriptor (UAC 4.3.2)
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_BYTE(10u),                                     // bLength.
+#else
     USB_DESC_BYTE(9u),                                      // bLength.
+#endif
     USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
     USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (Header).
     USB_DESC_BCD(USB_DESC_ADC_VERSION),                     // bcdADC.
-    USB_DESC_WORD(43u),                                     // wTotalLength.
+    USB_DESC_WORD(USB_DESCRIPTORS_CONTROL_LENGTH),          // wTotalLength.
+#if AUDIO_CAPTURE_ENABLE
+    USB_DESC_BYTE(0x02u),                                   // bInCollection (2 streaming interfaces).
+    USB_DESC_BYTE(USB_DESC_INTERFACE_STREAMING),            // baInterfaceNr(1).
+    USB_DESC_BYTE(USB_DESC_INTERFACE_CAPTURE),              // baInterfaceNr(2).
+#else
     USB_DESC_BYTE(0x01u),                                   // bInCollection (1 streaming interface).
     USB_DESC_BYTE(USB_DESC_INTERFACE_STREAMING),            // baInterfaceNr.
+#endif
 
     // Input Terminal Descriptor (UAC 4.3.2.1)
     USB_DESC_BYTE(12u),                                     // bLength.
@@ -238,21 +834,24 @@ static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_L
     USB_DESC_WORD(USB_DESC_TERMINAL_TYPE_STREAMING),        // wTerminalType.
     USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
     USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                     // bNrChannels.
-    USB_DESC_WORD(USB_DESC_CHANNEL_CONFIG_RIGHT_FRONT |
-                  USB_DESC_CHANNEL_CONFIG_LEFT_FRONT),  // wChannelConfig (left, right).
-    USB_DESC_BYTE(0x00u),                               // iChannelNames (none).
-    USB_DESC_BYTE(0x00u),                               // iTerminal (none).
+    USB_DESC_WORD(USB_DESCRIPTORS_CHANNEL_CONFIG),          // wChannelConfig.
+    USB_DESC_BYTE(0x00u),                                   // iChannelNames (none).
+    USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
 
     // Feature Unit Descriptor (UAC 4.3.2.5)
-    USB_DESC_BYTE(13u),                                                      // bLength.
+    USB_DESC_BYTE(USB_DESCRIPTORS_FEATURE_UNIT_LENGTH),                      // bLength.
     USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),                   // bDescriptorType.
     USB_DESC_BYTE(0x06u),                                                    // bDescriptorSubtype (Feature Unit).
     USB_DESC_BYTE(USB_DESC_UNIT_FUNCTION),                                   // bUnitID.
     USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                                      // bSourceID.
-    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                                      // bControlSize.
+    USB_DESC_BYTE(0x02u),                                                    // bControlSize.
     USB_DESC_WORD(USB_DESC_FU_CONTROLS_NONE),                                // Master controls.
     USB_DESC_WORD(USB_DESC_FU_CONTROLS_MUTE | USB_DESC_FU_CONTROLS_VOLUME),  // Channel 0 controls
     USB_DESC_WORD(USB_DESC_FU_CONTROLS_MUTE | USB_DESC_FU_CONTROLS_VOLUME),  // Channel 1 controls
+#if AUDIO_TDM_ENABLE
+    USB_DESC_WORD(USB_DESC_FU_CONTROLS_MUTE | USB_DESC_FU_CONTROLS_VOLUME),  // Channel 2 controls
+    USB_DESC_WORD(USB_DESC_FU_CONTROLS_MUTE | USB_DESC_FU_CONTROLS_VOLUME),  // Channel 3 controls
+#endif
     USB_DESC_BYTE(0x00u),                                                    // iFeature (none)
 
     // Output Terminal Descriptor (UAC 4.3.2.2)
@@ -265,6 +864,30 @@ static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_L
     USB_DESC_BYTE(USB_DESC_UNIT_FUNCTION),                  // bSourceID.
     USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
 
+#if AUDIO_CAPTURE_ENABLE
+    // Capture Input Terminal Descriptor (UAC 4.3.2.1)
+    USB_DESC_BYTE(12u),                                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),                   // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_INPUT),                             // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_INPUT),                              // bTerminalID.
+    USB_DESC_WORD(USB_DESC_EXTERNAL_TERMINAL_TYPE_DIGITAL_AUDIO_INTERFACE),  // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                                    // bAssocTerminal (none).
+    USB_DESC_BYTE(AUDIO_CAPTURE_CHANNEL_COUNT),                              // bNrChannels.
+    USB_DESC_WORD(USB_DESCRIPTORS_CAPTURE_CHANNEL_CONFIG),                   // wChannelConfig.
+    USB_DESC_BYTE(0x00u),                                                    // iChannelNames (none).
+    USB_DESC_BYTE(0x00u),                                                    // iTerminal (none).
+
+    // Capture Output Terminal Descriptor (UAC 4.3.2.2)
+    USB_DESC_BYTE(9u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType.
+    USB_DESC_BYTE(USB_DESC_TERMINAL_TYPE_OUTPUT),           // bDescriptorSubtype.
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_OUTPUT),            // bTerminalID.
+    USB_DESC_WORD(USB_DESC_TERMINAL_TYPE_STREAMING),        // wTerminalType.
+    USB_DESC_BYTE(0x00u),                                   // bAssocTerminal (none).
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_INPUT),             // bSourceID.
+    USB_DESC_BYTE(0x00u),                                   // iTerminal (none).
+#endif
+
     // Standard AS Interface Descriptor (zero-bandwidth) (UAC 4.5.1)
     USB_DESC_INTERFACE(USB_DESC_INTERFACE_STREAMING,                       // bInterfaceNumber.
                        USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW,             // bAlternateSetting.
@@ -292,20 +915,28 @@ static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_L
     USB_DESC_WORD(0x0001u),                                 // wFormatTag (PCM format).
 
     // Class-Specific AS Format Type Descriptor (UAC 4.5.3)
-    USB_DESC_BYTE(14u),                                     // bLength.
-    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
-    USB_DESC_BYTE(0x02u),                                   // bDescriptorSubtype (Format).
-    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),            // bFormatType (Type I).
-    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                     // bNrChannels.
-    USB_DESC_BYTE(AUDIO_SAMPLE_SIZE),                       // bSubframeSize.
-    USB_DESC_BYTE(AUDIO_RESOLUTION_BIT),                    // bBitResolution.
-    USB_DESC_BYTE(0x02u),                                   // bSamFreqType (Type I).
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 0u)),  // Audio sampling frequency, byte 0.
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 1u)),  // Audio sampling frequency, byte 1.
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 2u)),  // Audio sampling frequency, byte 2.
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 0u)),  // Audio sampling frequency, byte 0.
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 1u)),  // Audio sampling frequency, byte 1.
-    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(USB_DESCRIPTORS_FORMAT_TYPE_LENGTH),        // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),    // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                     // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),              // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                       // bNrChannels.
+    USB_DESC_BYTE(AUDIO_SAMPLE_SIZE),                         // bSubframeSize.
+    USB_DESC_BYTE(AUDIO_RESOLUTION_BIT),                      // bBitResolution.
+    USB_DESC_BYTE(USB_DESCRIPTORS_SAMPLE_RATE_COUNT),         // bSamFreqType (Type I).
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#endif
 
     // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC 4.6.1.1)
     USB_DESC_BYTE(9u),                                  // bLength (9).
@@ -334,6 +965,221 @@ static const uint8_t audio_configuration_descriptor_data[USB_DESCRIPTORS_TOTAL_L
     USB_DESC_BYTE(USB_DESC_FS_BINTERVAL),               // bInterval (1 ms).
     USB_DESC_BYTE(AUDIO_FEEDBACK_PERIOD_EXPONENT),      // bRefresh.
     USB_DESC_BYTE(0x00u),                               // bSynchAddress (none).
+
+#if AUDIO_PACKED_24_BIT_ENABLE
+    // Standard AS Interface Descriptor (operational, packed 24 bit) (UAC 4.5.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_STREAMING,                       // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_PACKED_24_BIT,       // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_OPERATIONAL,                // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,              // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Class-specific AS Interface Descriptor (UAC 4.5.2)
+    USB_DESC_BYTE(7u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (general).
+    USB_DESC_BYTE(USB_DESC_UNIT_INPUT),                     // bTerminalLink.
+    USB_DESC_BYTE(0x00u),                                   // bDelay (none).
+    USB_DESC_WORD(0x0001u),                                 // wFormatTag (PCM format).
+
+    // Class-Specific AS Format Type Descriptor (UAC 4.5.3)
+    USB_DESC_BYTE(USB_DESCRIPTORS_FORMAT_TYPE_LENGTH),        // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),    // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                     // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),              // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_CHANNEL_COUNT),                       // bNrChannels.
+    USB_DESC_BYTE(AUDIO_PACKED_SAMPLE_SIZE),                  // bSubframeSize.
+    USB_DESC_BYTE(AUDIO_PACKED_RESOLUTION_BIT),               // bBitResolution.
+    USB_DESC_BYTE(USB_DESCRIPTORS_SAMPLE_RATE_COUNT),         // bSamFreqType (Type I).
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#endif
+
+    // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC 4.6.1.1)
+    USB_DESC_BYTE(9u),                                  // bLength (9).
+    USB_DESC_BYTE(0x05u),                               // bDescriptorType (Endpoint).
+    USB_DESC_BYTE(USB_DESC_ENDPOINT_PLAYBACK),          // bEndpointAddress.
+    USB_DESC_BYTE(0x05u),                               // bmAttributes (asynchronous isochronous).
+    USB_DESC_WORD(AUDIO_MAX_PACKED_PACKET_SIZE),        // wMaxPacketSize
+    USB_DESC_BYTE(USB_DESC_FS_BINTERVAL),               // bInterval.
+    USB_DESC_BYTE(0x00u),                               // bRefresh (0).
+    USB_DESC_BYTE(USB_DESC_ENDPOINT_FEEDBACK | 0x80u),  // bSynchAddress.
+
+    // C-S AS Isochronous Audio Data Endpoint Descriptor (UAC 4.6.1.2)
+    USB_DESC_BYTE(7u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_ENDPOINT),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                  // bDescriptorSubtype (General).
+    USB_DESC_BYTE(0x01u),                                  // bmAttributes - support sampling frequency adjustment.
+    USB_DESC_BYTE(0x02u),                                  // bLockDelayUnits (PCM sample count).
+    USB_DESC_WORD(0x0000u),                                // bLockDelay (0).
+
+    // Standard Isochronous Audio Feedback Endpoint Descriptor
+    USB_DESC_BYTE(9u),                                  // bLength (9).
+    USB_DESC_BYTE(0x05u),                               // bDescriptorType (Endpoint).
+    USB_DESC_BYTE(USB_DESC_ENDPOINT_FEEDBACK | 0x80u),  // bEndpointAddress.
+    USB_DESC_BYTE(USB_EP_MODE_TYPE_ISOC),               // bmAttributes.
+    USB_DESC_WORD(USB_DESC_MAX_IN_SIZE),                // wMaxPacketSize
+    USB_DESC_BYTE(USB_DESC_FS_BINTERVAL),               // bInterval (1 ms).
+    USB_DESC_BYTE(AUDIO_FEEDBACK_PERIOD_EXPONENT),      // bRefresh.
+    USB_DESC_BYTE(0x00u),                               // bSynchAddress (none).
+#endif
+
+#if AUDIO_CAPTURE_ENABLE
+    // Standard AS Interface Descriptor (capture, zero-bandwidth) (UAC 4.5.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_CAPTURE,                         // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_ZERO_BW,             // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_ZERO_BANDWIDTH,             // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,              // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Standard AS Interface Descriptor (capture, operational) (UAC 4.5.1)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_CAPTURE,                         // bInterfaceNumber.
+                       USB_DESC_INTERFACE_ALT_SETTING_OPERATIONAL,         // bAlternateSetting.
+                       USB_DESC_ENDPOINT_COUNT_CAPTURE,                    // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_AUDIO,                     // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_AUDIO_SUBCLASS_STREAMING,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,              // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),                           // iInterface.
+
+    // Class-specific AS Interface Descriptor (UAC 4.5.2)
+    USB_DESC_BYTE(7u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x01u),                                   // bDescriptorSubtype (general).
+    USB_DESC_BYTE(USB_DESC_UNIT_CAPTURE_OUTPUT),            // bTerminalLink.
+    USB_DESC_BYTE(0x00u),                                   // bDelay (none).
+    USB_DESC_WORD(0x0001u),                                 // wFormatTag (PCM format).
+
+    // Class-Specific AS Format Type Descriptor (UAC 4.5.3)
+    USB_DESC_BYTE(USB_DESCRIPTORS_FORMAT_TYPE_LENGTH),        // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),    // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(0x02u),                                     // bDescriptorSubtype (Format).
+    USB_DESC_BYTE(USB_DESC_AUDIO_FORMAT_TYPE_I),              // bFormatType (Type I).
+    USB_DESC_BYTE(AUDIO_CAPTURE_CHANNEL_COUNT),               // bNrChannels.
+    USB_DESC_BYTE(AUDIO_CAPTURE_SAMPLE_SIZE),                 // bSubframeSize.
+    USB_DESC_BYTE(AUDIO_CAPTURE_RESOLUTION_BIT),              // bBitResolution.
+    USB_DESC_BYTE(USB_DESCRIPTORS_SAMPLE_RATE_COUNT),         // bSamFreqType (Type I).
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_44_1_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_48_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#if AUDIO_HIGH_SAMPLE_RATE_ENABLE
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 0u)),  // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 1u)),  // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_88_2_KHZ, 2u)),  // Audio sampling frequency, byte 2.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 0u)),    // Audio sampling frequency, byte 0.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 1u)),    // Audio sampling frequency, byte 1.
+    USB_DESC_BYTE(GET_BYTE(AUDIO_SAMPLE_RATE_96_KHZ, 2u)),    // Audio sampling frequency, byte 2.
+#endif
+
+    // Standard AS Isochronous Audio Data Endpoint Descriptor (UAC 4.6.1.1)
+    USB_DESC_BYTE(9u),                                 // bLength (9).
+    USB_DESC_BYTE(0x05u),                              // bDescriptorType (Endpoint).
+    USB_DESC_BYTE(USB_DESC_ENDPOINT_CAPTURE | 0x80u),  // bEndpointAddress.
+    USB_DESC_BYTE(0x05u),                              // bmAttributes (asynchronous isochronous).
+    USB_DESC_WORD(AUDIO_CAPTURE_MAX_PACKET_SIZE),      // wMaxPacketSize
+    USB_DESC_BYTE(USB_DESC_FS_BINTERVAL),              // bInterval.
+    USB_DESC_BYTE(0x00u),                              // bRefresh (0).
+    USB_DESC_BYTE(0x00u),                              // bSynchAddress (none).
+
+    // C-S AS Isochronous Audio Data Endpoint Descriptor (UAC 4.6.1.2)
+    USB_DESC_BYTE(7u),                                     // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_ENDPOINT),  // bDescriptorType.
+    USB_DESC_BYTE(0x01u),                                  // bDescriptorSubtype (General).
+    USB_DESC_BYTE(0x01u),                                  // bmAttributes - support sampling frequency adjustment.
+    USB_DESC_BYTE(0x02u),                                  // bLockDelayUnits (PCM sample count).
+    USB_DESC_WORD(0x0000u),                                // bLockDelay (0).
+#endif
+
+#endif
+
+#if USB_TELEMETRY_ENABLE
+    // Interface Association Descriptor of the telemetry function.
+    USB_DESC_INTERFACE_ASSOCIATION(USB_DESC_INTERFACE_TELEMETRY_CONTROL,       // bFirstInterface.
+                                   0x02u,                                      // bInterfaceCount.
+                                   USB_DESC_INTERFACE_CLASS_CDC,               // bFunctionClass.
+                                   USB_DESC_INTERFACE_CLASS_CDC_SUBCLASS_ACM,  // bFunctionSubClass.
+                                   USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,      // bFunctionProtocol (none).
+                                   0u),                                        // iFunction.
+
+    // Communications Class Interface Descriptor (CDC 5.1.3)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_TELEMETRY_CONTROL,       // bInterfaceNumber.
+                       0x00u,                                      // bAlternateSetting.
+                       0x01u,                                      // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_CDC,               // bInterfaceClass.
+                       USB_DESC_INTERFACE_CLASS_CDC_SUBCLASS_ACM,  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,      // bInterfaceProtocol (none).
+                       USB_DESC_INTERFACE_NONE),                   // iInterface.
+
+    // Header Functional Descriptor (CDC 5.2.3.1)
+    USB_DESC_BYTE(5u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(USB_DESC_CDC_FUNCTIONAL_SUBTYPE_HEADER),  // bDescriptorSubtype (Header).
+    USB_DESC_BCD(USB_DESC_CDC_VERSION),                     // bcdCDC.
+
+    // Call Management Functional Descriptor (PSTN 5.3.1)
+    USB_DESC_BYTE(5u),                                         // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),     // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(USB_DESC_CDC_FUNCTIONAL_SUBTYPE_CALL_MGMT),  // bDescriptorSubtype (Call Management).
+    USB_DESC_BYTE(0x00u),                                      // bmCapabilities (no call management).
+    USB_DESC_BYTE(USB_DESC_INTERFACE_TELEMETRY_DATA),          // bDataInterface.
+
+    // Abstract Control Management Functional Descriptor (PSTN 5.3.2)
+    USB_DESC_BYTE(4u),                                             // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),         // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(USB_DESC_CDC_FUNCTIONAL_SUBTYPE_ACM),            // bDescriptorSubtype (ACM).
+    USB_DESC_BYTE(USB_DESC_CDC_ACM_CAPABILITY_LINE_CODING_STATE),  // bmCapabilities.
+
+    // Union Functional Descriptor (CDC 5.2.3.2)
+    USB_DESC_BYTE(5u),                                      // bLength.
+    USB_DESC_BYTE(USB_DESC_CLASS_SPECIFIC_TYPE_INTERFACE),  // bDescriptorType (CS_INTERFACE).
+    USB_DESC_BYTE(USB_DESC_CDC_FUNCTIONAL_SUBTYPE_UNION),   // bDescriptorSubtype (Union).
+    USB_DESC_BYTE(USB_DESC_INTERFACE_TELEMETRY_CONTROL),    // bMasterInterface.
+    USB_DESC_BYTE(USB_DESC_INTERFACE_TELEMETRY_DATA),       // bSlaveInterface0.
+
+    // Notification Endpoint Descriptor
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_TELEMETRY_NOTIFICATION | 0x80u,  // bEndpointAddress.
+                      0x03u,                                            // bmAttributes (Interrupt).
+                      USB_DESC_TELEMETRY_NOTIFICATION_SIZE,             // wMaxPacketSize.
+                      USB_DESC_TELEMETRY_NOTIFICATION_BINTERVAL),       // bInterval.
+
+    // Data Class Interface Descriptor (CDC 5.1.3)
+    USB_DESC_INTERFACE(USB_DESC_INTERFACE_TELEMETRY_DATA,      // bInterfaceNumber.
+                       0x00u,                                  // bAlternateSetting.
+                       0x02u,                                  // bNumEndpoints.
+                       USB_DESC_INTERFACE_CLASS_CDC_DATA,      // bInterfaceClass.
+                       0x00u,                                  // bInterfaceSubClass.
+                       USB_DESC_INTERFACE_PROTOCOL_UNDEFINED,  // bInterfaceProtocol.
+                       USB_DESC_INTERFACE_NONE),               // iInterface.
+
+    // Data Out Endpoint Descriptor
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_TELEMETRY_DATA,  // bEndpointAddress.
+                      0x02u,                             // bmAttributes (Bulk).
+                      USB_DESC_TELEMETRY_DATA_OUT_SIZE,  // wMaxPacketSize.
+                      0x00u),                            // bInterval (ignored for bulk).
+
+    // Data In Endpoint Descriptor
+    USB_DESC_ENDPOINT(USB_DESC_ENDPOINT_TELEMETRY_DATA | 0x80u,  // bEndpointAddress.
+                      0x02u,                                    // bmAttributes (Bulk).
+                      USB_DESC_TELEMETRY_DATA_IN_SIZE,          // wMaxPacketSize.
+                      0x00u),                                   // bInterval (ignored for bulk).
+#endif
 };
 
 // Configuration Descriptor wrapper.
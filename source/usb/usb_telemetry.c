@@ -0,0 +1,136 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   USB CDC-ACM telemetry function.
+ * @details Provides a virtual serial port next to the audio function, which carries the formatted event log
+ * (statistics, profiling, and diagnostic events) to the host. Uses the ChibiOS serial over USB driver.
+ *
+ * The data endpoint is a bulk endpoint, so that it only uses bus time that the isochronous audio endpoints leave
+ * unused. Its OUT direction has the smallest full-speed packet size. Data from the host is never read, so that the
+ * host is NAKed as soon as the input queue is full. Thus, the function does not compete with the playback endpoint for
+ * RX FIFO space.
+ *
+ * @addtogroup usb
+ * @{
+ */
+
+#include "usb_telemetry.h"
+
+#include "usb.h"
+
+#if USB_TELEMETRY_ENABLE
+/**
+ * @brief The serial over USB driver of the telemetry function.
+ */
+SerialUSBDriver SDU1;
+
+/**
+ * @brief Settings structure for the serial over USB driver.
+ */
+static const SerialUSBConfig g_usb_telemetry_config = {
+    .usbp     = &USB_DRIVER,
+    .bulk_in  = USB_DESC_ENDPOINT_TELEMETRY_DATA,
+    .bulk_out = USB_DESC_ENDPOINT_TELEMETRY_DATA,
+    .int_in   = USB_DESC_ENDPOINT_TELEMETRY_NOTIFICATION,
+};
+
+/**
+ * @brief A structure that holds the IN state of the telemetry data endpoint.
+ */
+static USBInEndpointState data_endpoint_in_state;
+
+/**
+ * @brief A structure that holds the OUT state of the telemetry data endpoint.
+ */
+static USBOutEndpointState data_endpoint_out_state;
+
+/**
+ * @brief The configuration structure for the telemetry data endpoint.
+ */
+static const USBEndpointConfig data_endpoint_config = {.ep_mode       = USB_EP_MODE_TYPE_BULK,
+                                                       .setup_cb      = NULL,
+                                                       .in_cb         = sduDataTransmitted,
+                                                       .out_cb        = sduDataReceived,
+                                                       .in_maxsize    = USB_DESC_TELEMETRY_DATA_IN_SIZE,
+                                                       .out_maxsize   = USB_DESC_TELEMETRY_DATA_OUT_SIZE,
+                                                       .in_state      = &data_endpoint_in_state,
+                                                       .out_state     = &data_endpoint_out_state,
+                                                       .in_multiplier = 1u,
+                                                       .setup_buf     = NULL};
+
+/**
+ * @brief A structure that holds the state of the telemetry notification endpoint.
+ */
+static USBInEndpointState notification_endpoint_in_state;
+
+/**
+ * @brief The configuration structure for the telemetry notification endpoint.
+ */
+static const USBEndpointConfig notification_endpoint_config = {.ep_mode       = USB_EP_MODE_TYPE_INTR,
+                                                               .setup_cb      = NULL,
+                                                               .in_cb         = sduInterruptTransmitted,
+                                                               .out_cb        = NULL,
+                                                               .in_maxsize    = USB_DESC_TELEMETRY_NOTIFICATION_SIZE,
+                                                               .out_maxsize   = 0u,
+                                                               .in_state      = &notification_endpoint_in_state,
+                                                               .out_state     = NULL,
+                                                               .in_multiplier = 1u,
+                                                               .setup_buf     = NULL};
+
+/**
+ * @brief Enable the telemetry endpoints, after the host selected the configuration.
+ *
+ * @param p_usb The pointer to the USB driver structure.
+ */
+void usb_telemetry_configure_hook_i(USBDriver *p_usb) {
+    usbInitEndpointI(p_usb, USB_DESC_ENDPOINT_TELEMETRY_DATA, &data_endpoint_config);
+    usbInitEndpointI(p_usb, USB_DESC_ENDPOINT_TELEMETRY_NOTIFICATION, &notification_endpoint_config);
+
+    sduConfigureHookI(&SDU1);
+}
+
+/**
+ * @brief Disconnect the serial port, on USB reset, unconfigure, or suspend.
+ */
+void usb_telemetry_suspend_hook_i(void) { sduSuspendHookI(&SDU1); }
+
+/**
+ * @brief Resume the serial port, on USB wakeup.
+ */
+void usb_telemetry_wakeup_hook_i(void) { sduWakeupHookI(&SDU1); }
+
+/**
+ * @brief Flush partially filled telemetry buffers at every SOF.
+ *
+ * @param p_usb The pointer to the USB driver structure (unused).
+ */
+void usb_telemetry_sof_cb(USBDriver *p_usb) {
+    (void)p_usb;
+
+    chSysLockFromISR();
+    sduSOFHookI(&SDU1);
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Handle CDC class requests (line coding and control line state).
+ *
+ * @param p_usb The pointer to the USB driver structure.
+ * @return true if a setup request could be handled.
+ * @return false if a setup request could not be handled.
+ */
+bool usb_telemetry_request_hook_cb(USBDriver *p_usb) { return sduRequestsHook(p_usb); }
+
+/**
+ * @brief Start the serial over USB driver. Must be called before the USB driver is started.
+ */
+void usb_telemetry_setup(void) {
+    sduObjectInit(&SDU1);
+    sduStart(&SDU1, &g_usb_telemetry_config);
+}
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,45 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   USB CDC-ACM telemetry function: headers.
+ *
+ * @addtogroup usb
+ * @{
+ */
+
+#ifndef SOURCE_USB_USB_TELEMETRY_H_
+#define SOURCE_USB_USB_TELEMETRY_H_
+
+#include "hal.h"
+
+/**
+ * @brief Enable the CDC-ACM telemetry function, which carries the event log to the host.
+ * @details Usually set from the command line, e.g. with `make USB_TELEMETRY_ENABLE=1`, which also enables the ChibiOS
+ * serial over USB driver.
+ */
+#ifndef USB_TELEMETRY_ENABLE
+#define USB_TELEMETRY_ENABLE 0u
+#endif
+
+#if USB_TELEMETRY_ENABLE
+/**
+ * @brief The stream, to which telemetry is written.
+ */
+#define USB_TELEMETRY_STREAM ((BaseSequentialStream *)&SDU1)
+
+extern SerialUSBDriver SDU1;
+
+void usb_telemetry_configure_hook_i(USBDriver *p_usb);
+void usb_telemetry_suspend_hook_i(void);
+void usb_telemetry_wakeup_hook_i(void);
+void usb_telemetry_sof_cb(USBDriver *p_usb);
+bool usb_telemetry_request_hook_cb(USBDriver *p_usb);
+void usb_telemetry_setup(void);
+#endif
+
+#endif  // SOURCE_USB_USB_TELEMETRY_H_
+
+/**
+ * @}
+ */
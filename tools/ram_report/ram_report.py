@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# Copyright 2023 elagil
+"""Report the RAM usage of a firmware image from its GNU linker map file.
+
+Lists every output section that is placed in RAM, the largest RAM consumers (input sections, usually one per
+variable with -fdata-sections), and the RAM that is left for the heap.
+"""
+
+import argparse
+import re
+import sys
+
+RAM_REGION = "ram0"
+
+MEMORY_PATTERN = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+SECTION_PATTERN = re.compile(r"^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?\s*$")
+INPUT_SECTION_PATTERN = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+))?\s*$")
+CONTINUATION_PATTERN = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$")
+
+
+def parse_map(lines):
+    """Parse the memory regions, output sections, and input sections of a linker map.
+
+    Returns:
+        tuple: The memory regions {name: (origin, length)}, the output sections [(name, address, size)], and the
+        input sections [(output section, input section, address, size, object file)].
+    """
+    regions = {}
+    output_sections = []
+    input_sections = []
+
+    state = None
+    pending_output = None
+    pending_input = None
+    output_name = None
+
+    for line in lines:
+        line = line.rstrip("\n")
+
+        if line.startswith("Memory Configuration"):
+            state = "memory"
+            continue
+
+        if line.startswith("Linker script and memory map"):
+            state = "map"
+            continue
+
+        if state == "memory":
+            match = MEMORY_PATTERN.match(line)
+            if match and match.group(1) != "Name":
+                regions[match.group(1)] = (int(match.group(2), 16), int(match.group(3), 16))
+            continue
+
+        if state != "map":
+            continue
+
+        if pending_output is not None:
+            match = CONTINUATION_PATTERN.match(line)
+            if match:
+                output_sections.append((pending_output, int(match.group(1), 16), int(match.group(2), 16)))
+                output_name = pending_output
+            pending_output = None
+            continue
+
+        if pending_input is not None:
+            match = CONTINUATION_PATTERN.match(line)
+            if match and match.group(3):
+                input_sections.append(
+                    (output_name, pending_input, int(match.group(1), 16), int(match.group(2), 16), match.group(3))
+                )
+            pending_input = None
+            continue
+
+        match = SECTION_PATTERN.match(line)
+        if match:
+            if match.group(2) is None:
+                pending_output = match.group(1)
+            else:
+                output_name = match.group(1)
+                output_sections.append((output_name, int(match.group(2), 16), int(match.group(3), 16)))
+            continue
+
+        match = INPUT_SECTION_PATTERN.match(line)
+        if match and output_name is not None:
+            if match.group(2) is None:
+                pending_input = match.group(1)
+            else:
+                input_sections.append(
+                    (output_name, match.group(1), int(match.group(2), 16), int(match.group(3), 16), match.group(4))
+                )
+
+    return regions, output_sections, input_sections
+
+
+def get_symbol_name(input_section):
+    """Derive a readable name from an input section, e.g. '.bss.g_playback' becomes 'g_playback'."""
+    for prefix in (".bss.", ".data.", ".ram0.", ".noinit."):
+        if input_section.startswith(prefix):
+            return input_section[len(prefix):]
+
+    return input_section
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("map_file", help="the linker map file")
+    parser.add_argument("-n", "--count", type=int, default=10, help="the number of largest consumers to list")
+    arguments = parser.parse_args()
+
+    with open(arguments.map_file, encoding="utf-8") as map_file:
+        regions, output_sections, input_sections = parse_map(map_file)
+
+    if RAM_REGION not in regions:
+        print(f"No memory region '{RAM_REGION}' in {arguments.map_file}.", file=sys.stderr)
+        return 1
+
+    origin, length = regions[RAM_REGION]
+
+    def is_in_ram(address, size):
+        return (size > 0) and (origin <= address < (origin + length))
+
+    ram_sections = [section for section in output_sections if is_in_ram(section[1], section[2])]
+    heap_size = sum(size for name, _, size in ram_sections if name == ".heap")
+    used_size = sum(size for name, _, size in ram_sections if name != ".heap")
+
+    print(f"RAM report for {arguments.map_file}")
+    print(f"  {'section':24} {'address':>10} {'size':>8}")
+
+    for name, address, size in ram_sections:
+        print(f"  {name:24} 0x{address:08x} {size:8}")
+
+    print(f"  used {used_size} of {length} bytes ({100.0 * used_size / length:.1f} %), {length - used_size} left")
+
+    if heap_size > 0:
+        print(f"  heap {heap_size} bytes")
+
+    consumers = sorted(
+        (section for section in input_sections if is_in_ram(section[2], section[3])),
+        key=lambda section: section[3],
+        reverse=True,
+    )
+
+    print(f"  largest {arguments.count} consumers:")
+
+    for output_name, input_name, _, size, object_file in consumers[: arguments.count]:
+        object_name = object_file.rsplit("/", 1)[-1]
+        print(f"    {size:8}  {get_symbol_name(input_name):32} {output_name:10} {object_name}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
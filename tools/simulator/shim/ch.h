@@ -0,0 +1,95 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS RT kernel.
+ * @details Provides the small subset of kernel functionality that the simulated audio modules use. There is only a
+ * single host thread, so that locking functions do nothing. Events are collected for the simulator, which plays the
+ * part of the audio thread.
+ *
+ * @addtogroup simulator
+ * @{
+ */
+
+#ifndef TOOLS_SIMULATOR_SHIM_CH_H_
+#define TOOLS_SIMULATOR_SHIM_CH_H_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRUE  1
+#define FALSE 0
+
+#define __STATIC_INLINE static inline
+
+// The kernel version, as reported in USB string descriptors.
+#define CH_KERNEL_MAJOR 0
+#define CH_KERNEL_MINOR 0
+#define CH_KERNEL_PATCH 0
+
+typedef int32_t  msg_t;
+typedef uint32_t eventmask_t;
+
+#define EVENT_MASK(_event_id) ((eventmask_t)1u << (eventmask_t)(_event_id))
+
+/**
+ * @brief A simulated thread, which only holds its pending events.
+ */
+typedef struct {
+    eventmask_t events;  ///< The events that were signaled, but not yet handled.
+} thread_t;
+
+void        chEvtSignalI(thread_t *p_thread, eventmask_t events);
+eventmask_t chEvtWaitAny(eventmask_t events);
+
+// Threads other than the audio thread are created, but never run on the host.
+#define NORMALPRIO                     128
+#define THD_WORKING_AREA(_name, _size) uint8_t _name[_size]
+#define THD_FUNCTION(_name, _arg)      void _name(void *_arg)
+#define chRegSetThreadName(_name)      (void)(_name)
+
+thread_t *chThdCreateStatic(void *p_working_area, size_t size, int priority, void (*p_function)(void *), void *p_arg);
+
+/**
+ * @brief The application mailbox, which only appears in the audio module interface.
+ */
+typedef struct shim_mailbox mailbox_t;
+
+#define chSysLock()
+#define chSysUnlock()
+#define chSysLockFromISR()
+#define chSysUnlockFromISR()
+#define chSysHalt(_reason) assert(!(_reason))
+
+#define chDbgAssert(_condition, _reason) assert((_condition) && (_reason))
+#define chDbgCheckClassI()
+
+#define OSAL_IRQ_HANDLER(_id) void _id(void)
+#define OSAL_IRQ_PROLOGUE()
+#define OSAL_IRQ_EPILOGUE()
+
+// CMSIS intrinsics, as used by the audio modules.
+__STATIC_INLINE uint32_t __ROR(uint32_t value, uint32_t shift) {
+    shift &= 31u;
+    return (shift == 0u) ? value : ((value >> shift) | (value << (32u - shift)));
+}
+
+__STATIC_INLINE int32_t __SMMUL(int32_t a, int32_t b) { return (int32_t)(((int64_t)a * b) >> 32); }
+
+__STATIC_INLINE uint32_t __CLZ(uint32_t value) { return (value == 0u) ? 32u : (uint32_t)__builtin_clz(value); }
+
+__STATIC_INLINE uint32_t __UNALIGNED_UINT32_READ(const void *p_address) {
+    uint32_t value;
+    __builtin_memcpy(&value, p_address, sizeof(value));
+    return value;
+}
+
+__STATIC_INLINE void __DMB(void) { __atomic_signal_fence(__ATOMIC_SEQ_CST); }
+
+#endif  // TOOLS_SIMULATOR_SHIM_CH_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,147 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS HAL.
+ * @details Mocks the peripherals that the audio playback and feedback modules access: the I2S DMA stream (NDTR), the
+ * TIM2 counter, the DWT cycle counter, the USB endpoint transfer functions, and the USB frame number.
+ *
+ * @addtogroup simulator
+ * @{
+ */
+
+#ifndef TOOLS_SIMULATOR_SHIM_HAL_H_
+#define TOOLS_SIMULATOR_SHIM_HAL_H_
+
+#include "ch.h"
+
+// Timer peripheral.
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t SMCR;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t CNT;
+    volatile uint32_t OR;
+} TIM_TypeDef;
+
+extern TIM_TypeDef g_shim_tim2;
+#define TIM2 (&g_shim_tim2)
+
+#define TIM_CR1_CEN       (1u << 0u)
+#define TIM_SMCR_SMS_1    (1u << 1u)
+#define TIM_SMCR_SMS_2    (1u << 2u)
+#define TIM_SMCR_TS_0     (1u << 4u)
+#define TIM_SMCR_ECE      (1u << 14u)
+#define TIM_DIER_TIE      (1u << 6u)
+#define TIM_SR_TIF        (1u << 6u)
+#define TIM_OR_ITR1_RMP_1 (1u << 11u)
+
+#define STM32_TIM2_HANDLER      shim_tim2_handler
+#define STM32_TIM2_NUMBER       28u
+#define STM32_IRQ_TIM2_PRIORITY 7u
+
+void shim_tim2_handler(void);
+void rccEnableTIM2(bool b_low_power);
+void rccResetTIM2(void);
+void nvicEnableVector(uint32_t vector, uint32_t priority);
+void nvicDisableVector(uint32_t vector);
+
+// Data watchpoint and trace unit.
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type       g_shim_dwt;
+extern CoreDebug_Type g_shim_core_debug;
+#define DWT       (&g_shim_dwt)
+#define CoreDebug (&g_shim_core_debug)
+
+#define DWT_CTRL_CYCCNTENA_Msk     (1u << 0u)
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24u)
+
+// I2S driver.
+typedef enum { I2S_UNINIT, I2S_STOP, I2S_READY, I2S_ACTIVE, I2S_COMPLETE } i2sstate_t;
+
+typedef struct {
+    volatile uint32_t NDTR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+    DMA_Stream_TypeDef *stream;
+} stm32_dma_stream_t;
+
+typedef struct {
+    i2sstate_t                state;
+    const stm32_dma_stream_t *dmatx;
+} I2SDriver;
+
+extern I2SDriver I2SD3;
+
+#define i2sIsBufferComplete(_i2s) ((_i2s)->state == I2S_COMPLETE)
+
+// USB driver.
+typedef uint8_t usbep_t;
+typedef uint8_t usbevent_t;
+
+typedef struct {
+    int state;
+} USBDriver;
+
+extern USBDriver USBD1;
+
+/**
+ * @brief A USB descriptor, as provided to the host.
+ */
+typedef struct {
+    size_t         ud_size;
+    const uint8_t *ud_string;
+} USBDescriptor;
+
+#define USB_DESCRIPTOR_DEVICE        1u
+#define USB_DESCRIPTOR_CONFIGURATION 2u
+#define USB_DESCRIPTOR_STRING        3u
+#define USB_DESCRIPTOR_INTERFACE     4u
+#define USB_DESCRIPTOR_ENDPOINT      5u
+
+#define USB_EP_MODE_TYPE_ISOC 0x0001u
+
+#define USB_DESC_BYTE(_b)  ((uint8_t)(_b))
+#define USB_DESC_WORD(_w)  (uint8_t)((_w) & 255u), (uint8_t)(((_w) >> 8u) & 255u)
+#define USB_DESC_BCD(_bcd) (uint8_t)((_bcd) & 255u), (uint8_t)(((_bcd) >> 8u) & 255u)
+#define USB_DESC_INDEX(_i) ((uint8_t)(_i))
+
+#define USB_DESC_DEVICE(_bcd_usb, _class, _sub_class, _protocol, _max_packet_size, _vid, _pid, _bcd_device,          \
+                        _manufacturer, _product, _serial_number, _configuration_count)                                \
+    USB_DESC_BYTE(18), USB_DESC_BYTE(USB_DESCRIPTOR_DEVICE), USB_DESC_BCD(_bcd_usb), USB_DESC_BYTE(_class),            \
+        USB_DESC_BYTE(_sub_class), USB_DESC_BYTE(_protocol), USB_DESC_BYTE(_max_packet_size), USB_DESC_WORD(_vid),     \
+        USB_DESC_WORD(_pid), USB_DESC_BCD(_bcd_device), USB_DESC_INDEX(_manufacturer), USB_DESC_INDEX(_product),       \
+        USB_DESC_INDEX(_serial_number), USB_DESC_BYTE(_configuration_count)
+
+#define USB_DESC_CONFIGURATION(_total_length, _interface_count, _configuration_value, _configuration, _attributes,     \
+                               _max_power)                                                                             \
+    USB_DESC_BYTE(9), USB_DESC_BYTE(USB_DESCRIPTOR_CONFIGURATION), USB_DESC_WORD(_total_length),                       \
+        USB_DESC_BYTE(_interface_count), USB_DESC_BYTE(_configuration_value), USB_DESC_INDEX(_configuration),          \
+        USB_DESC_BYTE(_attributes), USB_DESC_BYTE(_max_power)
+
+#define USB_DESC_INTERFACE(_interface_number, _alternate_setting, _endpoint_count, _class, _sub_class, _protocol,      \
+                           _interface)                                                                                 \
+    USB_DESC_BYTE(9), USB_DESC_BYTE(USB_DESCRIPTOR_INTERFACE), USB_DESC_BYTE(_interface_number),                       \
+        USB_DESC_BYTE(_alternate_setting), USB_DESC_BYTE(_endpoint_count), USB_DESC_BYTE(_class),                      \
+        USB_DESC_BYTE(_sub_class), USB_DESC_BYTE(_protocol), USB_DESC_INDEX(_interface)
+
+size_t   usbGetReceiveTransactionSizeX(USBDriver *p_usb, usbep_t endpoint_identifier);
+uint16_t usbGetFrameNumberX(USBDriver *p_usb);
+void     usbStartReceiveI(USBDriver *p_usb, usbep_t endpoint_identifier, uint8_t *p_buffer, size_t size);
+void     usbStartTransmitI(USBDriver *p_usb, usbep_t endpoint_identifier, const uint8_t *p_buffer, size_t size);
+
+#endif  // TOOLS_SIMULATOR_SHIM_HAL_H_
+
+/**
+ * @}
+ */
@@ -0,0 +1,105 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim for the ChibiOS RT kernel and HAL.
+ *
+ * @addtogroup simulator
+ * @{
+ */
+
+#include "shim.h"
+
+#include <string.h>
+
+TIM_TypeDef    g_shim_tim2;
+DWT_Type       g_shim_dwt;
+CoreDebug_Type g_shim_core_debug;
+
+static DMA_Stream_TypeDef       g_shim_i2s_dma_stream;
+static const stm32_dma_stream_t g_shim_i2s_dma = {.stream = &g_shim_i2s_dma_stream};
+
+I2SDriver I2SD3 = {.state = I2S_READY, .dmatx = &g_shim_i2s_dma};
+USBDriver USBD1;
+
+struct shim_usb  g_shim_usb;
+struct shim_tim2 g_shim_tim2_state;
+
+/**
+ * @brief The absolute count of timer clock cycles, maintained by the simulator.
+ */
+extern uint64_t g_simulator_mclk_cycles;
+
+void chEvtSignalI(thread_t *p_thread, eventmask_t events) { p_thread->events |= events; }
+
+eventmask_t chEvtWaitAny(eventmask_t events) { return events; }
+
+thread_t *chThdCreateStatic(void *p_working_area, size_t size, int priority, void (*p_function)(void *), void *p_arg) {
+    static thread_t threads[4u];
+    static size_t   thread_count;
+
+    (void)p_working_area;
+    (void)size;
+    (void)priority;
+    (void)p_function;
+    (void)p_arg;
+
+    assert(thread_count < (sizeof(threads) / sizeof(threads[0])));
+    return &threads[thread_count++];
+}
+
+void rccEnableTIM2(bool b_low_power) { (void)b_low_power; }
+
+void rccResetTIM2(void) {
+    memset(&g_shim_tim2, 0, sizeof(g_shim_tim2));
+    g_shim_tim2_state.reset_cycles = g_simulator_mclk_cycles;
+}
+
+void nvicEnableVector(uint32_t vector, uint32_t priority) {
+    (void)priority;
+
+    if (vector == STM32_TIM2_NUMBER) {
+        g_shim_tim2_state.b_enabled = true;
+    }
+}
+
+void nvicDisableVector(uint32_t vector) {
+    if (vector == STM32_TIM2_NUMBER) {
+        g_shim_tim2_state.b_enabled = false;
+    }
+}
+
+size_t usbGetReceiveTransactionSizeX(USBDriver *p_usb, usbep_t endpoint_identifier) {
+    (void)p_usb;
+    (void)endpoint_identifier;
+    return g_shim_usb.receive_size;
+}
+
+uint16_t usbGetFrameNumberX(USBDriver *p_usb) {
+    (void)p_usb;
+    return g_shim_usb.frame_number;
+}
+
+void usbStartReceiveI(USBDriver *p_usb, usbep_t endpoint_identifier, uint8_t *p_buffer, size_t size) {
+    (void)p_usb;
+    (void)endpoint_identifier;
+    (void)size;
+    g_shim_usb.p_receive_buffer = p_buffer;
+}
+
+void usbStartTransmitI(USBDriver *p_usb, usbep_t endpoint_identifier, const uint8_t *p_buffer, size_t size) {
+    (void)p_usb;
+    (void)endpoint_identifier;
+    assert(size <= SHIM_MAX_TRANSMIT_SIZE);
+
+    if (size > 0u) {
+        memcpy(g_shim_usb.transmit_buffer, p_buffer, size);
+    }
+
+    g_shim_usb.transmit_size = size;
+    g_shim_usb.transmit_count++;
+}
+
+/**
+ * @}
+ */
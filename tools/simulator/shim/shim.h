@@ -0,0 +1,49 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host shim state, as seen by the simulator.
+ *
+ * @addtogroup simulator
+ * @{
+ */
+
+#ifndef TOOLS_SIMULATOR_SHIM_SHIM_H_
+#define TOOLS_SIMULATOR_SHIM_SHIM_H_
+
+#include "hal.h"
+
+/**
+ * @brief The maximum size of a transmitted USB packet that is recorded.
+ */
+#define SHIM_MAX_TRANSMIT_SIZE 8u
+
+/**
+ * @brief The state of the mocked USB endpoints.
+ */
+struct shim_usb {
+    uint8_t *p_receive_buffer;                         ///< The location of the pending reception, or NULL.
+    size_t   receive_size;                             ///< The size of the last received transaction.
+    uint8_t  transmit_buffer[SHIM_MAX_TRANSMIT_SIZE];  ///< A copy of the last transmitted packet.
+    size_t   transmit_size;                            ///< The size of the last transmitted packet.
+    size_t   transmit_count;                           ///< The number of started transmissions.
+    uint16_t frame_number;                             ///< The current USB frame number.
+};
+
+extern struct shim_usb g_shim_usb;
+
+/**
+ * @brief The state of the mocked TIM2 peripheral.
+ */
+struct shim_tim2 {
+    uint64_t reset_cycles;  ///< The absolute count of timer clock cycles at the last peripheral reset.
+    bool     b_enabled;     ///< True, if the timer interrupt vector is enabled.
+};
+
+extern struct shim_tim2 g_shim_tim2_state;
+
+#endif  // TOOLS_SIMULATOR_SHIM_SHIM_H_
+
+/**
+ * @}
+ */
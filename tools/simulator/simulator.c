@@ -0,0 +1,671 @@
+// Copyright 2023 elagil
+
+/**
+ * @file
+ * @brief   Host simulator for audio playback buffer and feedback control.
+ * @details Drives the unmodified \a audio_playback and \a audio_feedback modules with a simulated USB host and a
+ * simulated I2S clock. The host sends one packet per 1 ms SOF period, with a size that follows the reported feedback
+ * value (or a fixed rate, if feedback is ignored). The device clock deviates from the nominal sample rate by a
+ * configurable offset in ppm, and packet arrival times are subject to jitter.
+ *
+ * Reports fill size trajectories, forced write offset corrections, the resulting latency, and the host execution time
+ * of the packet reception callback (microbenchmark).
+ *
+ * @addtogroup simulator
+ * @{
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio.h"
+#include "shim.h"
+#include "usb_descriptors.h"
+
+/**
+ * @brief The absolute count of timer clock (I2S master clock) cycles.
+ */
+uint64_t g_simulator_mclk_cycles;
+
+/**
+ * @brief The simulation options.
+ */
+static struct simulator_options {
+    uint32_t sample_rate_hz;      ///< The nominal sample rate.
+    uint32_t buffer_profile;      ///< The audio buffer profile.
+    double   device_ppm;          ///< The deviation of the device (I2S) clock from nominal in ppm.
+    double   host_ppm;            ///< The deviation of the host's sample rate in ppm, if feedback is ignored.
+    bool     b_ignore_feedback;   ///< If true, the host does not follow the reported feedback.
+    double   packet_offset_us;    ///< The nominal arrival time of a packet after its SOF.
+    double   jitter_us;           ///< The maximum deviation of the packet arrival time from nominal.
+    uint32_t duration_ms;         ///< The simulated duration.
+    uint32_t settle_ms;           ///< The duration after which the fill size statistics are collected.
+    uint32_t drop_interval;       ///< The interval in packets, at which a transaction fails. Zero for never.
+    uint32_t pause_at_ms;         ///< The time, at which the host selects the zero-bandwidth alternate setting.
+    uint32_t pause_ms;            ///< The duration of the streaming pause. Zero for none.
+    uint32_t trace_interval_ms;   ///< The interval of fill size trace output. Zero for none.
+    uint32_t seed;                ///< The seed for the pseudo-random jitter.
+    bool     b_benchmark;         ///< If true, report the execution time of the reception callback.
+    bool     b_packed;            ///< If true, the host streams packed 24 bit samples.
+    bool     b_check;             ///< If true, fail when forced corrections do not hold the fill size near target.
+} g_options = {
+    .sample_rate_hz    = AUDIO_DEFAULT_SAMPLE_RATE_HZ,
+    .buffer_profile    = AUDIO_BUFFER_PROFILE_DEFAULT,
+    .device_ppm        = 0.0,
+    .host_ppm          = 0.0,
+    .b_ignore_feedback = false,
+    .packet_offset_us  = 100.0,
+    .jitter_us         = 50.0,
+    .duration_ms       = 10000u,
+    .settle_ms         = 2000u,
+    .drop_interval     = 0u,
+    .pause_at_ms       = 5000u,
+    .pause_ms          = 0u,
+    .trace_interval_ms = 0u,
+    .seed              = 1u,
+    .b_benchmark       = false,
+    .b_packed          = false,
+    .b_check           = false,
+};
+
+/**
+ * @brief The state of the simulation.
+ */
+static struct simulator {
+    thread_t audio_thread;            ///< The audio thread, whose events the simulator handles.
+    double   i2s_start_time_s;        ///< The time at which the I2S DMA started.
+    uint64_t dma_interrupt_count;     ///< The number of half and complete transfer interrupts since the DMA started.
+    double   host_frame_accumulator;  ///< The fractional number of frames that the host still owes.
+    uint32_t host_feedback_value;     ///< The last feedback value that the host received, zero if none.
+    uint8_t  sample_pattern;          ///< A running byte pattern for packet contents.
+
+    bool   b_warm_idle_timer_armed;  ///< If true, warm idle ends at \a warm_idle_end_time_s .
+    double warm_idle_end_time_s;     ///< The time at which warm idle ends, in place of the audio thread's timer.
+
+    uint64_t fill_size_sample_count;  ///< The number of collected fill size samples.
+    double   fill_size_sum;           ///< The sum of collected fill sizes.
+    size_t   fill_size_min;           ///< The smallest collected fill size.
+    size_t   fill_size_max;           ///< The largest collected fill size.
+
+    uint64_t callback_count;     ///< The number of timed reception callbacks.
+    uint64_t callback_total_ns;  ///< The total execution time of the reception callbacks.
+    uint64_t callback_max_ns;    ///< The longest execution time of a reception callback.
+} g_simulator;
+
+/**
+ * @brief Get the device sample rate, including its clock deviation.
+ *
+ * @return double The device sample rate in Hz.
+ */
+static double simulator_get_device_sample_rate(void) {
+    return (double)g_options.sample_rate_hz * (1.0 + g_options.device_ppm * 1e-6);
+}
+
+/**
+ * @brief Update the mocked I2S master clock, and the TIM2 counter that it clocks.
+ *
+ * @param time_s The simulation time in seconds.
+ */
+static void simulator_set_clock(double time_s) {
+    // The I2S master clock runs at 256 times the device sample rate.
+    g_simulator_mclk_cycles = (uint64_t)(time_s * simulator_get_device_sample_rate() * 256.0);
+
+    if (g_shim_tim2_state.b_enabled && ((TIM2->CR1 & TIM_CR1_CEN) != 0u)) {
+        TIM2->CNT = (uint32_t)(g_simulator_mclk_cycles - g_shim_tim2_state.reset_cycles);
+    }
+}
+
+/**
+ * @brief Advance the simulated time, and update the mocked I2S master clock and DMA counter.
+ * @details Runs the DMA half and complete transfer interrupts, which occurred since the last update, at their exact
+ * points in time.
+ *
+ * @param time_s The new simulation time in seconds.
+ */
+static void simulator_set_time(double time_s) {
+    simulator_set_clock(time_s);
+
+    if (I2SD3.state != I2S_ACTIVE) {
+        return;
+    }
+
+    // The DMA transfers half-words, and counts down the remaining transfers of the circular buffer.
+    const uint64_t TRANSFER_COUNT      = audio_playback_get_buffer_size() / 2u;
+    const uint64_t HALF_TRANSFER_COUNT = TRANSFER_COUNT / 2u;
+    const double   TRANSFER_RATE       = simulator_get_device_sample_rate() * AUDIO_FRAME_SIZE / 2.0;
+    const uint64_t TRANSFERRED_COUNT   = (uint64_t)((time_s - g_simulator.i2s_start_time_s) * TRANSFER_RATE);
+
+    while ((g_simulator.dma_interrupt_count + 1u) * HALF_TRANSFER_COUNT <= TRANSFERRED_COUNT) {
+        g_simulator.dma_interrupt_count++;
+
+        const bool B_COMPLETE = (g_simulator.dma_interrupt_count % 2u) == 0u;
+
+        simulator_set_clock(g_simulator.i2s_start_time_s +
+                            (double)(g_simulator.dma_interrupt_count * HALF_TRANSFER_COUNT) / TRANSFER_RATE);
+        I2SD3.dmatx->stream->NDTR = (uint32_t)(B_COMPLETE ? TRANSFER_COUNT : (TRANSFER_COUNT - HALF_TRANSFER_COUNT));
+        I2SD3.state               = B_COMPLETE ? I2S_COMPLETE : I2S_ACTIVE;
+        audio_playback_dma_cb(&I2SD3);
+        I2SD3.state = I2S_ACTIVE;
+    }
+
+    simulator_set_clock(time_s);
+    I2SD3.dmatx->stream->NDTR = (uint32_t)(TRANSFER_COUNT - (TRANSFERRED_COUNT % TRANSFER_COUNT));
+}
+
+/**
+ * @brief Handle the events that the audio modules signaled, in place of the audio thread.
+ * @details Like the audio thread, the output is started according to the current playback state.
+ *
+ * @param time_s The current simulation time in seconds.
+ */
+static void simulator_handle_messages(double time_s) {
+    eventmask_t events              = g_simulator.audio_thread.events;
+    g_simulator.audio_thread.events = 0u;
+
+    if ((events & AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_STOP_PLAYBACK)) != 0u) {
+        audio_feedback_stop_sof_capture();
+        I2SD3.state = I2S_READY;
+    }
+
+    enum audio_playback_state state = audio_playback_get_state();
+    bool b_output_active = (state == AUDIO_PLAYBACK_STATE_PLAYING) || (state == AUDIO_PLAYBACK_STATE_WARM_IDLE);
+
+    if (b_output_active && (I2SD3.state != I2S_ACTIVE)) {
+        I2SD3.state                     = I2S_ACTIVE;
+        g_simulator.i2s_start_time_s    = time_s;
+        g_simulator.dma_interrupt_count = 0u;
+        simulator_set_time(time_s);
+        audio_feedback_start_sof_capture();
+    }
+
+    if (((events & AUDIO_COMMON_EVENT(AUDIO_COMMON_MSG_START_WARM_IDLE)) != 0u) &&
+        (state == AUDIO_PLAYBACK_STATE_WARM_IDLE)) {
+        g_simulator.b_warm_idle_timer_armed = true;
+        g_simulator.warm_idle_end_time_s    = time_s + AUDIO_WARM_IDLE_TIMEOUT_MS * 1e-3;
+    }
+}
+
+/**
+ * @brief End warm idle, when its timer expires.
+ *
+ * @param time_s The current simulation time in seconds.
+ */
+static void simulator_update_warm_idle_timer(double time_s) {
+    if (!g_simulator.b_warm_idle_timer_armed || (time_s < g_simulator.warm_idle_end_time_s)) {
+        return;
+    }
+
+    g_simulator.b_warm_idle_timer_armed = false;
+    audio_playback_end_warm_idle();
+    simulator_handle_messages(time_s);
+}
+
+/**
+ * @brief Determine, whether the host pauses streaming, by selecting the zero-bandwidth alternate setting.
+ *
+ * @param time_ms The current simulation time in ms.
+ * @return true if streaming is paused.
+ * @return false if the host streams audio.
+ */
+static bool simulator_is_paused(uint32_t time_ms) {
+    return (g_options.pause_ms != 0u) && (time_ms >= g_options.pause_at_ms) &&
+           (time_ms < (g_options.pause_at_ms + g_options.pause_ms));
+}
+
+/**
+ * @brief Select an operational alternate setting of the streaming interface.
+ */
+static void simulator_start_streaming(void) {
+    audio_playback_start_streaming(&USBD1,
+                                   g_options.b_packed ? AUDIO_STREAM_FORMAT_PACKED_24_BIT : AUDIO_STREAM_FORMAT_NATIVE);
+}
+
+/**
+ * @brief Get a uniformly distributed pseudo-random number in the range [-1, 1].
+ *
+ * @return double The random number.
+ */
+static double simulator_get_random(void) { return 2.0 * ((double)rand() / (double)RAND_MAX) - 1.0; }
+
+/**
+ * @brief Get the monotonic host time in ns.
+ *
+ * @return uint64_t The host time.
+ */
+static uint64_t simulator_get_host_time_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * @brief Let the host poll the feedback endpoint.
+ * @details The host receives the previously prepared packet, and the device prepares the next one.
+ */
+static void simulator_poll_feedback(void) {
+    if (g_shim_usb.transmit_size == 3u) {
+        uint32_t feedback_value = 0u;
+        byte_array_to_value(g_shim_usb.transmit_buffer, &feedback_value, 3u);
+        g_simulator.host_feedback_value = feedback_value;
+    }
+
+    audio_feedback_cb(&USBD1, USB_DESC_ENDPOINT_FEEDBACK);
+}
+
+/**
+ * @brief Let the host send an audio packet.
+ *
+ * @param packet_index The index of the packet since the start of streaming.
+ */
+static void simulator_send_packet(uint32_t packet_index) {
+    // Without valid feedback, hosts send at their own, nominal sample rate.
+    double frames_per_ms = (double)g_options.sample_rate_hz * (1.0 + g_options.host_ppm * 1e-6) / 1000.0;
+
+    if (!g_options.b_ignore_feedback && (g_simulator.host_feedback_value != 0u)) {
+        // The feedback value is a number of kHz in 10.14 format, which equals frames per ms.
+        frames_per_ms = (double)g_simulator.host_feedback_value / (double)(1u << 14u);
+    }
+
+    g_simulator.host_frame_accumulator += frames_per_ms;
+
+    const size_t FRAME_SIZE =
+        g_options.b_packed ? (AUDIO_CHANNEL_COUNT * AUDIO_PACKED_SAMPLE_SIZE) : AUDIO_FRAME_SIZE;
+    const size_t MAX_PACKET_SIZE = g_options.b_packed ? AUDIO_MAX_PACKED_PACKET_SIZE : AUDIO_MAX_PACKET_SIZE;
+
+    size_t frame_count = (size_t)g_simulator.host_frame_accumulator;
+
+    if (frame_count > (MAX_PACKET_SIZE / FRAME_SIZE)) {
+        frame_count = MAX_PACKET_SIZE / FRAME_SIZE;
+    }
+
+    g_simulator.host_frame_accumulator -= (double)frame_count;
+
+    size_t packet_size = frame_count * FRAME_SIZE;
+
+    if ((g_options.drop_interval != 0u) && ((packet_index % g_options.drop_interval) == 0u)) {
+        // Simulate a failed transaction.
+        packet_size = 0u;
+    }
+
+    if (g_shim_usb.p_receive_buffer != NULL) {
+        for (size_t byte_index = 0; byte_index < packet_size; byte_index++) {
+            g_shim_usb.p_receive_buffer[byte_index] = g_simulator.sample_pattern++;
+        }
+    }
+
+    g_shim_usb.receive_size = packet_size;
+
+    uint64_t start_ns = simulator_get_host_time_ns();
+    audio_playback_received_cb(&USBD1, USB_DESC_ENDPOINT_PLAYBACK);
+    uint64_t duration_ns = simulator_get_host_time_ns() - start_ns;
+
+    g_simulator.callback_count++;
+    g_simulator.callback_total_ns += duration_ns;
+
+    if (duration_ns > g_simulator.callback_max_ns) {
+        g_simulator.callback_max_ns = duration_ns;
+    }
+}
+
+/**
+ * @brief Capture the timer counter at an SOF, and call the timer interrupt handler.
+ */
+static void simulator_capture_sof(void) {
+    if (!g_shim_tim2_state.b_enabled || ((TIM2->CR1 & TIM_CR1_CEN) == 0u)) {
+        return;
+    }
+
+    TIM2->CNT = (uint32_t)(g_simulator_mclk_cycles - g_shim_tim2_state.reset_cycles);
+    TIM2->SR |= TIM_SR_TIF;
+    shim_tim2_handler();
+}
+
+/**
+ * @brief Collect fill size statistics, and print the trace.
+ *
+ * @param time_ms The current simulation time in ms.
+ */
+static void simulator_collect(uint32_t time_ms) {
+    size_t                    fill_size = audio_playback_get_buffer_fill_size();
+    enum audio_playback_state state     = audio_playback_get_state();
+
+    if ((g_options.trace_interval_ms != 0u) && ((time_ms % g_options.trace_interval_ms) == 0u)) {
+        printf("%" PRIu32 ",%u,%zu,%.3f\n", time_ms, (unsigned)state, fill_size,
+               (double)audio_feedback_get_value() * 1000.0 / (double)(1u << 14u));
+    }
+
+    if ((time_ms < g_options.settle_ms) || (state != AUDIO_PLAYBACK_STATE_PLAYING)) {
+        return;
+    }
+
+    if ((g_simulator.fill_size_sample_count == 0u) || (fill_size < g_simulator.fill_size_min)) {
+        g_simulator.fill_size_min = fill_size;
+    }
+
+    if ((g_simulator.fill_size_sample_count == 0u) || (fill_size > g_simulator.fill_size_max)) {
+        g_simulator.fill_size_max = fill_size;
+    }
+
+    g_simulator.fill_size_sum += (double)fill_size;
+    g_simulator.fill_size_sample_count++;
+}
+
+/**
+ * @brief Print the simulation results.
+ *
+ * @param p_file The file to print to.
+ */
+static void simulator_report(FILE *p_file) {
+    struct audio_stats stats;
+    audio_stats_get(&stats);
+
+    const double BYTES_PER_MS = (double)g_options.sample_rate_hz * AUDIO_FRAME_SIZE / 1000.0;
+    const double MEAN_FILL    = (g_simulator.fill_size_sample_count > 0u)
+                                    ? g_simulator.fill_size_sum / (double)g_simulator.fill_size_sample_count
+                                    : 0.0;
+
+    fprintf(p_file, "# Configuration\n");
+    fprintf(p_file, "sample rate:          %" PRIu32 " Hz, %u bit%s\n", g_options.sample_rate_hz,
+            g_options.b_packed ? AUDIO_PACKED_RESOLUTION_BIT : AUDIO_RESOLUTION_BIT,
+            g_options.b_packed ? " (packed)" : "");
+    fprintf(p_file, "buffer:               %zu bytes (profile %" PRIu32 ", %zu packets), target %zu bytes\n",
+            audio_playback_get_buffer_size(), g_options.buffer_profile,
+            audio_playback_get_buffer_size() / audio_playback_get_packet_size(),
+            audio_playback_get_buffer_target_fill_size());
+    fprintf(p_file, "device clock:         %+.1f ppm\n", g_options.device_ppm);
+    fprintf(p_file, "host:                 %s, %+.1f ppm\n",
+            g_options.b_ignore_feedback ? "ignores feedback" : "follows feedback", g_options.host_ppm);
+    fprintf(p_file, "packet arrival:       %.1f us +/- %.1f us after SOF\n", g_options.packet_offset_us,
+            g_options.jitter_us);
+    fprintf(p_file, "feedback period:      %u ms, closed-loop %s, resampler %s\n", 1u << AUDIO_FEEDBACK_PERIOD_EXPONENT,
+            AUDIO_FEEDBACK_CONTROL_ENABLE ? "on" : "off", AUDIO_RESAMPLER_ENABLE ? "on" : "off");
+
+    fprintf(p_file, "# Results\n");
+    fprintf(p_file, "received packets:     %" PRIu32 "\n", stats.usb.received_packet_count);
+    fprintf(p_file, "failed transactions:  %" PRIu32 "\n", stats.usb.failed_transaction_count);
+    fprintf(p_file, "forced corrections:   %" PRIu32 " (total %" PRIu32 " bytes, max %" PRIu32 " bytes)\n",
+            stats.usb.forced_correction_count, stats.usb.forced_correction_total_bytes,
+            stats.usb.forced_correction_max_bytes);
+    fprintf(p_file, "playback start/stop:  %" PRIu32 " / %" PRIu32 "\n", stats.usb.playback_start_count,
+            stats.usb.playback_stop_count);
+    fprintf(p_file, "feedback updates:     %" PRIu32 "\n", stats.feedback.update_count);
+
+    if (g_simulator.fill_size_sample_count > 0u) {
+        fprintf(p_file, "fill size:            min %zu, max %zu, mean %.1f bytes (after %" PRIu32 " ms)\n",
+                g_simulator.fill_size_min, g_simulator.fill_size_max, MEAN_FILL, g_options.settle_ms);
+        fprintf(p_file, "buffer latency:       %.3f ms (mean), %.3f ms (max)\n", MEAN_FILL / BYTES_PER_MS,
+                (double)g_simulator.fill_size_max / BYTES_PER_MS);
+    }
+
+    fprintf(p_file, "fill size histogram: ");
+    for (size_t bin_index = 0; bin_index < AUDIO_STATS_FILL_SIZE_BIN_COUNT; bin_index++) {
+        fprintf(p_file, " %" PRIu32, stats.usb.fill_size_histogram[bin_index]);
+    }
+    fprintf(p_file, "\n");
+
+    if (g_options.b_benchmark && (g_simulator.callback_count > 0u)) {
+        fprintf(p_file, "# Benchmark (host)\n");
+        fprintf(p_file, "reception callback:   mean %.1f ns, max %" PRIu64 " ns (n %" PRIu64 ")\n",
+                (double)g_simulator.callback_total_ns / (double)g_simulator.callback_count, g_simulator.callback_max_ns,
+                g_simulator.callback_count);
+    }
+}
+
+/**
+ * @brief Check that forced corrections hold the fill size near its target.
+ * @details A single correction must not exceed a packet, and the fill size must stay within two packets of its target.
+ * A correction in the wrong direction moves the fill size away from its target, and fails both conditions.
+ *
+ * @return true if the check passed.
+ * @return false if the check failed.
+ */
+static bool simulator_check(void) {
+    struct audio_stats stats;
+    audio_stats_get(&stats);
+
+    const size_t PACKET_SIZE        = audio_playback_get_packet_size();
+    const size_t TARGET_FILL_SIZE   = audio_playback_get_buffer_target_fill_size();
+    const size_t MAX_FILL_DEVIATION = 2u * PACKET_SIZE;
+    bool         b_passed           = true;
+
+    if (stats.usb.forced_correction_max_bytes > PACKET_SIZE) {
+        fprintf(stderr, "check failed: forced correction of %" PRIu32 " bytes exceeds a packet (%zu bytes)\n",
+                stats.usb.forced_correction_max_bytes, PACKET_SIZE);
+        b_passed = false;
+    }
+
+    if ((g_simulator.fill_size_sample_count > 0u) &&
+        (((g_simulator.fill_size_min + MAX_FILL_DEVIATION) < TARGET_FILL_SIZE) ||
+         (g_simulator.fill_size_max > (TARGET_FILL_SIZE + MAX_FILL_DEVIATION)))) {
+        fprintf(stderr, "check failed: fill size %zu to %zu bytes is not within %zu bytes of its target %zu bytes\n",
+                g_simulator.fill_size_min, g_simulator.fill_size_max, MAX_FILL_DEVIATION, TARGET_FILL_SIZE);
+        b_passed = false;
+    }
+
+    return b_passed;
+}
+
+/**
+ * @brief Print the command line usage.
+ *
+ * @param p_name The name of the executable.
+ */
+static void simulator_print_usage(const char *p_name) {
+    printf("Usage: %s [options]\n", p_name);
+    printf("  -r, --rate HZ           nominal sample rate (44100, 48000, 88200, or 96000)\n");
+    printf("  -P, --profile N         buffer profile (0 default, 1 low latency, 2 robust)\n");
+    printf("  -p, --device-ppm PPM    device clock deviation\n");
+    printf("  -H, --host-ppm PPM      host sample rate deviation, if feedback is ignored\n");
+    printf("  -n, --no-feedback       host ignores the feedback endpoint\n");
+    printf("  -o, --offset-us US      packet arrival time after SOF\n");
+    printf("  -j, --jitter-us US      packet arrival jitter\n");
+    printf("  -d, --duration-ms MS    simulated duration\n");
+    printf("  -s, --settle-ms MS      time before fill size statistics are collected\n");
+    printf("  -x, --drop-every N      fail every N-th transaction\n");
+    printf("  -a, --pause-at MS       time at which the host pauses streaming\n");
+    printf("  -l, --pause-ms MS       duration of the streaming pause\n");
+    printf("  -t, --trace MS          print t_ms,state,fill_size,feedback_hz every MS\n");
+    printf("  -S, --seed N            seed for the packet arrival jitter\n");
+    printf("  -b, --benchmark         time the packet reception callback\n");
+    printf("  -f, --packed            host streams packed 24 bit samples\n");
+    printf("  -c, --check             fail, if forced corrections do not hold the fill size near its target\n");
+}
+
+/**
+ * @brief Parse the command line options.
+ *
+ * @param argc The argument count.
+ * @param argv The argument values.
+ * @return true if the simulation shall run.
+ * @return false on error, or if only usage information was requested.
+ */
+static bool simulator_parse_options(int argc, char **argv) {
+    static const struct option LONG_OPTIONS[] = {{"rate", required_argument, NULL, 'r'},
+                                                 {"profile", required_argument, NULL, 'P'},
+                                                 {"device-ppm", required_argument, NULL, 'p'},
+                                                 {"host-ppm", required_argument, NULL, 'H'},
+                                                 {"no-feedback", no_argument, NULL, 'n'},
+                                                 {"offset-us", required_argument, NULL, 'o'},
+                                                 {"jitter-us", required_argument, NULL, 'j'},
+                                                 {"duration-ms", required_argument, NULL, 'd'},
+                                                 {"settle-ms", required_argument, NULL, 's'},
+                                                 {"drop-every", required_argument, NULL, 'x'},
+                                                 {"pause-at", required_argument, NULL, 'a'},
+                                                 {"pause-ms", required_argument, NULL, 'l'},
+                                                 {"trace", required_argument, NULL, 't'},
+                                                 {"seed", required_argument, NULL, 'S'},
+                                                 {"benchmark", no_argument, NULL, 'b'},
+                                                 {"packed", no_argument, NULL, 'f'},
+                                                 {"check", no_argument, NULL, 'c'},
+                                                 {"help", no_argument, NULL, 'h'},
+                                                 {NULL, 0, NULL, 0}};
+
+    int option;
+
+    while ((option = getopt_long(argc, argv, "r:P:p:H:no:j:d:s:x:a:l:t:S:bfch", LONG_OPTIONS, NULL)) != -1) {
+        switch (option) {
+            case 'r':
+                g_options.sample_rate_hz = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'P':
+                g_options.buffer_profile = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                g_options.device_ppm = strtod(optarg, NULL);
+                break;
+            case 'H':
+                g_options.host_ppm = strtod(optarg, NULL);
+                break;
+            case 'n':
+                g_options.b_ignore_feedback = true;
+                break;
+            case 'o':
+                g_options.packet_offset_us = strtod(optarg, NULL);
+                break;
+            case 'j':
+                g_options.jitter_us = strtod(optarg, NULL);
+                break;
+            case 'd':
+                g_options.duration_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                g_options.settle_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'x':
+                g_options.drop_interval = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                g_options.pause_at_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                g_options.pause_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                g_options.trace_interval_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'S':
+                g_options.seed = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                g_options.b_benchmark = true;
+                break;
+            case 'f':
+                g_options.b_packed = true;
+                break;
+            case 'c':
+                g_options.b_check = true;
+                break;
+            default:
+                simulator_print_usage(argv[0]);
+                return false;
+        }
+    }
+
+    if ((g_options.sample_rate_hz != AUDIO_SAMPLE_RATE_44_1_KHZ) &&
+        (g_options.sample_rate_hz != AUDIO_SAMPLE_RATE_48_KHZ) &&
+        (g_options.sample_rate_hz != AUDIO_SAMPLE_RATE_88_2_KHZ) &&
+        (g_options.sample_rate_hz != AUDIO_SAMPLE_RATE_96_KHZ)) {
+        fprintf(stderr, "Unsupported sample rate %" PRIu32 " Hz.\n", g_options.sample_rate_hz);
+        return false;
+    }
+
+    if (g_options.sample_rate_hz > AUDIO_MAX_SAMPLE_RATE_HZ) {
+        fprintf(stderr, "The sample rate %" PRIu32 " Hz is not enabled.\n", g_options.sample_rate_hz);
+        return false;
+    }
+
+    if (g_options.buffer_profile >= AUDIO_BUFFER_PROFILE_COUNT) {
+        fprintf(stderr, "Unsupported buffer profile %" PRIu32 ".\n", g_options.buffer_profile);
+        return false;
+    }
+
+    if (g_options.b_packed && !AUDIO_PACKED_24_BIT_ENABLE) {
+        fprintf(stderr, "The packed 24 bit stream format is not enabled.\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!simulator_parse_options(argc, argv)) {
+        return EXIT_FAILURE;
+    }
+
+    srand(g_options.seed);
+
+    audio_playback_init(&g_simulator.audio_thread);
+#if AUDIO_DSP_ENABLE
+    // The DSP thread does not run on the host, so that the DSP stage passes silence, once its queue is full.
+    audio_dsp_setup();
+    audio_dsp_init(audio_playback_process_samples);
+#endif
+    audio_feedback_init();
+    audio_playback_set_sample_rate(g_options.sample_rate_hz);
+    audio_playback_set_buffer_profile((enum audio_buffer_profile)g_options.buffer_profile);
+
+    // The host selects an operational alternate setting of the streaming interface.
+    simulator_start_streaming();
+
+    if (g_options.trace_interval_ms != 0u) {
+        printf("t_ms,state,fill_size,feedback_hz\n");
+    }
+
+    for (uint32_t time_ms = 0; time_ms < g_options.duration_ms; time_ms++) {
+        const double SOF_TIME_S = (double)time_ms * 1e-3;
+
+        // Start of frame.
+        g_shim_usb.frame_number = (uint16_t)(time_ms & 0x7FFu);
+        simulator_set_time(SOF_TIME_S);
+        simulator_update_warm_idle_timer(SOF_TIME_S);
+        simulator_capture_sof();
+
+        if (g_options.pause_ms != 0u) {
+            if (time_ms == g_options.pause_at_ms) {
+                audio_playback_stop_streaming(&USBD1);
+                simulator_handle_messages(SOF_TIME_S);
+            } else if (time_ms == (g_options.pause_at_ms + g_options.pause_ms)) {
+                simulator_start_streaming();
+            }
+        }
+
+        if ((time_ms % (1u << AUDIO_FEEDBACK_PERIOD_EXPONENT)) == 0u) {
+            simulator_poll_feedback();
+        }
+
+        // Audio packet reception, later in the frame.
+        double packet_time_s =
+            SOF_TIME_S + (g_options.packet_offset_us + g_options.jitter_us * simulator_get_random()) * 1e-6;
+
+        if (packet_time_s < SOF_TIME_S) {
+            packet_time_s = SOF_TIME_S;
+        }
+
+        simulator_set_time(packet_time_s);
+
+        if (!simulator_is_paused(time_ms)) {
+            simulator_send_packet(time_ms + 1u);
+        }
+
+        simulator_handle_messages(packet_time_s);
+
+        simulator_collect(time_ms);
+    }
+
+    // Keep the trace output machine-readable.
+    simulator_report((g_options.trace_interval_ms == 0u) ? stdout : stderr);
+
+    if (g_options.b_check && !simulator_check()) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,4 @@
+# Stereo with 32 bit (and packed 24 bit) samples at up to 96 kHz, with the
+# default buffers and a long feedback period for a stable feedback value.
+VARIANT_DEFS = -DAUDIO_RESOLUTION_BIT=32u -DAUDIO_HIGH_SAMPLE_RATE_ENABLE=1u
+VARIANT_DEFS += -DAUDIO_FEEDBACK_PERIOD_EXPONENT=0x04u
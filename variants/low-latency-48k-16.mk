@@ -0,0 +1,6 @@
+# Stereo with 16 bit samples at up to 48 kHz, with small buffers and a short
+# feedback period for low latency.
+VARIANT_DEFS = -DAUDIO_RESOLUTION_BIT=16u -DAUDIO_HIGH_SAMPLE_RATE_ENABLE=0u
+VARIANT_DEFS += -DAUDIO_BUFFER_PACKET_COUNT_LOW_LATENCY=3u -DAUDIO_BUFFER_PACKET_COUNT=4u
+VARIANT_DEFS += -DAUDIO_BUFFER_PACKET_COUNT_ROBUST=7u
+VARIANT_DEFS += -DAUDIO_FEEDBACK_PERIOD_EXPONENT=0x02u
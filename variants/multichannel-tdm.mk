@@ -0,0 +1,3 @@
+# Four channels with 16 bit samples on the TDM output, at up to 96 kHz.
+AUDIO_TDM_ENABLE = 1
+VARIANT_DEFS = -DAUDIO_HIGH_SAMPLE_RATE_ENABLE=1u